@@ -6,14 +6,24 @@
 #include <filesystem> // C++ 17 and more
 #include <cstdlib>
 #include <chrono>
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <utility>
 
 #include "helpers/TextUtils.h"
 #include "compressor/FileCompressor.h"
 #include"compressor/CompressorSettings.h"
+#include "codecs/CodecHA.h"
+#include "helpers/CRC32C.h"
+#include "helpers/MoveToFront.h"
+#include "helpers/SuffixArray.h"
 
 namespace fs = std::filesystem;
 const fs::path INPUT_DIR = fs::current_path() / "..\\input";
 const fs::path OUTPUT_DIR = fs::current_path() / "..\\output";
+const fs::path CHECKS_DIR = OUTPUT_DIR / "checks";
 
 
 // HELPER FUNCTIONS
@@ -22,11 +32,61 @@ std::string GetFileName(const std::string& path);
 void ClearOutputDirectory();
 void MakeResultsFile(const std::vector<std::string>& paths, const std::vector<std::vector<long>>& times);
 
+// CHECKS (round trips and expected behavior of codecs and FileCompressor on samples of the input files)
+const std::string ENWIK_PATH = "..\\input\\txt\\enwik7_1mb.txt";
+const std::string RUSSIAN_PATH = "..\\input\\txt\\russian_1mb.txt";
+const std::string SMALL_PATH = "..\\input\\txt\\small2.txt";
+const std::string BLACKWHITE_PATH = "..\\input\\raw\\blackwhite.raw";
+const std::string GRAY_PATH = "..\\input\\raw\\gray.raw";
+const std::string COLOR_PATH = "..\\input\\raw\\color.raw";
+
+bool RunChecks();
+std::string ReadFileBytes(const fs::path& path);
+void WriteFileBytes(const fs::path& path, const std::string& bytes);
+StringL<char8> ToStringL(const std::string& bytes);
+fs::path MakeSample(const std::string& path, const size_t size);
+bool RoundTrip(const fs::path& path, const std::string& codecType, const CompressorSettings& settings = CompressorSettings());
+template <typename exceptionType, typename functionType>
+bool Throws(functionType function);
+bool CheckRLEStride();
+bool CheckZRLE();
+bool CheckHuffmanStreams();
+bool CheckParallelSuffixArray();
+bool CheckDecompressRange();
+bool CheckChecksums();
+bool CheckSettings();
+bool CheckHAContexts();
+bool CheckArithmeticDecoder();
+bool CheckWideAlphabets();
+bool CheckStrideFilter();
+bool CheckPredictiveFilter();
+bool CheckMultiSymbolHuffman();
+bool CheckANS();
+bool CheckParallelInverseBWT();
+bool CheckSearch();
+bool CheckAppend();
+bool CheckDelta();
+bool CheckBatchDedup();
+bool CheckSolidBatch();
+bool CheckLZ77MaxMode();
+bool CheckFusedBWTKernel();
+template <typename codeType>
+bool CheckMoveToFrontAlphabet(const size_t alphabetSize);
+bool CheckMoveToFront();
+bool CheckMemoryBudget();
+bool CheckMemoryStats();
+
 
 int main()
 {
     ClearOutputDirectory();
 
+    std::cout << "Checks..." << std::endl;
+    if (!RunChecks()) {
+        std::cout << "Some checks failed." << std::endl;
+        return 1;
+    }
+
     std::vector<std::vector<long>> TIMES;
     const std::vector<std::string> PATHS = {
         //"..\\input\\raw\\blackwhite.raw",
@@ -42,7 +102,14 @@ int main()
 
     std::string compressionMethod = "LZ77";
 
-    //CompressorSettings::SetLZ77SearchBufferSize(16384);
+    CompressorSettings settings = CompressorSettings::Default(); // or CompressorSettings::Fast() / CompressorSettings::Max()
+    //settings.SetLZ77SearchBufferSize(16384);
+    //settings.SetRLEElementStride(3); // treat RGB pixels as RLE units
+    //settings.SetTransposeStride(3); // planes of RGB channels for "STRIDE+..." codec types (e.g. "STRIDE+RLE+HA")
+    //settings.SetImageWidth(1280); // rows of raw images for "PREDICT+..." codec types (e.g. "PREDICT+HA"), SetImagePixelSize(3) for RGB
+    //settings.SetBlockSize(1 << 20); // independent 1 MB blocks for FileCompressor::DecompressRange()
+    //settings.SetVerifyChecksums(false); // skip CRC verification for trusted files
+    //FileCompressor::EnableMemoryStats(true); // FileCompressor::GetMemoryStats().toString() - allocations, copies and peak bytes of stages
 
     std::cout << "Start..." << std::endl;
 
@@ -55,7 +122,7 @@ int main()
         auto start = std::chrono::steady_clock::now();
 
         std::cout << "Encoding..." << std::endl;
-        FileCompressor::Compress(path.c_str(), pathToEncoded.c_str(), compressionMethod);
+        FileCompressor::Compress(path.c_str(), pathToEncoded.c_str(), compressionMethod, settings);
         std::cout << "Done." << std::endl;
 
         auto end = std::chrono::steady_clock::now();
@@ -63,7 +130,7 @@ int main()
         start = std::chrono::steady_clock::now();
 
         std::cout << "Decoding..." << std::endl;
-        FileCompressor::Decompress(pathToEncoded.c_str(), pathToDecoded.c_str(), compressionMethod);
+        FileCompressor::Decompress(pathToEncoded.c_str(), pathToDecoded.c_str(), compressionMethod, settings);
         std::cout << "Done." << std::endl;
 
         end = std::chrono::steady_clock::now();
@@ -133,4 +200,594 @@ void MakeResultsFile(const std::vector<std::string>& paths, const std::vector<st
     file.close();
 }
 
+// ==== CHECKS ====
+
+bool RunChecks()
+{
+    fs::remove_all(CHECKS_DIR);
+    fs::create_directory(CHECKS_DIR);
+
+    const std::vector<std::pair<std::string, bool (*)()>> CHECKS = {
+        {"RLE element stride", CheckRLEStride},
+        {"ZRLE", CheckZRLE},
+        {"Interleaved Huffman streams", CheckHuffmanStreams},
+        {"Parallel suffix array", CheckParallelSuffixArray},
+        {"DecompressRange", CheckDecompressRange},
+        {"CRC-32C checksums", CheckChecksums},
+        {"CompressorSettings", CheckSettings},
+        {"HA encoder / decoder contexts", CheckHAContexts},
+        {"Arithmetic decoder", CheckArithmeticDecoder},
+        {"Wide alphabets", CheckWideAlphabets},
+        {"STRIDE+ filter", CheckStrideFilter},
+        {"PREDICT+ filter", CheckPredictiveFilter},
+        {"Multi-symbol Huffman decoding", CheckMultiSymbolHuffman},
+        {"ANS", CheckANS},
+        {"Parallel inverse BWT", CheckParallelInverseBWT},
+        {"Count / Locate", CheckSearch},
+        {"Append", CheckAppend},
+        {"DELTA", CheckDelta},
+        {"Batch deduplication", CheckBatchDedup},
+        {"Solid batch", CheckSolidBatch},
+        {"LZ77 max mode", CheckLZ77MaxMode},
+        {"Fused BWT kernel", CheckFusedBWTKernel},
+        {"MoveToFront", CheckMoveToFront},
+        {"Memory budget", CheckMemoryBudget},
+        {"MemoryStats", CheckMemoryStats}
+    };
+
+    bool allPassed = true;
+    for (const auto& check : CHECKS) {
+        bool passed = false;
+        try {
+            passed = check.second();
+        } catch (const std::exception& e) {
+            std::cout << e.what() << std::endl;
+        }
+        std::cout << check.first << ": " << (passed ? "OK" : "FAILED") << std::endl;
+        allPassed = allPassed && passed;
+    }
+    return allPassed;
+}
+
+std::string ReadFileBytes(const fs::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+void WriteFileBytes(const fs::path& path, const std::string& bytes)
+{
+    std::ofstream file(path, std::ios::binary);
+    file.write(bytes.data(), bytes.size());
+}
+
+StringL<char8> ToStringL(const std::string& bytes)
+{
+    StringL<char8> str;
+    for (const char c : bytes) str.push_back(static_cast<char8>(c));
+    return str;
+}
+
+// copies the first size bytes of the file to CHECKS_DIR (text samples end on a border of UTF-8 characters)
+fs::path MakeSample(const std::string& path, const size_t size)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::string bytes(size, '\0');
+    file.read(&bytes[0], size);
+    bytes.resize(static_cast<size_t>(file.gcount()));
+
+    if (GetFileExtension(path) == "txt") {
+        while (!bytes.empty() && (static_cast<uint8_t>(bytes.back()) & 0xC0) == 0x80) bytes.pop_back();
+        if (!bytes.empty() && (static_cast<uint8_t>(bytes.back()) & 0x80) != 0) bytes.pop_back();
+    }
+
+    const fs::path samplePath = CHECKS_DIR / (GetFileName(path) + "_" + std::to_string(bytes.size()) + "." + GetFileExtension(path));
+    WriteFileBytes(samplePath, bytes);
+    return samplePath;
+}
+
+bool RoundTrip(const fs::path& path, const std::string& codecType, const CompressorSettings& settings)
+{
+    const std::string pathToEncoded = path.string() + ".bin";
+    const std::string pathToDecoded = path.string() + ".out";
+
+    FileCompressor::Compress(path.string().c_str(), pathToEncoded.c_str(), codecType, settings);
+    FileCompressor::Decompress(pathToEncoded.c_str(), pathToDecoded.c_str(), codecType, settings);
+
+    return ReadFileBytes(pathToDecoded) == ReadFileBytes(path);
+}
+
+template <typename exceptionType, typename functionType>
+bool Throws(functionType function)
+{
+    try {
+        function();
+    } catch (const exceptionType&) {
+        return true;
+    }
+    return false;
+}
+
+bool CheckRLEStride()
+{
+    // RGB pixels are RLE units, the sample isn't a whole number of pixels
+    const fs::path color = MakeSample(COLOR_PATH, 3 * 1280 * 64 + 2);
+    CompressorSettings settings;
+    settings.SetRLEElementStride(3);
+    if (!RoundTrip(color, "RLE", settings) || !RoundTrip(color, "RLE+HA", settings)) return false;
+
+    return Throws<std::invalid_argument>([&settings]() { settings.SetRLEElementStride(5); });
+}
+
+bool CheckZRLE()
+{
+    const fs::path blackWhite = MakeSample(BLACKWHITE_PATH, 1280 * 64);
+    const fs::path text = MakeSample(ENWIK_PATH, 1 << 16);
+
+    return RoundTrip(blackWhite, "ZRLE") && RoundTrip(blackWhite, "BWT+MTF+ZRLE+AC") && RoundTrip(text, "BWT+MTF+ZRLE+HA");
+}
+
+bool CheckHuffmanStreams()
+{
+    const fs::path text = MakeSample(ENWIK_PATH, 1 << 16);
+    CompressorSettings settings;
+    settings.SetHuffmanBlockSize(5000); // several blocks, the last one is shorter
+
+    for (const size_t streamsCount : {1, 3, 8}) {
+        settings.SetHuffmanStreamsCount(streamsCount);
+        if (!RoundTrip(text, "HA", settings)) return false;
+    }
+    return Throws<std::invalid_argument>([&settings]() { settings.SetHuffmanStreamsCount(9); });
+}
+
+bool CheckParallelSuffixArray()
+{
+    const fs::path text = MakeSample(ENWIK_PATH, 1 << 16);
+    const StringL<char8> str = ToStringL(ReadFileBytes(text));
+    if (!(buildSuffixArrayParallel(str, char8('\0'), 4) == buildSuffixArray(str, char8('\0')))) return false;
+
+    CompressorSettings settings;
+    settings.SetSuffixArrayThreadsCount(4);
+    settings.SetParallelSuffixArrayThreshold(1);
+    return RoundTrip(text, "BWT+MTF+HA", settings);
+}
+
+bool CheckDecompressRange()
+{
+    const fs::path text = MakeSample(ENWIK_PATH, 1 << 16);
+    const std::string bytes = ReadFileBytes(text);
+    const std::string pathToEncoded = text.string() + ".range.bin";
+    CompressorSettings settings;
+    settings.SetBlockSize(4096);
+    FileCompressor::Compress(text.string().c_str(), pathToEncoded.c_str(), "LZ77+HA", settings);
+
+    // ranges inside one block, across blocks, on a border of blocks and cut by the end of file
+    const std::vector<std::pair<size_t, size_t>> RANGES = {{0, 1}, {100, 200}, {5000, 20000}, {4096, 4096}, {bytes.size() - 100, 1000}, {bytes.size(), 10}};
+    for (const auto& range : RANGES) {
+        const Array<uint8_t> decoded = FileCompressor::DecompressRange(pathToEncoded.c_str(), range.first, range.second);
+        if (std::string(decoded.c_arr(), decoded.c_arr() + decoded.size()) != bytes.substr(range.first, range.second)) return false;
+    }
+    return true;
+}
+
+bool CheckChecksums()
+{
+    if (CRC32C::Compute("123456789", 9) != 0xE3069283) return false;
+    if (CRC32C::Compute("56789", 5, CRC32C::Compute("1234", 4)) != 0xE3069283) return false;
+
+    const fs::path text = MakeSample(ENWIK_PATH, 1 << 16);
+    CompressorSettings settings;
+    settings.SetBlockSize(8192);
+    if (!RoundTrip(text, "HA", settings)) return false;
+
+    // one changed bit in the middle of the compressed data
+    std::string encoded = ReadFileBytes(text.string() + ".bin");
+    encoded[encoded.size() / 2] ^= 0x20;
+    const std::string pathToCorrupted = text.string() + ".corrupted.bin";
+    const std::string pathToDecoded = text.string() + ".corrupted.out";
+    WriteFileBytes(pathToCorrupted, encoded);
+    return Throws<std::runtime_error>([&]() { FileCompressor::Decompress(pathToCorrupted.c_str(), pathToDecoded.c_str(), "HA"); });
+}
+
+bool CheckSettings()
+{
+    CompressorSettings settings;
+    settings.SetBlockSize(10000);
+    settings.SetHuffmanBlockSize(12345);
+    settings.SetHuffmanStreamsCount(3);
+    settings.SetLZ77SearchBufferSize(1000);
+    settings.SetRLEElementStride(2);
+    settings.SetSuffixArrayThreadsCount(2);
+    settings.SetParallelSuffixArrayThreshold(5000);
+    settings.SetTransposeStride(4);
+    settings.SetImageWidth(7);
+    settings.SetImagePixelSize(2);
+    settings.SetVerifyChecksums(false);
+    settings.SetBWTCheckpointsCount(3);
+    settings.SetDedupChunkSize(1024);
+    settings.SetSolidArchive(true);
+    settings.SetBatchOrder(CompressorSettings::SIMILARITY_ORDER);
+    settings.SetLZ77MaxMode(true);
+    settings.SetMemoryBudget(1 << 20);
+
+    const fs::path text = MakeSample(SMALL_PATH, 1 << 16);
+    if (!RoundTrip(text, "HA", settings)) return false;
+    const CompressorSettings read = FileCompressor::ReadSettings((text.string() + ".bin").c_str());
+
+    const bool sameSettings = read.GetBlockSize() == settings.GetBlockSize() &&
+        read.GetHuffmanBlockSize() == settings.GetHuffmanBlockSize() &&
+        read.GetHuffmanStreamsCount() == settings.GetHuffmanStreamsCount() &&
+        read.GetLZ77SearchBufferSize() == settings.GetLZ77SearchBufferSize() &&
+        read.GetRLEElementStride() == settings.GetRLEElementStride() &&
+        read.GetSuffixArrayThreadsCount() == settings.GetSuffixArrayThreadsCount() &&
+        read.GetParallelSuffixArrayThreshold() == settings.GetParallelSuffixArrayThreshold() &&
+        read.GetTransposeStride() == settings.GetTransposeStride() &&
+        read.GetImageWidth() == settings.GetImageWidth() &&
+        read.GetImagePixelSize() == settings.GetImagePixelSize() &&
+        read.GetVerifyChecksums() == settings.GetVerifyChecksums() &&
+        read.GetBWTCheckpointsCount() == settings.GetBWTCheckpointsCount() &&
+        read.GetDedupChunkSize() == settings.GetDedupChunkSize() &&
+        read.GetSolidArchive() == settings.GetSolidArchive() &&
+        read.GetBatchOrder() == settings.GetBatchOrder() &&
+        read.GetLZ77MaxMode() == settings.GetLZ77MaxMode() &&
+        read.GetMemoryBudget() == settings.GetMemoryBudget();
+
+    return sameSettings && CompressorSettings::FromPreset("max").GetLZ77MaxMode() &&
+        Throws<std::invalid_argument>([]() { CompressorSettings::FromPreset("unknown"); });
+}
+
+bool CheckHAContexts()
+{
+    // records of different lengths (an empty one too) go through the same contexts
+    const std::string bytes = ReadFileBytes(MakeSample(ENWIK_PATH, 1 << 16));
+    CodecHA<char8>::EncoderContext encoderContext;
+    CodecHA<char8>::DecoderContext decoderContext;
+    Array<uint8_t> encoded;
+    StringL<char8> decoded;
+    for (const size_t length : {0, 1, 17, 200, 4096, 30000}) {
+        StringL<char8> record = ToStringL(bytes.substr(length, length));
+        encoded.clear();
+        decoded.clear();
+        CodecHA<char8>::Encode(record, encoded, encoderContext);
+        if (CodecHA<char8>::Decode(encoded.c_arr(), encoded.size(), decoded, decoderContext) != encoded.size() || !(decoded == record)) return false;
+    }
+
+    // after the warm-up the contexts and the buffers have enough capacity, so encoding and decoding of the record allocate nothing
+    StringL<char8> record = ToStringL(bytes.substr(0, 200));
+    for (size_t i = 0; i < 3; ++i) {
+        encoded.clear();
+        decoded.clear();
+        CodecHA<char8>::Encode(record, encoded, encoderContext);
+        CodecHA<char8>::Decode(encoded.c_arr(), encoded.size(), decoded, decoderContext);
+    }
+    FileCompressor::EnableMemoryStats(true);
+    FileCompressor::ResetMemoryStats();
+    bool decodedAll = true;
+    for (size_t i = 0; i < 1000; ++i) {
+        encoded.clear();
+        decoded.clear();
+        CodecHA<char8>::Encode(record, encoded, encoderContext);
+        CodecHA<char8>::Decode(encoded.c_arr(), encoded.size(), decoded, decoderContext);
+        decodedAll = decodedAll && decoded == record;
+    }
+    const MemoryStats::report report = FileCompressor::GetMemoryStats();
+    FileCompressor::EnableMemoryStats(false);
+
+    return decodedAll && report.allocations == 0 && report.copies == 0;
+}
+
+bool CheckArithmeticDecoder()
+{
+    const fs::path text = MakeSample(ENWIK_PATH, 1 << 16);
+    const fs::path gray = MakeSample(GRAY_PATH, 1280 * 64);
+
+    return RoundTrip(text, "AC") && RoundTrip(gray, "AC") && RoundTrip(text, "BWT+MTF+AC") && RoundTrip(text, "BWT+MTF+RLE+AC");
+}
+
+bool CheckWideAlphabets()
+{
+    // UTF-8 text with 2-byte characters and text with characters out of the BMP
+    const fs::path russian = MakeSample(RUSSIAN_PATH, 1 << 16);
+    std::string emojiBytes;
+    for (size_t i = 0; i < 2000; ++i) emojiBytes += "smile \xF0\x9F\x98\x80 " + std::to_string(i % 7) + "\n";
+    const fs::path emoji = CHECKS_DIR / "emoji.txt";
+    WriteFileBytes(emoji, emojiBytes);
+
+    for (const fs::path& text : {russian, emoji}) {
+        if (!RoundTrip(text, "HA") || !RoundTrip(text, "AC") || !RoundTrip(text, "BWT+MTF+HA") || !RoundTrip(text, "BWT+MTF+ZRLE+HA")) return false;
+    }
+    return true;
+}
+
+bool CheckStrideFilter()
+{
+    const fs::path color = MakeSample(COLOR_PATH, 3 * 1280 * 64);
+    CompressorSettings settings;
+    settings.SetTransposeStride(3);
+
+    return RoundTrip(color, "STRIDE+RLE+HA", settings) && RoundTrip(color, "STRIDE+BWT+MTF+ZRLE+HA", settings);
+}
+
+bool CheckPredictiveFilter()
+{
+    const fs::path gray = MakeSample(GRAY_PATH, 1280 * 64);
+    const fs::path color = MakeSample(COLOR_PATH, 3 * 1280 * 64);
+    CompressorSettings settings;
+    settings.SetImageWidth(1280);
+    if (!RoundTrip(gray, "HA", settings)) return false;
+    const uintmax_t pixelsSize = fs::file_size(gray.string() + ".bin");
+    if (!RoundTrip(gray, "PREDICT+HA", settings)) return false;
+    // residuals of neighbouring pixels take fewer bits than the pixels
+    if (fs::file_size(gray.string() + ".bin") >= pixelsSize) return false;
+
+    settings.SetImagePixelSize(3);
+    return RoundTrip(color, "PREDICT+HA", settings);
+}
+
+bool CheckMultiSymbolHuffman()
+{
+    // one stream with large blocks decodes several short codes per table lookup
+    const fs::path text = MakeSample(ENWIK_PATH, 1 << 17);
+    const fs::path blackWhite = MakeSample(BLACKWHITE_PATH, 1280 * 64);
+    CompressorSettings settings;
+    settings.SetHuffmanStreamsCount(1);
+    settings.SetHuffmanBlockSize(65536);
+
+    return RoundTrip(text, "HA", settings) && RoundTrip(blackWhite, "HA", settings) && RoundTrip(text, "HA", CompressorSettings::Max());
+}
+
+bool CheckANS()
+{
+    const fs::path text = MakeSample(ENWIK_PATH, 1 << 16);
+    const fs::path gray = MakeSample(GRAY_PATH, 1280 * 64);
+
+    return RoundTrip(text, "ANS") && RoundTrip(gray, "ANS") && RoundTrip(text, "BWT+MTF+ZRLE+ANS") && RoundTrip(text, "LZ77+ANS");
+}
+
+bool CheckParallelInverseBWT()
+{
+    const fs::path text = MakeSample(ENWIK_PATH, 1 << 16);
+    const fs::path small = MakeSample(SMALL_PATH, 1 << 16);
+    CompressorSettings settings;
+    settings.SetBWTCheckpointsCount(7);
+    if (!RoundTrip(text, "BWT", settings) || !RoundTrip(text, "BWT+MTF+ZRLE+HA", settings)) return false;
+
+    // more checkpoints than characters
+    settings.SetBWTCheckpointsCount(255);
+    return RoundTrip(small, "BWT+MTF+HA", settings);
+}
+
+bool CheckSearch()
+{
+    // positions of text files are counted in characters, so the sample is made ASCII
+    std::string bytes = ReadFileBytes(MakeSample(ENWIK_PATH, 1 << 16));
+    for (char& c : bytes) {
+        if ((static_cast<uint8_t>(c) & 0x80) != 0) c = '?';
+    }
+    const fs::path text = CHECKS_DIR / "search.txt";
+    WriteFileBytes(text, bytes);
+    const std::string pathToEncoded = text.string() + ".bin";
+    FileCompressor::Compress(text.string().c_str(), pathToEncoded.c_str(), "BWT+MTF+ZRLE+HA");
+
+    for (const std::string pattern : {"e", "the", "in the ", "]]", "no such pattern"}) {
+        Array<uint64_t> expected;
+        for (size_t position = bytes.find(pattern); position != std::string::npos; position = bytes.find(pattern, position + 1)) {
+            expected.push_back(position);
+        }
+        if (FileCompressor::Count(pathToEncoded.c_str(), pattern) != expected.size()) return false;
+        if (!(FileCompressor::Locate(pathToEncoded.c_str(), pattern) == expected)) return false;
+    }
+
+    // files of other codecs can't be searched
+    if (!RoundTrip(text, "LZ77+HA")) return false;
+    return Throws<std::invalid_argument>([&text]() { FileCompressor::Count((text.string() + ".bin").c_str(), "the"); });
+}
+
+bool CheckAppend()
+{
+    // the appended file has another string type (UTF-8 text after ASCII text)
+    const fs::path first = MakeSample(ENWIK_PATH, 1 << 15);
+    const fs::path second = MakeSample(RUSSIAN_PATH, 1 << 14);
+    const std::string expected = ReadFileBytes(first) + ReadFileBytes(second);
+    const std::string pathToEncoded = first.string() + ".append.bin";
+    const std::string pathToDecoded = first.string() + ".append.out";
+    CompressorSettings settings;
+    settings.SetBlockSize(4096);
+
+    FileCompressor::Compress(first.string().c_str(), pathToEncoded.c_str(), "LZ77+HA", settings);
+    const std::string encodedFirst = ReadFileBytes(pathToEncoded);
+    FileCompressor::Append(pathToEncoded.c_str(), second.string().c_str(), settings);
+    FileCompressor::Decompress(pathToEncoded.c_str(), pathToDecoded.c_str(), "LZ77+HA", settings);
+    if (ReadFileBytes(pathToDecoded) != expected) return false;
+
+    // an interrupted append leaves the footer of the first file the last valid one
+    const std::string encoded = ReadFileBytes(pathToEncoded);
+    WriteFileBytes(pathToEncoded, encoded.substr(0, encoded.size() - 3));
+    FileCompressor::Decompress(pathToEncoded.c_str(), pathToDecoded.c_str(), "LZ77+HA", settings);
+    if (ReadFileBytes(pathToDecoded) != ReadFileBytes(first)) return false;
+
+    // junk after the footer is ignored
+    WriteFileBytes(pathToEncoded, encoded + "FBLK junk FBLK");
+    FileCompressor::Decompress(pathToEncoded.c_str(), pathToDecoded.c_str(), "LZ77+HA", settings);
+    return ReadFileBytes(pathToDecoded) == expected && encodedFirst.size() < encoded.size();
+}
+
+bool CheckDelta()
+{
+    // the new version has an inserted, a deleted and a changed part
+    const fs::path reference = MakeSample(ENWIK_PATH, 1 << 16);
+    std::string bytes = ReadFileBytes(reference);
+    bytes.insert(1000, "a new paragraph of the second version\n");
+    bytes.erase(20000, 500);
+    for (size_t i = 40000; i < 40100; ++i) bytes[i] = 'x';
+    const fs::path version = CHECKS_DIR / "version2.txt";
+    WriteFileBytes(version, bytes);
+
+    const std::string pathToEncoded = version.string() + ".delta.bin";
+    const std::string pathToDecoded = version.string() + ".delta.out";
+    FileCompressor::CompressDelta(version.string().c_str(), reference.string().c_str(), pathToEncoded.c_str());
+    FileCompressor::DecompressDelta(pathToEncoded.c_str(), reference.string().c_str(), pathToDecoded.c_str());
+    if (ReadFileBytes(pathToDecoded) != bytes) return false;
+
+    if (!RoundTrip(version, "LZ77+HA")) return false;
+    return fs::file_size(pathToEncoded) * 4 < fs::file_size(version.string() + ".bin");
+}
+
+bool CheckBatchDedup()
+{
+    const fs::path text = MakeSample(ENWIK_PATH, 1 << 15);
+    const fs::path gray = MakeSample(GRAY_PATH, 1280 * 16);
+    const fs::path copy = CHECKS_DIR / "copy.txt";
+    fs::copy_file(text, copy, fs::copy_options::overwrite_existing);
+    const fs::path outputDirectory = CHECKS_DIR / "batch";
+    fs::create_directory(outputDirectory);
+
+    Array<std::string> paths;
+    paths.push_back(text.string());
+    paths.push_back(gray.string());
+    const std::string pathToUnique = (CHECKS_DIR / "unique.batch").string();
+    FileCompressor::CompressBatch(paths, pathToUnique.c_str(), "LZ77+HA");
+
+    paths.push_back(copy.string());
+    const std::string pathToEncoded = (CHECKS_DIR / "dedup.batch").string();
+    FileCompressor::CompressBatch(paths, pathToEncoded.c_str(), "LZ77+HA");
+    FileCompressor::DecompressBatch(pathToEncoded.c_str(), outputDirectory.string().c_str());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (ReadFileBytes(outputDirectory / fs::path(paths[i]).filename()) != ReadFileBytes(paths[i])) return false;
+    }
+    if (FileCompressor::ListBatch(pathToEncoded.c_str()).size() != 3) return false;
+
+    // the copy is stored as references to chunks (or to the whole file) of the first file
+    CompressorSettings settings;
+    settings.SetDedupChunkSize(0);
+    const std::string pathToWhole = (CHECKS_DIR / "whole.batch").string();
+    FileCompressor::CompressBatch(paths, pathToWhole.c_str(), "LZ77+HA", settings);
+    const uintmax_t uniqueSize = fs::file_size(pathToUnique);
+    return fs::file_size(pathToEncoded) < uniqueSize + 1024 && fs::file_size(pathToWhole) < uniqueSize + 1024;
+}
+
+bool CheckSolidBatch()
+{
+    // small files with similar content, every one of them alone is too short for tables of the entropy coder
+    const std::string bytes = ReadFileBytes(MakeSample(ENWIK_PATH, 1 << 15));
+    Array<std::string> paths;
+    for (size_t i = 0; i < 16; ++i) {
+        const fs::path path = CHECKS_DIR / ("part" + std::to_string(i) + ((i % 4 == 0) ? ".raw" : ".txt"));
+        WriteFileBytes(path, bytes.substr(i * 2000, 2000));
+        paths.push_back(path.string());
+    }
+
+    CompressorSettings settings;
+    const std::string pathToSeparate = (CHECKS_DIR / "separate.batch").string();
+    FileCompressor::CompressBatch(paths, pathToSeparate.c_str(), "HA", settings);
+    settings.SetSolidArchive(true);
+    settings.SetBatchOrder(CompressorSettings::SIMILARITY_ORDER);
+    const std::string pathToSolid = (CHECKS_DIR / "solid.batch").string();
+    FileCompressor::CompressBatch(paths, pathToSolid.c_str(), "HA", settings);
+
+    const fs::path outputDirectory = CHECKS_DIR / "solid";
+    fs::create_directory(outputDirectory);
+    FileCompressor::DecompressBatch(pathToSolid.c_str(), outputDirectory.string().c_str());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (ReadFileBytes(outputDirectory / fs::path(paths[i]).filename()) != ReadFileBytes(paths[i])) return false;
+    }
+
+    const std::string pathToExtracted = (CHECKS_DIR / "part5.extracted").string();
+    FileCompressor::ExtractFromBatch(pathToSolid.c_str(), "part5.txt", pathToExtracted.c_str());
+    return ReadFileBytes(pathToExtracted) == ReadFileBytes(paths[5]) && fs::file_size(pathToSolid) < fs::file_size(pathToSeparate);
+}
+
+bool CheckLZ77MaxMode()
+{
+    const fs::path text = MakeSample(ENWIK_PATH, 1 << 16);
+    if (!RoundTrip(text, "LZ77+HA", CompressorSettings::Max()) || !RoundTrip(text, "LZ77", CompressorSettings::Max())) return false;
+
+    // Kasai LCP against comparison of neighbouring suffixes
+    const StringL<char8> str = ToStringL(ReadFileBytes(MakeSample(ENWIK_PATH, 1 << 14)));
+    const Array<int> suffixArr = buildSuffixArray(str, char8('\0'));
+    const Array<uint32_t> lcp = buildLCPArray(str, suffixArr);
+    if (lcp.size() != suffixArr.size() || lcp[0] != 0) return false;
+    for (size_t i = 1; i < suffixArr.size(); ++i) {
+        size_t i1 = static_cast<size_t>(suffixArr[i - 1]), i2 = static_cast<size_t>(suffixArr[i]), length = 0;
+        while (i1 + length < str.size() && i2 + length < str.size() && str[i1 + length] == str[i2 + length]) ++length;
+        if (lcp[i] != length) return false;
+    }
+    return true;
+}
+
+bool CheckFusedBWTKernel()
+{
+    const fs::path text = MakeSample(ENWIK_PATH, 1 << 16);
+    const fs::path russian = MakeSample(RUSSIAN_PATH, 1 << 15);
+    const fs::path gray = MakeSample(GRAY_PATH, 1280 * 64);
+
+    for (const fs::path& path : {text, russian, gray}) {
+        if (!RoundTrip(path, "BWT+MTF+ZRLE+HA") || !RoundTrip(path, "BWT+MTF+ZRLE+AC") || !RoundTrip(path, "BWT+MTF+ZRLE+ANS")) return false;
+    }
+    return RoundTrip(text, "BWT+MTF+ZRLE+HA", CompressorSettings::Fast());
+}
+
+template <typename codeType>
+bool CheckMoveToFrontAlphabet(const size_t alphabetSize)
+{
+    // runs of recent ranks (as after BWT) mixed with random ranks
+    std::mt19937 generator(static_cast<uint32_t>(alphabetSize));
+    Array<uint32_t> ranks(20000, 0);
+    for (size_t i = 1; i < ranks.size(); ++i) {
+        ranks[i] = (generator() % 3 == 0) ? static_cast<uint32_t>(generator() % alphabetSize) : ranks[i - 1 - generator() % std::min<size_t>(i, 4)];
+    }
+
+    std::vector<uint32_t> list(alphabetSize);
+    for (size_t r = 0; r < alphabetSize; ++r) list[r] = static_cast<uint32_t>(r);
+    Array<codeType> expected(ranks.size(), 0);
+    for (size_t i = 0; i < ranks.size(); ++i) {
+        const size_t index = static_cast<size_t>(std::find(list.begin(), list.end(), ranks[i]) - list.begin());
+        expected[i] = static_cast<codeType>(index);
+        list.erase(list.begin() + index);
+        list.insert(list.begin(), ranks[i]);
+    }
+
+    Array<codeType> codes(ranks.size(), 0);
+    MoveToFront::Encode(ranks.c_arr(), ranks.size(), alphabetSize, codes.begin());
+    if (!(codes == expected)) return false;
+    Array<uint32_t> decoded(ranks.size(), 0);
+    MoveToFront::Decode(codes.c_arr(), codes.size(), alphabetSize, decoded.begin());
+    if (!(decoded == ranks)) return false;
+
+    codes[codes.size() / 2] = static_cast<codeType>(alphabetSize);
+    return Throws<std::runtime_error>([&]() { MoveToFront::Decode(codes.c_arr(), codes.size(), alphabetSize, decoded.begin()); });
+}
+
+bool CheckMoveToFront()
+{
+    // byte list, list of ranks and Fenwick tree engines
+    return CheckMoveToFrontAlphabet<uint8_t>(200) && CheckMoveToFrontAlphabet<uint16_t>(1000) && CheckMoveToFrontAlphabet<uint16_t>(5000);
+}
+
+bool CheckMemoryBudget()
+{
+    const fs::path text = MakeSample(ENWIK_PATH, 1 << 16);
+    const StringL<char8> str = ToStringL(ReadFileBytes(text));
+    if (!(buildSuffixArrayLowMemory(str, char8('\0')) == buildSuffixArray(str, char8('\0')))) return false;
+
+    // every block is larger than the budget
+    CompressorSettings settings;
+    settings.SetMemoryBudget(1);
+    const fs::path russian = MakeSample(RUSSIAN_PATH, 1 << 15);
+    return RoundTrip(text, "BWT+MTF+ZRLE+HA", settings) && RoundTrip(russian, "BWT+MTF+ZRLE+HA", settings);
+}
+
+bool CheckMemoryStats()
+{
+    const fs::path text = MakeSample(ENWIK_PATH, 1 << 16);
+    FileCompressor::EnableMemoryStats(true);
+    FileCompressor::ResetMemoryStats();
+    const bool roundTrip = RoundTrip(text, "BWT+MTF+ZRLE+HA");
+    const MemoryStats::report report = FileCompressor::GetMemoryStats();
+    FileCompressor::EnableMemoryStats(false);
+
+    return roundTrip && report.allocations > 0 && report.frees > 0 && report.peakLiveBytes > 0 &&
+        report.peakLiveBytes <= report.allocatedBytes && !report.stages.empty() && !report.toString().empty();
+}
+
 // END IMPLEMENTATION
\ No newline at end of file
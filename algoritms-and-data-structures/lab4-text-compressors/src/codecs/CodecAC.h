@@ -9,6 +9,9 @@
 #include "../helpers/TextUtils.h"
 #include "../helpers/BinaryUtils.h"
 #include "../helpers/BitArray.h"
+#include "../helpers/BitStream.h"
+#include "../helpers/ACDecodeTable.h"
+#include "../helpers/AlphabetMap.h"
 #include "../helpers/StringL.h"
 #include "../helpers/Array.h"
 
@@ -25,6 +28,10 @@
  * Memory usage:
  * ...
  * 
+ * Details:
+ * - Every character is encoded by halving [0, 1) until the half lies in the segment of the character,
+ *   so decoder finds characters by ACDecodeTable (lookup by the next bits) instead of halving bit by bit
+ * - The number of encoded bits is calculated from frequencies and lengths of bits of characters, so encoded bytes are read at once
  */
 template <typename charType>
 class CodecAC
@@ -37,8 +44,8 @@ private:
 
     static inline void backSortInParallel(Array<charType>& alphabet, Array<double>& frequencies);
     static Array<double> calculateSegments(const Array<charType>& alphabet, const Array<double>& frequencies);
-    static inline void binSearchStep(const Array<double>& segments, const double value, const char directionBit, int& start, int& end);
-    static inline bool foundLetter(const Array<double>& segments, const size_t index, const double low, const double high);
+    static uint64_t getEncodedBitsCount(const ACDecodeTable& table, const Array<double>& frequencies, const uint32_t strLength);
+    static StringL<charType> decodeCharacters(const ACDecodeTable& table, const Array<charType>& alphabet, const uint8_t* encoded, const size_t encodedSize, const uint32_t strLength);
     static void encodeFrequencies(std::ofstream& outputFile, const uint32_t strLength, const Array<double>& frequencies);
     static Array<double> decodeFrequencies(std::ifstream& inputFile, const uint32_t strLength, const uint32_t alphabetLength);
 protected:
@@ -76,10 +83,19 @@ void CodecAC<charType>::Encode(StringL<charType>& inputStr, std::ofstream& outpu
     double low_temp, high_temp, mid_temp;
     BitArray encodedBits;
 
-    Array<charType> alphabet = TextUtils::GetAlphabet(inputStr);
-    Array<double> frequencies = TextUtils::GetFrequencies(inputStr, alphabet);
+    // dense ranks of characters: alphabet, frequencies and index of every character by array lookups
+    AlphabetMap<charType> alphabetMap(inputStr);
+    Array<charType> alphabet = alphabetMap.GetSymbols();
+    Array<double> frequencies(alphabet.size());
+    for (const uint32_t& count : alphabetMap.GetCounts()) {
+        frequencies.push_back(static_cast<double>(count) / static_cast<double>(inputStr.size()));
+    }
     backSortInParallel(alphabet, frequencies);
     Array<double> segments = calculateSegments(alphabet, frequencies);
+    Array<uint32_t> indexOfRank(alphabet.size(), 0);
+    for (size_t i = 0; i < alphabet.size(); ++i) {
+        indexOfRank[alphabetMap.Rank(alphabet[i])] = static_cast<uint32_t>(i);
+    }
 
     // preallocate memory for encodedBits (considering the worst case)
     int k = 1, temp = alphabet.size();
@@ -92,9 +108,7 @@ void CodecAC<charType>::Encode(StringL<charType>& inputStr, std::ofstream& outpu
     for (const charType& c : inputStr)
 	{
         // find index of current character in alphabet
-        for (index = 0; index < alphabet.size(); ++index) {
-            if (c == alphabet[index]) break;
-        }
+        index = indexOfRank[alphabetMap.Rank(c)];
 
         // reset bound which using to find correct segment during character encoding
         high_temp = 1.0;
@@ -158,56 +172,20 @@ StringL<charType> CodecAC<charType>::Decode(std::ifstream& inputFile, const bool
         }
     }
     Array<double> frequencies = decodeFrequencies(inputFile, inputStrLength, alphabet.size());
-    Array<double> segments = calculateSegments(alphabet, frequencies);
-
-    // define main variables
-    double low, high, mid;
-    int segments_lowInd, segments_highInd;
-    size_t i = 0;
-    StringL<char> encodedBitsBlock = BinaryUtils::GetBinaryStringFromNumber<uint8_t>(
-        FileUtils::ReadValueBinary<uint8_t>(inputFile), 8);
-    
-    // define decodedStr and preallocate memory for it
-    StringL<charType> decodedStr(inputStrLength);
-
-    while (decodedStr.size() < inputStrLength) {
-        low = 0.0; high = 1.0;
-        mid = (high + low) / 2.0;
-
-        segments_lowInd = 0;
-        segments_highInd = segments.size() - 1;
-
-        while (true)
-        {
-            if (i == 8) {
-                encodedBitsBlock = BinaryUtils::GetBinaryStringFromNumber<uint8_t>(
-                    FileUtils::ReadValueBinary<uint8_t>(inputFile), 8);
-                i = 0;
-            }
-
-            if (encodedBitsBlock[i] == '0') {
-                high = mid;
-            } else {
-                low = mid;
-            }
-
-            binSearchStep(segments, mid, encodedBitsBlock[i], segments_lowInd, segments_highInd);
-            
-            mid = (high + low) / 2.0;
-            ++i;
-
-            if (segments_lowInd >= segments_highInd - 1) {
-                if (foundLetter(segments, segments_lowInd, low, high)) {
-                    break;
-                }
-            }
-        }
-
-
-        decodedStr.push_back(alphabet[segments_lowInd]);
+    if (alphabetLength == 0 || !inputFile) {
+        throw std::runtime_error("CodecAC: Corrupted data!");
     }
-    
-    return decodedStr;
+    ACDecodeTable table(calculateSegments(alphabet, frequencies), alphabet.size());
+
+    // read all encoded bytes at once
+    const uint64_t encodedBitsCount = getEncodedBitsCount(table, frequencies, inputStrLength);
+    Array<uint8_t> encoded(static_cast<size_t>((encodedBitsCount + 7) / 8), 0);
+    inputFile.read(reinterpret_cast<char*>(encoded.begin()), encoded.size());
+    if (static_cast<size_t>(inputFile.gcount()) != encoded.size()) {
+        throw std::runtime_error("CodecAC: Corrupted data!");
+    }
+
+    return decodeCharacters(table, alphabet, encoded.c_arr(), encoded.size(), inputStrLength);
 }
 
 // ==== PRIVATE
@@ -255,43 +233,25 @@ Array<double> CodecAC<charType>::calculateSegments(const Array<charType>& alphab
 }
 
 template <typename charType>
-void CodecAC<charType>::binSearchStep(const Array<double>& segments, const double value, const char directionBit, int& start, int& end)
+uint64_t CodecAC<charType>::getEncodedBitsCount(const ACDecodeTable& table, const Array<double>& frequencies, const uint32_t strLength)
 {
-    // function change given start and end bounds
-    // by dividing segments on a smaller part depending on value and directionBit
-    // final bounds shows if we found decoded a letter
-    // is also speed up the program using binary search and not check excess bounds every time  
-
-    if (!((segments[start] <= value) && (value <= segments[end]))) {
-        throw std::runtime_error("CodecAC error: value is not in [segments[start], segments[end]]");
-    }
-
-    int left = start, right = end;
-    int center = (left + right) / 2;
-    
-    while (true) {
-        if (value >= segments[center])
-            left = center;
-        else
-            right = center;
-        
-        center = (left + right) / 2;
-        if (left >= right - 1){
-            if (directionBit == '0') {
-                end = right;
-            } else {
-                start = left;
-            }
-            return;
-        }
+    // every occurrence of a character is encoded by the same bits
+    uint64_t bitsCount = 0;
+    for (size_t i = 0; i < frequencies.size(); ++i) {
+        bitsCount += static_cast<uint64_t>(std::llround(frequencies[i] * strLength)) * table.GetCodeLength(i);
     }
+    return bitsCount;
 }
 
 template <typename charType>
-bool CodecAC<charType>::foundLetter(const Array<double>& segments, const size_t index, const double low, const double high)
+StringL<charType> CodecAC<charType>::decodeCharacters(const ACDecodeTable& table, const Array<charType>& alphabet, const uint8_t* encoded, const size_t encodedSize, const uint32_t strLength)
 {
-    // returns true if low and high refer to specific letter (i.e. if we decode a letter)
-    return (low >= segments[index]) && (high <= segments[index + 1]);
+    BitReader reader(encoded, encodedSize);
+    StringL<charType> decodedStr(strLength);
+    while (decodedStr.size() < strLength) {
+        decodedStr.push_back(alphabet[table.DecodeIndex(reader)]);
+    }
+    return decodedStr;
 }
 
 template <typename charType>
@@ -368,10 +328,19 @@ typename CodecAC<charType>::data CodecAC<charType>::encodeToData(const StringL<c
     double low_temp, high_temp, mid_temp;
     BitArray encodedBits;
 
-    Array<charType> alphabet = TextUtils::GetAlphabet<charType>(inputStr);
-    Array<double> frequencies = TextUtils::GetFrequencies(inputStr, alphabet);
+    // dense ranks of characters: alphabet, frequencies and index of every character by array lookups
+    AlphabetMap<charType> alphabetMap(inputStr);
+    Array<charType> alphabet = alphabetMap.GetSymbols();
+    Array<double> frequencies(alphabet.size());
+    for (const uint32_t& count : alphabetMap.GetCounts()) {
+        frequencies.push_back(static_cast<double>(count) / static_cast<double>(inputStr.size()));
+    }
     backSortInParallel(alphabet, frequencies);
     Array<double> segments = calculateSegments(alphabet, frequencies);
+    Array<uint32_t> indexOfRank(alphabet.size(), 0);
+    for (size_t i = 0; i < alphabet.size(); ++i) {
+        indexOfRank[alphabetMap.Rank(alphabet[i])] = static_cast<uint32_t>(i);
+    }
 
     // preallocate memory for encodedBits (considering the worst case)
     int k = 1, temp = alphabet.size();
@@ -383,9 +352,7 @@ typename CodecAC<charType>::data CodecAC<charType>::encodeToData(const StringL<c
     for (const charType& c : inputStr)
 	{
         // find index of current character in alphabet
-        for (index = 0; index < alphabet.size(); ++index) {
-            if (c == alphabet[index]) break;
-        }
+        index = indexOfRank[alphabetMap.Rank(c)];
 
         // reset bound which using to find correct segment during character encoding
         high_temp = 1.0;
@@ -442,47 +409,15 @@ StringL<charType> CodecAC<charType>::decodeData(const data& data)
         return StringL<charType>();
     }
 
-    StringL<charType> decodedStr(data.inputStrLength);
-    
-    // define main variables
-    Array<double> segments = calculateSegments(data.alphabet, data.frequencies);
-    double low, high, mid;
-    int segments_lowInd, segments_highInd;
-    char bit;
-    size_t i = 0;
-
-    while (decodedStr.size() < data.inputStrLength) {
-        low = 0.0; high = 1.0;
-        mid = (high + low) / 2.0;
-
-        segments_lowInd = 0;
-        segments_highInd = segments.size() - 1;
-
-        while (true)
-        {
-            bit = data.resultValue.get_bit(i);
-            if (bit == '0') {
-                high = mid;
-            } else {
-                low = mid;
-            }
-
-            binSearchStep(segments, mid, bit, segments_lowInd, segments_highInd);
-            
-            mid = (high + low) / 2.0;
-            ++i;
-
-            if (segments_lowInd >= segments_highInd - 1) {
-                if (foundLetter(segments, segments_lowInd, low, high)) {
-                    break;
-                }
-            }
-        }
+    ACDecodeTable table(calculateSegments(data.alphabet, data.frequencies), data.alphabet.size());
 
-        decodedStr.push_back(data.alphabet[segments_lowInd]);
+    // bits of the last block of BitArray are aligned to the right, BitReader needs them from the left
+    Array<uint8_t> encoded = data.resultValue.array().copy();
+    if (data.resultValue.size() % 8 != 0) {
+        encoded[encoded.size() - 1] <<= (8 - data.resultValue.size() % 8);
     }
 
-    return decodedStr;
+    return decodeCharacters(table, data.alphabet, encoded.c_arr(), encoded.size(), data.inputStrLength);
 }
 
 
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#include "../helpers/FileUtils.h"
+#include "../helpers/BitStream.h"
+#include "../helpers/ANSTable.h"
+#include "../helpers/AlphabetMap.h"
+#include "../helpers/StringL.h"
+#include "../helpers/Array.h"
+
+/**
+ * CodecANS (encoder - decoder).
+ *
+ * Brief:
+ * - Class defines static methods to encode / decode any string given in StringL class using tabled asymmetric numeral systems (tANS)
+ * - It also defines methods to use a class with other codecs. Those methods defined in "protected"
+ *
+ * Parameters:
+ * - charType - The unsigned type of the characters in the string (unsigned char, char16_t/unsigned short , char32_t/unsigned int).
+ *
+ * Memory usage:
+ * θ(sizeof(inputStr)) + θ(BLOCK_SIZE + 2^ANSTable::MAX_TABLE_LOG)
+ *
+ * Details:
+ * - Every block (BLOCK_SIZE characters) has its own table: frequencies are normalized to a power of two (ANSTable),
+ *   so characters cost fractional numbers of bits like in AC, and are decoded by one table lookup like in HA
+ * - The table of a block is written compactly: log2 of its size, gaps between characters of the alphabet (ascending)
+ *   and normalized frequencies minus one (without the last one) with the smallest fixed number of bits. Characters are written as numbers,
+ *   so utf-8 flag isn't needed
+ * - ANS encodes backwards: encoder goes from the last character to the first and keeps bits of every step,
+ *   then writes the final states and the bits in reverse order, so decoder reads one forward bit stream
+ * - Character i of a block belongs to state i % STATES_COUNT: decoder advances STATES_COUNT independent states in one loop,
+ *   so table lookups of neighbouring characters don't wait for each other. All states of a correct block end with 0
+ */
+template <typename charType>
+class CodecANS
+{
+public:
+    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+private:
+    CodecANS() = default;
+
+    static const uint32_t BLOCK_SIZE = 1 << 16;
+    static const uint8_t STATES_COUNT = 4;
+    static const uint32_t TABLE_LOG_BITS = 5;
+    static const uint32_t CHUNK_LENGTH_BITS = 5; // bits of a step are kept as (bits << CHUNK_LENGTH_BITS) | length
+
+    static void writeNumbers(BitWriter& writer, const Array<uint32_t>& numbers);
+    static void readNumbers(BitReader& reader, const size_t count, Array<uint32_t>& numbers);
+protected:
+    struct data_local {
+        uint32_t alphabetLength;
+        Array<uint8_t> encoded; // table and bits of the block
+        data_local(const uint32_t _alphabetLength, const Array<uint8_t>& _encoded) : alphabetLength(_alphabetLength), encoded(_encoded) {}
+        data_local() = default;
+    };
+    struct data {
+        uint32_t inputStrSize;
+        uint32_t blockSize;
+        uint8_t statesCount;
+        Array<data_local> localDataItems;
+        data(const uint32_t _inputStrSize, const uint32_t _blockSize, const uint8_t _statesCount, const Array<data_local>& _localDataItems) :
+            inputStrSize(_inputStrSize), blockSize(_blockSize), statesCount(_statesCount), localDataItems(_localDataItems) {}
+        data() = default;
+    };
+
+    static data_local encodeBlock(const charType* chars, const size_t size);
+    static void writeBlock(std::ofstream& outputFile, const data_local& localData);
+    static data_local readBlock(std::ifstream& inputFile);
+    static void decodeBlock(const data_local& localData, const size_t localSize, StringL<charType>& decodedStr);
+
+    static data encodeToData(const StringL<charType>& inputStr);
+    static void encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8);
+    static StringL<charType> decodeData(const data& data);
+};
+
+
+// START IMPLEMENTATION
+
+// ==== PUBLIC
+
+template <typename charType>
+void CodecANS<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool /*useUTF8*/)
+{
+    // characters are written as numbers of the table, the same way for any useUTF8
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(inputStr.size()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(BLOCK_SIZE));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(STATES_COUNT));
+
+    for (size_t blockStart = 0; blockStart < inputStr.size(); blockStart += BLOCK_SIZE) {
+        const size_t localSize = std::min<size_t>(BLOCK_SIZE, inputStr.size() - blockStart);
+        writeBlock(outputFile, encodeBlock(inputStr.c_str() + blockStart, localSize));
+    }
+}
+
+template <typename charType>
+StringL<charType> CodecANS<charType>::Decode(std::ifstream& inputFile, const bool /*useUTF8*/)
+{
+    const uint32_t inputStrSize = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    const uint32_t blockSize = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    const uint8_t statesCount = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+    if (blockSize == 0 || statesCount != STATES_COUNT) {
+        throw std::runtime_error("CodecANS::Decode(): Corrupted data!");
+    }
+
+    StringL<charType> decodedStr(inputStrSize);
+    while (decodedStr.size() < inputStrSize) {
+        const size_t localSize = std::min<size_t>(blockSize, inputStrSize - decodedStr.size());
+        decodeBlock(readBlock(inputFile), localSize, decodedStr);
+    }
+
+    return decodedStr;
+}
+
+// ==== PRIVATE
+
+template <typename charType>
+void CodecANS<charType>::writeNumbers(BitWriter& writer, const Array<uint32_t>& numbers)
+{
+    // number of bits of the largest number, then all numbers with this number of bits
+    uint32_t maxBits = 0;
+    for (const uint32_t& number : numbers) {
+        while (maxBits < 32 && (number >> maxBits) != 0) ++maxBits;
+    }
+    writer.Write(maxBits, 6);
+    for (const uint32_t& number : numbers) {
+        writer.Write(number, maxBits);
+    }
+}
+
+template <typename charType>
+void CodecANS<charType>::readNumbers(BitReader& reader, const size_t count, Array<uint32_t>& numbers)
+{
+    const uint32_t maxBits = reader.Read(6);
+    if (maxBits > 32) {
+        throw std::runtime_error("CodecANS: Corrupted data!");
+    }
+    numbers.clear();
+    for (size_t i = 0; i < count; ++i) {
+        numbers.push_back(reader.Read(maxBits));
+    }
+}
+
+// ==== PROTECTED
+
+template <typename charType>
+typename CodecANS<charType>::data_local CodecANS<charType>::encodeBlock(const charType* chars, const size_t size)
+{
+    // replace characters by dense ranks and normalize their frequencies
+    AlphabetMap<charType> alphabetMap(chars, size);
+    Array<charType> ranks(size, 0);
+    alphabetMap.ToRanks(chars, size, ranks.begin());
+    const uint32_t tableLog = ANSTable::GetTableLog(size, alphabetMap.Size());
+    Array<uint32_t> norms;
+    ANSTable::Normalize(alphabetMap.GetCounts(), tableLog, norms);
+    ANSEncodeTable table;
+    table.Build(norms, tableLog);
+
+    // encode backwards, bits of every step are kept to be written in reverse order
+    Array<uint32_t> chunks(size);
+    uint32_t states[STATES_COUNT];
+    for (uint8_t k = 0; k < STATES_COUNT; ++k) {
+        states[k] = table.GetInitialState();
+    }
+    for (size_t i = size; i-- > 0;) {
+        uint32_t bits, length;
+        uint32_t& state = states[i % STATES_COUNT];
+        state = table.EncodeSymbol(state, ranks[i], bits, length);
+        chunks.push_back((bits << CHUNK_LENGTH_BITS) | length);
+    }
+
+    // write table: log2 of its size, gaps between characters, norms - 1 (the last one is known from the sum)
+    Array<uint8_t> encoded(size / 2 + 64);
+    BitWriter writer(encoded);
+    writer.Write(tableLog, TABLE_LOG_BITS);
+    const Array<charType>& symbols = alphabetMap.GetSymbols();
+    Array<uint32_t> numbers(symbols.size());
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        numbers.push_back(static_cast<uint32_t>((i == 0) ? symbols[0] : symbols[i] - symbols[i - 1] - 1));
+    }
+    writeNumbers(writer, numbers);
+    numbers.clear();
+    for (size_t i = 0; i + 1 < norms.size(); ++i) {
+        numbers.push_back(norms[i] - 1);
+    }
+    writeNumbers(writer, numbers);
+
+    // write final states (initial states of decoder) and bits of steps from the first character to the last
+    for (uint8_t k = 0; k < STATES_COUNT; ++k) {
+        writer.Write(states[k] - (1u << tableLog), tableLog);
+    }
+    for (size_t i = chunks.size(); i-- > 0;) {
+        writer.Write(chunks[i] >> CHUNK_LENGTH_BITS, chunks[i] & ((1u << CHUNK_LENGTH_BITS) - 1));
+    }
+    writer.Flush();
+
+    return data_local(static_cast<uint32_t>(symbols.size()), encoded);
+}
+
+template <typename charType>
+void CodecANS<charType>::writeBlock(std::ofstream& outputFile, const data_local& localData)
+{
+    FileUtils::AppendValueBinary(outputFile, localData.alphabetLength);
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(localData.encoded.size()));
+    outputFile.write(reinterpret_cast<const char*>(localData.encoded.c_arr()), localData.encoded.size());
+}
+
+template <typename charType>
+typename CodecANS<charType>::data_local CodecANS<charType>::readBlock(std::ifstream& inputFile)
+{
+    const uint32_t alphabetLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    const uint32_t encodedSize = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    if (inputFile.eof()) {
+        throw std::runtime_error("CodecANS: Corrupted data!");
+    }
+    Array<uint8_t> encoded(encodedSize, 0);
+    inputFile.read(reinterpret_cast<char*>(encoded.begin()), encodedSize);
+    if (static_cast<uint32_t>(inputFile.gcount()) != encodedSize) {
+        throw std::runtime_error("CodecANS: Corrupted data!");
+    }
+
+    return data_local(alphabetLength, encoded);
+}
+
+template <typename charType>
+void CodecANS<charType>::decodeBlock(const data_local& localData, const size_t localSize, StringL<charType>& decodedStr)
+{
+    BitReader reader(localData.encoded.c_arr(), localData.encoded.size());
+    const uint32_t tableLog = reader.Read(TABLE_LOG_BITS);
+    if (tableLog < ANSTable::MIN_TABLE_LOG || tableLog > ANSTable::MAX_TABLE_LOG ||
+        localData.alphabetLength == 0 || localData.alphabetLength > (1u << tableLog)) {
+        throw std::runtime_error("CodecANS: Corrupted data!");
+    }
+    const uint32_t tableSize = 1u << tableLog;
+
+    // read alphabet from gaps
+    Array<uint32_t> numbers;
+    readNumbers(reader, localData.alphabetLength, numbers);
+    Array<charType> symbols(localData.alphabetLength);
+    uint64_t symbol = 0;
+    for (uint32_t i = 0; i < localData.alphabetLength; ++i) {
+        symbol = (i == 0) ? numbers[0] : symbol + numbers[i] + 1;
+        if (symbol > std::numeric_limits<charType>::max()) {
+            throw std::runtime_error("CodecANS: Corrupted data!");
+        }
+        symbols.push_back(static_cast<charType>(symbol));
+    }
+
+    // read norms, the last one is the rest of the table
+    readNumbers(reader, localData.alphabetLength - 1, numbers);
+    Array<uint32_t> norms(localData.alphabetLength);
+    uint64_t sum = 0;
+    for (const uint32_t& number : numbers) {
+        norms.push_back(number + 1);
+        sum += static_cast<uint64_t>(number) + 1;
+    }
+    if (sum >= tableSize) {
+        throw std::runtime_error("CodecANS: Corrupted data!");
+    }
+    norms.push_back(static_cast<uint32_t>(tableSize - sum));
+    ANSDecodeTable<charType> table;
+    table.Build(symbols, norms, tableLog);
+
+    // decode states in round-robin order
+    uint32_t states[STATES_COUNT];
+    for (uint8_t k = 0; k < STATES_COUNT; ++k) {
+        states[k] = reader.Read(tableLog);
+    }
+    size_t i = 0;
+    for (; i + STATES_COUNT <= localSize; i += STATES_COUNT) {
+        for (uint8_t k = 0; k < STATES_COUNT; ++k) {
+            decodedStr.push_back(table.DecodeSymbol(states[k], reader));
+        }
+    }
+    for (uint8_t k = 0; i < localSize; ++i, ++k) {
+        decodedStr.push_back(table.DecodeSymbol(states[k], reader));
+    }
+    for (uint8_t k = 0; k < STATES_COUNT; ++k) {
+        if (states[k] != 0) {
+            throw std::runtime_error("CodecANS: Corrupted data!");
+        }
+    }
+}
+
+template <typename charType>
+typename CodecANS<charType>::data CodecANS<charType>::encodeToData(const StringL<charType>& inputStr)
+{
+    Array<data_local> localDataItems;
+    for (size_t blockStart = 0; blockStart < inputStr.size(); blockStart += BLOCK_SIZE) {
+        const size_t localSize = std::min<size_t>(BLOCK_SIZE, inputStr.size() - blockStart);
+        localDataItems.push_back(encodeBlock(inputStr.c_str() + blockStart, localSize));
+    }
+
+    return data(inputStr.size(), BLOCK_SIZE, STATES_COUNT, localDataItems);
+}
+
+template <typename charType>
+void CodecANS<charType>::encodeData(std::ofstream& outputFile, const data& data, const bool /*useUTF8*/)
+{
+    FileUtils::AppendValueBinary(outputFile, data.inputStrSize);
+    FileUtils::AppendValueBinary(outputFile, data.blockSize);
+    FileUtils::AppendValueBinary(outputFile, data.statesCount);
+
+    for (const auto& localData : data.localDataItems) {
+        writeBlock(outputFile, localData);
+    }
+}
+
+template <typename charType>
+StringL<charType> CodecANS<charType>::decodeData(const data& data)
+{
+    StringL<charType> decodedStr(data.inputStrSize);
+    for (const auto& localData : data.localDataItems) {
+        const size_t localSize = std::min<size_t>(data.blockSize, data.inputStrSize - decodedStr.size());
+        decodeBlock(localData, localSize, decodedStr);
+    }
+
+    return decodedStr;
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
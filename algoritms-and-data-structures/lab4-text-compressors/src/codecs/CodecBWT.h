@@ -2,12 +2,18 @@
 
 #include <string>
 #include <cstdint>
+#include <thread>
+#include <vector>
+#include <stdexcept>
 
 #include "../helpers/FileUtils.h"
 #include "../helpers/CodecUTF8.h"
 #include "../helpers/SuffixArray.h"
 #include "../helpers/StringL.h"
 #include "../helpers/Pair.h"
+#include "../helpers/SimdUtils.h"
+
+#include "../compressor/CompressorSettings.h"
 
 /**
  * CodecBWT (encoder - decoder).
@@ -20,28 +26,60 @@
  * - charType - The type of the characters in the string (unsigned char, char16_t/unsigned short , char32_t/unsigned int).
  * 
  * Memory usage:
- * θ(16 * inputStr.size()) + O(1)
+ * θ(16 * inputStr.size()) + O(1) (θ((4 + sizeof(charType)) * inputStr.size()) in the low-memory mode)
  * 
+ * Details:
+ * - Strings not shorter than settings.GetParallelSuffixArrayThreshold() use parallel suffix array construction
+ *   with settings.GetSuffixArrayThreadsCount() threads (the result is the same)
+ * - If prefix doubling (PREFIX_DOUBLING_BYTES_PER_CHAR bytes per character besides the string and the output) would exceed settings.GetMemoryBudget(),
+ *   the suffix array is built by SA-IS (buildSuffixArrayLowMemory()): only the int32 suffix array, bit types of suffixes and buckets are allocated,
+ *   the reduced string of every recursion level is kept in the suffix array itself. The output is the same, so decoding doesn't change
+ * - Construction of the suffix array is the stage "BWT suffix array" of MemoryStats (its peak is the memory checked against the budget)
+ * - Encoder stores settings.GetBWTCheckpointsCount() checkpoints besides the primary index: rows of the positions
+ *   step, 2 * step, ... of the string (segments are not shorter than MIN_SEGMENT_LENGTH), so the inverse transform
+ *   starts from every checkpoint independently. Decoder chases INTERLEAVED_SEGMENTS segments at once with prefetching
+ *   of the next rows (the chase has a cache miss per character), segments are split between hardware threads
  */
 template <typename charType>
 class CodecBWT
 {
 public:
-    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings = CompressorSettings());
     static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+    // reads the BWT string, its primary index and checkpoints without the inverse transform
+    static StringL<charType> DecodeBWT(std::ifstream& inputFile, const bool useUTF8, uint32_t& index, uint32_t& checkpointStep, Array<uint32_t>& checkpoints);
 private:
     CodecBWT() = default;
+
+    static const uint32_t MIN_SEGMENT_LENGTH = 1 << 14;
+    static const size_t INTERLEAVED_SEGMENTS = 8;
+    static const size_t PREFIX_DOUBLING_BYTES_PER_CHAR = 20; // suffix records or rank arrays and the resulting suffix array
+
+    static void decodeSegments(const Array<Pair<charType, uint32_t>>& P, const charType* encodedStr, const Array<uint32_t>& startRows,
+                               const size_t first, const size_t last, const size_t segmentLength, const size_t length, charType* output);
 protected:
     struct data {
         uint32_t index;
         uint32_t encodedStrLength; // = 1 + [length of inputStr]
         StringL<charType> encodedStr;
+        uint32_t checkpointStep = 0;
+        Array<uint32_t> checkpoints; // row of the position checkpointStep * (i + 1) of inputStr
         data() = default;
         data(const uint32_t _index, const uint32_t _encodedStrLength, const StringL<charType>& _encodedStr) : 
             index(_index), encodedStrLength(_encodedStrLength), encodedStr(_encodedStr) {}
+        data(const uint32_t _index, const uint32_t _encodedStrLength, const StringL<charType>& _encodedStr,
+             const uint32_t _checkpointStep, const Array<uint32_t>& _checkpoints) :
+            index(_index), encodedStrLength(_encodedStrLength), encodedStr(_encodedStr), checkpointStep(_checkpointStep), checkpoints(_checkpoints) {}
     };
 
-    static data encodeToData(const StringL<charType>& inputStr);
+    static Array<int> getSuffixArray(const StringL<charType>& inputStr, const charType endChar, const CompressorSettings& settings);
+    // distance between checkpoints (0 - no checkpoints)
+    static uint32_t getCheckpointStep(const uint32_t length, const size_t checkpointsCount);
+
+    static void encodeCheckpoints(std::ofstream& outputFile, const uint32_t checkpointStep, const Array<uint32_t>& checkpoints);
+    static void decodeCheckpoints(std::ifstream& inputFile, uint32_t& checkpointStep, Array<uint32_t>& checkpoints);
+
+    static data encodeToData(const StringL<charType>& inputStr, const CompressorSettings& settings = CompressorSettings());
     static void encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8);
     
     static StringL<charType> decodeData(const data& data);
@@ -53,42 +91,25 @@ protected:
 // ==== PUBLIC ====
 
 template <typename charType>
-void CodecBWT<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+void CodecBWT<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings)
 {
-    // first character in ASII (to put at the end of string to get correct suffix array)
-    const charType endChar = '\0';
-
-    // build suffix array from "inputStr + endChar"
-    Array<int> suffixArray = buildSuffixArray(inputStr, endChar);
-
-    uint32_t index;
-    StringL<charType> encodedStr(inputStr.size() + 1); // inputStr + end char
+    encodeData(outputFile, encodeToData(inputStr, settings), useUTF8);
+}
 
-    // Burrows-Wheeler transform
-    for (size_t i = 0; i < suffixArray.size(); ++i) {
-        size_t ind = (suffixArray[i] == 0) ? (inputStr.size() + 1 - 1) : (suffixArray[i] - 1);
-        encodedStr.push_back( ind == inputStr.size() ? endChar : inputStr[ind] );
-        if (suffixArray[i] == 0) {
-            index = i;
-        }
-    }
+template <typename charType>
+StringL<charType> CodecBWT<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+{
+    data data;
+    data.encodedStr = DecodeBWT(inputFile, useUTF8, data.index, data.checkpointStep, data.checkpoints);
+    data.encodedStrLength = static_cast<uint32_t>(data.encodedStr.size());
 
-    // write data to file
-    FileUtils::AppendValueBinary(outputFile, index);
-    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(inputStr.size()) + 1);
-    if (useUTF8) {
-        for (const auto& c : encodedStr)
-            CodecUTF8::EncodeCharToBinaryFile(outputFile, c);
-    } else {
-        for (const auto& c : encodedStr)
-            FileUtils::AppendValueBinary(outputFile, c);
-    }
+    return decodeData(data);
 }
 
 template <typename charType>
-StringL<charType> CodecBWT<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+StringL<charType> CodecBWT<charType>::DecodeBWT(std::ifstream& inputFile, const bool useUTF8, uint32_t& index, uint32_t& checkpointStep, Array<uint32_t>& checkpoints)
 {
-    uint32_t index = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    index = FileUtils::ReadValueBinary<uint32_t>(inputFile);
     uint32_t encodedStrLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
 
     StringL<charType> encodedStr(encodedStrLength);
@@ -101,50 +122,96 @@ StringL<charType> CodecBWT<charType>::Decode(std::ifstream& inputFile, const boo
             encodedStr.push_back(FileUtils::ReadValueBinary<charType>(inputFile));
         }
     }
+    decodeCheckpoints(inputFile, checkpointStep, checkpoints);
 
-    Array<Pair<charType, unsigned int>> P(encodedStrLength);
-    for (uint32_t i = 0; i < encodedStrLength; ++i) {
-        P.push_back(Pair(encodedStr[i], i));
-    }
+    return encodedStr;
+}
 
-    auto cmp = [](const Pair<charType, unsigned int>& a, const Pair<charType, unsigned int>& b) {
-        return a.first < b.first;
-    };
-    std::stable_sort(P.begin(), P.end(), cmp); // I don't know why but only with stable sort work correct
+// ==== PRIVATE ====
+
+template <typename charType>
+Array<int> CodecBWT<charType>::getSuffixArray(const StringL<charType>& inputStr, const charType endChar, const CompressorSettings& settings)
+{
+    MemoryStats::Scope scope("BWT suffix array");
+    const size_t budget = settings.GetMemoryBudget();
+    if (budget > 0 && inputStr.size() > budget / (PREFIX_DOUBLING_BYTES_PER_CHAR + sizeof(charType))) {
+        return buildSuffixArrayLowMemory(inputStr, endChar);
+    }
+    if (inputStr.size() >= settings.GetParallelSuffixArrayThreshold()) {
+        return buildSuffixArrayParallel(inputStr, endChar, settings.GetSuffixArrayThreadsCount());
+    }
+    return buildSuffixArray(inputStr, endChar);
+}
 
-    StringL<charType> decodedStr(encodedStrLength - 1);
-    for (uint32_t i = 0; i < encodedStrLength - 1; ++i) {
-        // encodedStrLength - 1 to avoid reading '\0' character which has been pushed in encoding function
-        index = P[index].second;
-        decodedStr.push_back(encodedStr[index]);
+template <typename charType>
+uint32_t CodecBWT<charType>::getCheckpointStep(const uint32_t length, const size_t checkpointsCount)
+{
+    if (checkpointsCount == 0 || length < 2 * MIN_SEGMENT_LENGTH) {
+        return 0;
     }
+    const uint64_t step = (static_cast<uint64_t>(length) + checkpointsCount) / (checkpointsCount + 1);
+    return (step < MIN_SEGMENT_LENGTH) ? MIN_SEGMENT_LENGTH : static_cast<uint32_t>(step);
+}
 
-    return decodedStr;
+template <typename charType>
+void CodecBWT<charType>::decodeSegments(const Array<Pair<charType, uint32_t>>& P, const charType* encodedStr, const Array<uint32_t>& startRows,
+                                        const size_t first, const size_t last, const size_t segmentLength, const size_t length, charType* output)
+{
+    // the next row of every segment is prefetched, so cache misses of INTERLEAVED_SEGMENTS chases overlap
+    uint32_t rows[INTERLEAVED_SEGMENTS];
+    size_t lengths[INTERLEAVED_SEGMENTS];
+    for (size_t group = first; group < last; group += INTERLEAVED_SEGMENTS) {
+        const size_t groupSize = (last - group < INTERLEAVED_SEGMENTS) ? last - group : INTERLEAVED_SEGMENTS;
+        size_t maxLength = 0;
+        for (size_t j = 0; j < groupSize; ++j) {
+            const size_t start = (group + j) * segmentLength;
+            lengths[j] = (length - start < segmentLength) ? length - start : segmentLength;
+            maxLength = (lengths[j] > maxLength) ? lengths[j] : maxLength;
+            rows[j] = P[startRows[group + j]].second;
+            SimdUtils::Prefetch(&P[rows[j]]);
+            SimdUtils::Prefetch(encodedStr + rows[j]);
+        }
+        for (size_t i = 0; i < maxLength; ++i) {
+            for (size_t j = 0; j < groupSize; ++j) {
+                if (i >= lengths[j]) continue;
+                output[(group + j) * segmentLength + i] = encodedStr[rows[j]];
+                rows[j] = P[rows[j]].second;
+                SimdUtils::Prefetch(&P[rows[j]]);
+                SimdUtils::Prefetch(encodedStr + rows[j]);
+            }
+        }
+    }
 }
 
 // ==== PROTECTED ====
 
 template <typename charType>
-typename CodecBWT<charType>::data CodecBWT<charType>::encodeToData(const StringL<charType>& inputStr)
+typename CodecBWT<charType>::data CodecBWT<charType>::encodeToData(const StringL<charType>& inputStr, const CompressorSettings& settings)
 {
     // first character in ASII (to put at the end of string to get correct suffix array)
     const charType endChar = '\0';
 
     // build suffix array from "inputStr + endChar"
-    Array<int> suffixArray = buildSuffixArray(inputStr, endChar);
+    Array<int> suffixArray = getSuffixArray(inputStr, endChar, settings);
 
     uint32_t index;
     StringL<charType> encodedStr(inputStr.size() + 1); // txt + end char
 
+    // rows of the positions step, 2 * step, ... (all less than inputStr.size())
+    const uint32_t step = getCheckpointStep(static_cast<uint32_t>(inputStr.size()), settings.GetBWTCheckpointsCount());
+    Array<uint32_t> checkpoints((step > 0) ? (inputStr.size() - 1) / step : 0, 0);
+
     for (size_t i = 0; i < suffixArray.size(); ++i) {
         size_t ind = (suffixArray[i] == 0) ? (inputStr.size() + 1 - 1) : (suffixArray[i] - 1);
         encodedStr.push_back( ind == inputStr.size() ? endChar : inputStr[ind] );
         if (suffixArray[i] == 0) {
             index = i;
+        } else if (step > 0 && static_cast<size_t>(suffixArray[i]) < inputStr.size() && suffixArray[i] % step == 0) {
+            checkpoints[suffixArray[i] / step - 1] = static_cast<uint32_t>(i);
         }
     }
 
-    return data(index, inputStr.size() + 1, encodedStr);
+    return data(index, inputStr.size() + 1, encodedStr, step, checkpoints);
 }
 
 template <typename charType>
@@ -161,6 +228,33 @@ void CodecBWT<charType>::encodeData(std::ofstream& outputFile, const data& data,
             FileUtils::AppendValueBinary(outputFile, c);
         }
     }
+    encodeCheckpoints(outputFile, data.checkpointStep, data.checkpoints);
+}
+
+template <typename charType>
+void CodecBWT<charType>::encodeCheckpoints(std::ofstream& outputFile, const uint32_t checkpointStep, const Array<uint32_t>& checkpoints)
+{
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(checkpoints.size()));
+    if (checkpoints.size() > 0) {
+        FileUtils::AppendValueBinary(outputFile, checkpointStep);
+        for (const uint32_t& row : checkpoints) {
+            FileUtils::AppendValueBinary(outputFile, row);
+        }
+    }
+}
+
+template <typename charType>
+void CodecBWT<charType>::decodeCheckpoints(std::ifstream& inputFile, uint32_t& checkpointStep, Array<uint32_t>& checkpoints)
+{
+    const uint32_t count = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    checkpointStep = 0;
+    checkpoints.clear();
+    if (count > 0) {
+        checkpointStep = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+        for (uint32_t i = 0; i < count && inputFile; ++i) {
+            checkpoints.push_back(FileUtils::ReadValueBinary<uint32_t>(inputFile));
+        }
+    }
 }
 
 template <typename charType>
@@ -173,16 +267,47 @@ StringL<charType> CodecBWT<charType>::decodeData(const data& data)
         P.push_back(Pair(data.encodedStr[i], i));
     }
 
-    auto cmp = [](const Pair<charType, unsigned int>& a, const Pair<charType, unsigned int>& b) {
+    // the end character (row data.index of the last column) is the first in the first column even if the text has '\0' characters
+    const uint32_t endRow = data.index;
+    auto cmp = [endRow](const Pair<charType, unsigned int>& a, const Pair<charType, unsigned int>& b) {
+        if (a.second == endRow || b.second == endRow) return a.second == endRow && b.second != endRow;
         return a.first < b.first;
     };
     std::stable_sort(P.begin(), P.end(), cmp);
 
-    StringL<charType> decodedStr;
-    uint32_t index = data.index;
-    for (size_t i = 0; i < data.encodedStr.size() - 1; ++i) { // size() - 1 to avoid reading '\0' character
-        index = P[index].second;                              // which has been pushed in encoding method
-        decodedStr.push_back(data.encodedStr[index]);
+    // segment i starts at the position checkpointStep * i (the row of the position 0 is data.index)
+    const size_t length = data.encodedStr.size() - 1; // size() - 1 to avoid reading '\0' character which has been pushed in encoding method
+    Array<uint32_t> startRows(data.checkpoints.size() + 1);
+    startRows.push_back(data.index);
+    for (const uint32_t& row : data.checkpoints) {
+        startRows.push_back(row);
+    }
+    for (const uint32_t& row : startRows) {
+        if (row >= data.encodedStr.size()) {
+            throw std::runtime_error("CodecBWT: Corrupted data!");
+        }
+    }
+    if (data.checkpoints.size() > 0 && (data.checkpointStep == 0 || (length - 1) / data.checkpointStep != data.checkpoints.size())) {
+        throw std::runtime_error("CodecBWT: Corrupted data!");
+    }
+    const size_t segmentLength = (data.checkpoints.size() > 0) ? data.checkpointStep : length;
+
+    StringL<charType> decodedStr(length, 0);
+    const size_t segmentsCount = (length > 0) ? startRows.size() : 0;
+    const size_t hardwareThreads = std::thread::hardware_concurrency();
+    const size_t threadsCount = (hardwareThreads > 0 && hardwareThreads < segmentsCount) ? hardwareThreads : segmentsCount;
+
+    // every thread decodes its own segments to its own part of decodedStr
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < threadsCount; ++t) {
+        threads.emplace_back(decodeSegments, std::cref(P), data.encodedStr.c_str(), std::cref(startRows), segmentsCount * t / threadsCount,
+                             segmentsCount * (t + 1) / threadsCount, segmentLength, length, decodedStr.begin());
+    }
+    if (threadsCount > 0) {
+        decodeSegments(P, data.encodedStr.c_str(), startRows, 0, segmentsCount / threadsCount, segmentLength, length, decodedStr.begin());
+    }
+    for (auto& thread : threads) {
+        thread.join();
     }
 
     return decodedStr;
@@ -1,14 +1,16 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <map>
+#include <utility>
 
 #include "../helpers/FileUtils.h"
 #include "../helpers/CodecUTF8.h"
-#include "../helpers/HuffmanTree.h"
 #include "../helpers/TextUtils.h"
-#include "../helpers/BinaryUtils.h"
-#include "../helpers/BitArray.h"
+#include "../helpers/BitStream.h"
+#include "../helpers/HuffmanDecodeTable.h"
+#include "../helpers/AlphabetMap.h"
 #include "../helpers/StringL.h"
 #include "../helpers/Array.h"
 
@@ -27,457 +29,602 @@
  * Memory usage:
  * ...
  * 
+ * Details:
+ * - Every block (settings.GetHuffmanBlockSize() characters) is split into N interleaved bit streams (N = settings.GetHuffmanStreamsCount()):
+ *   character i of the block is written to the stream i % N. Sizes of the streams are written in the block header
+ * - Block size and number of streams are written in the header, so decoder doesn't depend on the settings of the encoder.
+ *   Length of the alphabet of every block is uint32_t (a block of wide characters can have more than 65535 distinct ones)
+ * - Decoder advances N independent bit readers in one loop, so decoding of neighbouring characters doesn't wait for each other
+ * - Lengths of codes are calculated in place (Moffat, Katajainen), codes are written and read by table-driven BitWriter / BitReader
+ *   and HuffmanDecodeTable
+ * - In-memory Encode() / Decode() keep their buffers and tables in EncoderContext / DecoderContext, so coding of many small inputs
+ *   doesn't allocate memory after the first calls. Encode() / Decode() of files use one context for all blocks of a call,
+ *   their output has the same format as in-memory Encode() if utf-8 isn't used
  */
 template <typename charType>
 class CodecHA
 {
 public:
-    static void Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    class EncoderContext;
+    class DecoderContext;
+
+    static void Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings = CompressorSettings());
     static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+    // encoded bytes are appended to output
+    static void Encode(const StringL<charType>& inputStr, Array<uint8_t>& output, EncoderContext& context, const CompressorSettings& settings = CompressorSettings());
+    // decoded characters are appended to output, returns number of bytes read from input
+    static size_t Decode(const uint8_t* input, const size_t inputSize, StringL<charType>& output, DecoderContext& context);
 private:
     CodecHA() = default;
 
-    static void sortInParallel(Array<charType>& alphabet, Array<uint32_t>& frequencies);
-    static void encodeNumbersEffectively(std::ofstream& outputFile, const Array<uint32_t>& numbers);
-    static Array<uint32_t> decodeNumbersEffectively(std::ifstream& inputFile, const uint16_t numberOfElements);
+    static const uint8_t MAX_STREAMS_COUNT = 8;
+    // multi-symbol decoding is used for blocks of one stream (several streams already hide latency of lookups),
+    // smaller blocks don't pay back building of its table
+    static const size_t MULTI_SYMBOL_MIN_SIZE = 16384;
+
+    static void buildCodes(EncoderContext& context, const charType* chars, const size_t size);
+    static void calculateCodeLengths(Array<uint32_t>& weights);
+    static void writeStreams(const charType* chars, const size_t size, const Array<uint32_t>& codeOf, const Array<uint8_t>& lengthOf,
+                             const uint8_t streamsCount, Array<uint8_t>& output, Array<uint32_t>& streamSizes);
+    // lengths of codes are written as maxBits (uint8_t) and maxBits bits of every length (they are in canonical order, the last one is the longest)
+    static void appendCodeLengths(Array<uint8_t>& output, const Array<uint32_t>& lengths);
+    // count lengths of maxBits bits from bits (of codeLengthsSize() bytes)
+    static void decodeCodeLengths(const uint8_t* bits, const size_t bitsSize, const uint8_t maxBits, const uint32_t count, Array<uint32_t>& lengths);
+    static size_t codeLengthsSize(const uint32_t count, const uint8_t maxBits) { return (static_cast<size_t>(count) * maxBits + 7) / 8; }
+    static void decodeStreams(const HuffmanDecodeTable<charType>& table, BitReader* readers, const size_t streamsCount,
+                              const size_t localSize, StringL<charType>& decodedStr);
+    template <typename T>
+    static void appendValue(Array<uint8_t>& output, const T value);
+    template <typename T>
+    static T readValue(const uint8_t* input, const size_t inputSize, size_t& position);
 protected:
     struct data_local {
-        uint16_t alphabetLength;
-        Array<typename HuffmanTree<charType>::CanonicalCode> codes;
-        BitArray encodedStr;
-        data_local(const uint16_t& _alphabetLength, const Array<typename HuffmanTree<charType>::CanonicalCode>& _codes, const BitArray& _encodedStr) : 
-            alphabetLength(_alphabetLength), codes(_codes), encodedStr(_encodedStr) {}
+        uint32_t alphabetLength;
+        Array<charType> alphabet; // in canonical order
+        Array<uint32_t> lengths; // lengths of codes of the alphabet
+        Array<uint32_t> streamSizes; // sizes of interleaved streams in bytes
+        Array<uint8_t> encodedStreams; // streams one after another
         data_local() = default;
     };
     struct data {
         uint32_t inputStrSize;
+        uint32_t blockSize; // number of characters in every block (except the last one)
+        uint8_t streamsCount;
         Array<data_local> localDataItems;
-        data(const uint32_t _inputStrSize, const Array<data_local>& _localDataItems) : 
-            inputStrSize(_inputStrSize), localDataItems(_localDataItems) {}
+        data(const uint32_t _inputStrSize, const uint32_t _blockSize, const uint8_t _streamsCount, const Array<data_local>& _localDataItems) : 
+            inputStrSize(_inputStrSize), blockSize(_blockSize), streamsCount(_streamsCount), localDataItems(_localDataItems) {}
         data() = default;
     };
 
-    static data encodeToData(const StringL<charType>& inputStr);
+    static data_local encodeBlock(EncoderContext& context, const charType* chars, const size_t size, const uint8_t streamsCount);
+    static void writeBlock(std::ofstream& outputFile, const data_local& localData, const bool useUTF8);
+    static data_local readBlock(std::ifstream& inputFile, const bool useUTF8, const uint8_t streamsCount);
+    static void decodeBlock(DecoderContext& context, const data_local& localData, const size_t localSize, StringL<charType>& decodedStr);
+
+    static data encodeToData(const StringL<charType>& inputStr, const CompressorSettings& settings = CompressorSettings());
     static void encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8);
     static StringL<charType> decodeData(const data& data);
 };
 
+/**
+ * CodecHA::EncoderContext / CodecHA::DecoderContext.
+ *
+ * Brief:
+ * - Classes keep buffers and tables of in-memory CodecHA::Encode() / CodecHA::Decode() between calls
+ *
+ * Memory usage:
+ * O(blockSize + alphabetSize) for EncoderContext, O(2^HuffmanDecodeTable::LOOKUP_BITS + alphabetSize) for DecoderContext
+ *
+ * Details:
+ * - Buffers only grow, FreeMemory() releases them
+ * - One context shouldn't be used by several threads at once
+ */
+template <typename charType>
+class CodecHA<charType>::EncoderContext
+{
+    friend class CodecHA<charType>;
+public:
+    EncoderContext() = default;
+    void FreeMemory() {
+        alphabetMap_.FreeMemory(); ranks_.free_memory(); codeOf_.free_memory(); lengthOf_.free_memory(); sorted_.free_memory();
+        weights_.free_memory(); symbols_.free_memory(); lengths_.free_memory(); codes_.free_memory(); streamSizes_.free_memory();
+    }
+private:
+    AlphabetMap<charType> alphabetMap_; // dense ranks of characters of the block
+    Array<charType> ranks_; // the block with characters replaced by ranks
+    Array<uint32_t> codeOf_; // code of every rank
+    Array<uint8_t> lengthOf_; // length of the code of every rank
+    Array<std::pair<uint32_t, charType>> sorted_; // (frequency, rank) in ascending order
+    Array<uint32_t> weights_; // frequencies of sorted_, then lengths of their codes
+    Array<charType> symbols_; // alphabet in canonical order
+    Array<uint32_t> lengths_; // lengths of codes in canonical order
+    Array<uint32_t> codes_; // canonical codes
+    Array<uint32_t> streamSizes_;
+};
+
+template <typename charType>
+class CodecHA<charType>::DecoderContext
+{
+    friend class CodecHA<charType>;
+public:
+    DecoderContext() = default;
+    void FreeMemory() { alphabet_.free_memory(); lengths_.free_memory(); table_ = HuffmanDecodeTable<charType>(); }
+private:
+    Array<charType> alphabet_;
+    Array<uint32_t> lengths_;
+    HuffmanDecodeTable<charType> table_;
+};
+
 
 // START IMPLEMENTATION
 
 // ==== PUBLIC
 
 template <typename charType>
-void CodecHA<charType>::Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+void CodecHA<charType>::Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings)
 {
-    const size_t maxSizeOfBlock = CompressorSettings::GetHuffmanBlockSize(); // to limit RAM consumption
-    StringL<charType> localString(maxSizeOfBlock); // local string to make huffman algorithm
-    size_t stringPointer = 0; // pointer to the end of localString within an inputStr
-    Array<charType> alphabet;
-    Array<uint32_t> frequencies;
+    const size_t maxSizeOfBlock = settings.GetHuffmanBlockSize(); // to limit RAM consumption
+    const uint8_t streamsCount = static_cast<uint8_t>(settings.GetHuffmanStreamsCount());
 
     FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(inputStr.size()));
-    
-    // Apply Huffman-Algorithm to all local data
-    while (stringPointer < inputStr.size()) {
-        // update local string
-        localString.clear();
-        while ((localString.size() < maxSizeOfBlock) && (stringPointer < inputStr.size())) {
-            localString.push_back(inputStr[stringPointer++]);
-        }
-
-        // update alphabet and frequencies
-        alphabet = TextUtils::GetAlphabet<charType>(localString);
-        frequencies = TextUtils::GetFrequenciesInt(localString, alphabet);
-        sortInParallel(alphabet, frequencies);
-        
-        // calculate huffman codes
-        HuffmanTree<charType> tree(alphabet, frequencies);
-        Array<typename HuffmanTree<charType>::CanonicalCode> huffmanCanonicalCodes = tree.GetCanonicalCodes(tree, alphabet.size());
-
-        // make map from huffman codes
-        std::map<charType, std::pair<uint32_t, uint32_t>> huffmanCodesMap;
-        for (const auto& canonicalCode : huffmanCanonicalCodes) {
-            huffmanCodesMap[canonicalCode.character] = {canonicalCode.code, canonicalCode.codeLength};
-        }
-
-        // encode string with huffman codes
-        BitArray encodedStr;
-        uint32_t code, length;
-        for (const charType& localChar : localString) {
-            code = huffmanCodesMap[localChar].first;
-            length = huffmanCodesMap[localChar].second;
-            for (const char& bit : BinaryUtils::GetBinaryStringFromNumber(code, length)) {
-                encodedStr.push_back(bit);
-            }
-        }
-
-        // ==== Write local data
-        // write length of alphabet
-        FileUtils::AppendValueBinary(outputFile, static_cast<uint16_t>(alphabet.size()));
-        // write alphabet and fill array of lengths of huffman codes (effectively)
-        Array<uint32_t> lengthsOfCodes(alphabet.size());
-        if (useUTF8) {
-            for (const auto& canonicalCode : huffmanCanonicalCodes) {
-                // write alphabet's character
-                CodecUTF8::EncodeCharToBinaryFile(outputFile, canonicalCode.character);
-                // add length of its huffman code
-                lengthsOfCodes.push_back(canonicalCode.codeLength);
-            }
-        } else {
-            for (const auto& canonicalCode : huffmanCanonicalCodes) {
-                // write alphabet's character
-                FileUtils::AppendValueBinary(outputFile, canonicalCode.character);
-                // add length of its huffman code
-                lengthsOfCodes.push_back(canonicalCode.codeLength);
-            }
-        }
-        // write lengths effectively
-        encodeNumbersEffectively(outputFile, lengthsOfCodes);
-        // write encoded str
-        BitArray::to_file(outputFile, encodedStr);
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(maxSizeOfBlock));
+    FileUtils::AppendValueBinary(outputFile, streamsCount);
+
+    // every block is written as soon as it is encoded
+    EncoderContext context;
+    for (size_t blockStart = 0; blockStart < inputStr.size(); blockStart += maxSizeOfBlock) {
+        const size_t localSize = std::min(maxSizeOfBlock, inputStr.size() - blockStart);
+        writeBlock(outputFile, encodeBlock(context, inputStr.c_str() + blockStart, localSize, streamsCount), useUTF8);
     }
 }
 
 template <typename charType>
 StringL<charType> CodecHA<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
 {
-    const size_t maxSizeOfBlock = CompressorSettings::GetHuffmanBlockSize();
-
     uint32_t inputStrSize = FileUtils::ReadValueBinary<uint32_t>(inputFile);
-    uint32_t localDataCount = inputStrSize / maxSizeOfBlock + 1;
-    uint32_t lastBlockSize = inputStrSize % maxSizeOfBlock;
-
-    StringL<charType> decodedStr(localDataCount * maxSizeOfBlock);
-    StringL<charType> decodedStrLocal(maxSizeOfBlock);
-
-    while (localDataCount-- > 0) {
-        uint16_t alphabetLength = FileUtils::ReadValueBinary<uint16_t>(inputFile);
-        Array<charType> alphabet(alphabetLength);
-        if (useUTF8) {
-            for (uint16_t i = 0; i < alphabetLength; ++i)
-                alphabet.push_back(CodecUTF8::DecodeCharFromBinaryFile<charType>(inputFile));
-        } else {
-            for (uint16_t i = 0; i < alphabetLength; ++i)
-                alphabet.push_back(FileUtils::ReadValueBinary<charType>(inputFile));
+    uint32_t maxSizeOfBlock = FileUtils::ReadValueBinary<uint32_t>(inputFile); // block size of the encoder
+    uint8_t streamsCount = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+    if (maxSizeOfBlock == 0 || streamsCount == 0 || streamsCount > MAX_STREAMS_COUNT) {
+        throw std::runtime_error("CodecHA::Decode(): Corrupted data!");
+    }
+
+    DecoderContext context;
+    StringL<charType> decodedStr(inputStrSize);
+    while (decodedStr.size() < inputStrSize) {
+        size_t localSize = std::min<size_t>(maxSizeOfBlock, inputStrSize - decodedStr.size());
+        decodeBlock(context, readBlock(inputFile, useUTF8, streamsCount), localSize, decodedStr);
+    }
+
+    return decodedStr;
+}
+
+template <typename charType>
+void CodecHA<charType>::Encode(const StringL<charType>& inputStr, Array<uint8_t>& output, EncoderContext& context, const CompressorSettings& settings)
+{
+    const size_t maxSizeOfBlock = settings.GetHuffmanBlockSize();
+    const uint8_t streamsCount = static_cast<uint8_t>(settings.GetHuffmanStreamsCount());
+
+    appendValue(output, static_cast<uint32_t>(inputStr.size()));
+    appendValue(output, static_cast<uint32_t>(maxSizeOfBlock));
+    appendValue(output, streamsCount);
+
+    for (size_t blockStart = 0; blockStart < inputStr.size(); blockStart += maxSizeOfBlock) {
+        const charType* chars = inputStr.begin() + blockStart;
+        const size_t localSize = std::min(maxSizeOfBlock, inputStr.size() - blockStart);
+        buildCodes(context, chars, localSize);
+
+        // write alphabet and lengths of codes (the same as writeBlock())
+        appendValue(output, static_cast<uint32_t>(context.symbols_.size()));
+        for (const charType& c : context.symbols_) {
+            appendValue(output, c);
         }
+        appendCodeLengths(output, context.lengths_);
 
-        Array<uint32_t> lengthsOfCodes = decodeNumbersEffectively(inputFile, alphabetLength);
-
-        // get huffman codes map
-        std::map<std::pair<uint32_t, uint32_t>, charType> huffmanCodesMap;
-        std::pair<uint32_t, uint32_t> binRepresentation;
-        std::pair<uint32_t, uint32_t> temp;
-        bool isCodeUsed;
-        for (size_t i = 0; i < lengthsOfCodes.size(); ++i) {
-            uint32_t lengthOfCode = lengthsOfCodes[i];
-            // find the code of length = lengthOfCode
-            // which has the smallest number (considering the code as the binary representation)
-            // which was not used before and which satisfy the huffman rule
-            for (uint32_t j = 0; j < 1000000000; ++j) {
-                // find the code of length = lengthOfCode
-                // which was not used before
-                binRepresentation = { j, lengthOfCode };
-                if (huffmanCodesMap.find(binRepresentation) == huffmanCodesMap.end()) {
-                    // check if the code satisfies the huffman rule
-                    // (if there are no any codes from which the current code begins)
-                    isCodeUsed = false;
-                    temp = binRepresentation;
-                    for (uint32_t _ = 0; _ < lengthOfCode; ++_) {
-                        temp.first >>= 1;
-                        --temp.second;
-                        if (huffmanCodesMap.find(temp) != huffmanCodesMap.end()) {
-                            isCodeUsed = true;
-                            break;
-                        }
-                    }
-                    if (!isCodeUsed) {
-                        huffmanCodesMap[binRepresentation] = alphabet[i];
-                        break;
-                    }
-                }
-            }
-        }       
+        // sizes of streams are known after encoding, so their place is reserved
+        const size_t sizesPosition = output.size();
+        for (uint8_t i = 0; i < streamsCount; ++i) {
+            appendValue(output, static_cast<uint32_t>(0));
+        }
+        writeStreams(context.ranks_.c_arr(), localSize, context.codeOf_, context.lengthOf_, streamsCount, output, context.streamSizes_);
+        for (uint8_t i = 0; i < streamsCount; ++i) {
+            std::memcpy(output.begin() + sizesPosition + i * sizeof(uint32_t), &context.streamSizes_[i], sizeof(uint32_t));
+        }
+    }
+}
 
-        // read and decode encoded string
-        size_t localSize = (localDataCount > 0) ? maxSizeOfBlock : lastBlockSize;
-        BitArray bitBuffer;
-        std::pair<uint32_t, uint32_t> currentCode = { 0, 0 };
-        decodedStrLocal.clear();
+template <typename charType>
+size_t CodecHA<charType>::Decode(const uint8_t* input, const size_t inputSize, StringL<charType>& output, DecoderContext& context)
+{
+    size_t position = 0;
+    const uint32_t inputStrSize = readValue<uint32_t>(input, inputSize, position);
+    const uint32_t maxSizeOfBlock = readValue<uint32_t>(input, inputSize, position);
+    const uint8_t streamsCount = readValue<uint8_t>(input, inputSize, position);
+    if (maxSizeOfBlock == 0 || streamsCount == 0 || streamsCount > MAX_STREAMS_COUNT) {
+        throw std::runtime_error("CodecHA::Decode(): Corrupted data!");
+    }
 
-        size_t i = 0;
-        bitBuffer = BitArray::from_file(inputFile, 8);
-        while (decodedStrLocal.size() < localSize)
-        {
-            if (i == 8) {
-                bitBuffer = BitArray::from_file(inputFile, 8);
-                i = 0;
-            }
-            
-            // update current code
-            if (bitBuffer.get_bit(i++) == '0') {
-                currentCode.first <<= 1;
-            } else {
-                currentCode.first <<= 1;
-                ++currentCode.first;
-            }
-            ++currentCode.second;
+    size_t decodedCount = 0;
+    while (decodedCount < inputStrSize) {
+        const size_t localSize = std::min<size_t>(maxSizeOfBlock, inputStrSize - decodedCount);
 
-            // add new character to decoded string
-            if (huffmanCodesMap.find(currentCode) != huffmanCodesMap.end()) {
-                decodedStrLocal.push_back(huffmanCodesMap[currentCode]);
-                currentCode.first = 0;
-                currentCode.second = 0;
+        // read alphabet and lengths of codes, build decoding table
+        const uint32_t alphabetLength = readValue<uint32_t>(input, inputSize, position);
+        context.alphabet_.clear();
+        for (uint32_t i = 0; i < alphabetLength; ++i) {
+            context.alphabet_.push_back(readValue<charType>(input, inputSize, position));
+        }
+        const uint8_t maxBits = readValue<uint8_t>(input, inputSize, position);
+        const size_t lengthsSize = codeLengthsSize(alphabetLength, maxBits);
+        if (alphabetLength == 0 || lengthsSize > inputSize - position) {
+            throw std::runtime_error("CodecHA::Decode(): Corrupted data!");
+        }
+        decodeCodeLengths(input + position, lengthsSize, maxBits, alphabetLength, context.lengths_);
+        position += lengthsSize;
+        context.table_.Build(context.alphabet_, context.lengths_, streamsCount == 1 && localSize >= MULTI_SYMBOL_MIN_SIZE);
+
+        // set up independent readers of the streams
+        BitReader readers[MAX_STREAMS_COUNT];
+        size_t streamPosition = position + streamsCount * sizeof(uint32_t);
+        for (uint8_t i = 0; i < streamsCount; ++i) {
+            const uint32_t streamSize = readValue<uint32_t>(input, inputSize, position);
+            if (streamSize > inputSize - std::min(streamPosition, inputSize)) {
+                throw std::runtime_error("CodecHA::Decode(): Corrupted data!");
             }
+            readers[i] = BitReader(input + streamPosition, streamSize);
+            streamPosition += streamSize;
         }
+        position = streamPosition;
 
-        decodedStr.push_back(decodedStrLocal);
+        decodeStreams(context.table_, readers, streamsCount, localSize, output);
+        decodedCount += localSize;
     }
 
-    return decodedStr;
+    return position;
 }
 
 // ==== PRIVATE
 
 template <typename charType>
-void CodecHA<charType>::sortInParallel(Array<charType>& alphabet, Array<uint32_t>& frequencies)
+void CodecHA<charType>::buildCodes(EncoderContext& context, const charType* chars, const size_t size)
 {
-    // function takes alphabet and frequencies and sorts them in ascending order of frequencies
+    // replace characters by dense ranks, tables are indexed by rank
+    context.alphabetMap_.Build(chars, size);
+    context.ranks_.clear();
+    for (size_t i = 0; i < size; ++i) {
+        context.ranks_.push_back(static_cast<charType>(context.alphabetMap_.Rank(chars[i])));
+    }
+
+    // get frequencies (ranks keep order of characters, so codes are the same as for characters)
+    const Array<uint32_t>& counts = context.alphabetMap_.GetCounts();
+    context.sorted_.clear();
+    context.codeOf_.clear();
+    context.lengthOf_.clear();
+    for (size_t rank = 0; rank < counts.size(); ++rank) {
+        context.sorted_.push_back({ counts[rank], static_cast<charType>(rank) });
+        context.codeOf_.push_back(0);
+        context.lengthOf_.push_back(0);
+    }
+    std::sort(context.sorted_.begin(), context.sorted_.end());
 
-    Array<std::pair<charType, uint32_t>> charFrequencyVector(alphabet.size());
-    for (size_t i = 0; i < alphabet.size(); ++i) {
-        charFrequencyVector.push_back({ alphabet[i], frequencies[i] });
+    // calculate lengths of codes, they don't increase with frequency
+    context.weights_.clear();
+    for (const auto& pair : context.sorted_) {
+        context.weights_.push_back(pair.first);
+    }
+    calculateCodeLengths(context.weights_);
+
+    // canonical order: lengths of codes don't decrease
+    context.symbols_.clear();
+    context.lengths_.clear();
+    for (size_t i = context.sorted_.size(); i-- > 0;) {
+        if (context.weights_[i] > HuffmanDecodeTable<charType>::MAX_CODE_LENGTH) {
+            throw std::runtime_error("CodecHA: Huffman code is too long, decrease Huffman block size!");
+        }
+        context.symbols_.push_back(context.sorted_[i].second);
+        context.lengths_.push_back(context.weights_[i]);
     }
-    std::sort(charFrequencyVector.begin(), charFrequencyVector.end(), 
-        [](const std::pair<charType, uint32_t>& a, const std::pair<charType, uint32_t>& b)
-        { return a.second < b.second; });
-    
-    alphabet.clear(); frequencies.clear();
-    for (const auto& pair : charFrequencyVector) {
-        alphabet.push_back(pair.first);
-        frequencies.push_back(pair.second);
+    HuffmanDecodeTable<charType>::GetCanonicalCodes(context.lengths_, context.codes_);
+    for (size_t i = 0; i < context.symbols_.size(); ++i) {
+        context.codeOf_[context.symbols_[i]] = context.codes_[i];
+        context.lengthOf_[context.symbols_[i]] = static_cast<uint8_t>(context.lengths_[i]);
+        context.symbols_[i] = context.alphabetMap_.Symbol(context.symbols_[i]);
     }
 }
 
 template <typename charType>
-void CodecHA<charType>::encodeNumbersEffectively(std::ofstream& outputFile, const Array<uint32_t>& numbers)
+void CodecHA<charType>::calculateCodeLengths(Array<uint32_t>& weights)
 {
-    if (numbers.size() < 1) return;
+    // in-place calculation of huffman code lengths (Moffat, Katajainen) without building a tree:
+    // weights are given in ascending order and replaced by lengths of codes
+    const int64_t n = static_cast<int64_t>(weights.size());
+    if (n == 0) return;
+    if (n == 1) { weights[0] = 1; return; } // the only character still needs one bit
+    uint32_t* a = weights.begin();
+
+    // first pass (left to right): combine nodes, internal nodes keep indices of their parents
+    a[0] += a[1];
+    int64_t root = 0, leaf = 2;
+    for (int64_t next = 1; next < n - 1; ++next) {
+        if (leaf >= n || a[root] < a[leaf]) {
+            a[next] = a[root];
+            a[root++] = static_cast<uint32_t>(next);
+        } else {
+            a[next] = a[leaf++];
+        }
+        if (leaf >= n || (root < next && a[root] < a[leaf])) {
+            a[next] += a[root];
+            a[root++] = static_cast<uint32_t>(next);
+        } else {
+            a[next] += a[leaf++];
+        }
+    }
 
-    // get maxValue from numbers
-    uint32_t maxValue = 0;
-    for (uint32_t number : numbers) {
-        maxValue = std::max(maxValue, number);
+    // second pass (right to left): depths of internal nodes
+    a[n - 2] = 0;
+    for (int64_t next = n - 3; next >= 0; --next) {
+        a[next] = a[a[next]] + 1;
     }
 
-    // calculate maxBits
-    uint32_t maxBits = std::floor(std::log2(maxValue)) + 1; // get number of bits for binary representation
+    // third pass (right to left): depths of leaves
+    int64_t available = 1, used = 0, depth = 0, next = n - 1;
+    root = n - 2;
+    while (available > 0) {
+        while (root >= 0 && a[root] == depth) { ++used; --root; }
+        while (available > used) { a[next--] = static_cast<uint32_t>(depth); --available; }
+        available = 2 * used;
+        ++depth;
+        used = 0;
+    }
+}
 
-    // get encoded bits
-    BitArray encoded(numbers.size() * maxBits);
-    for (const uint32_t& number : numbers) {
-        for (const char& bit : BinaryUtils::GetBinaryStringFromNumber(number, maxBits)) {
-            encoded.push_back(bit);
+template <typename charType>
+void CodecHA<charType>::writeStreams(const charType* chars, const size_t size, const Array<uint32_t>& codeOf, const Array<uint8_t>& lengthOf,
+                                     const uint8_t streamsCount, Array<uint8_t>& output, Array<uint32_t>& streamSizes)
+{
+    // character i goes to the stream i % streamsCount
+    streamSizes.clear();
+    for (size_t stream = 0; stream < streamsCount; ++stream) {
+        size_t streamStart = output.size();
+        BitWriter writer(output);
+        for (size_t i = stream; i < size; i += streamsCount) {
+            writer.Write(codeOf[chars[i]], lengthOf[chars[i]]);
         }
+        writer.Flush();
+        streamSizes.push_back(static_cast<uint32_t>(output.size() - streamStart));
     }
-
-    // write maxBits
-    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(maxBits));
-    // write encoded bits
-    BitArray::to_file(outputFile, encoded);
 }
 
 template <typename charType>
-Array<uint32_t> CodecHA<charType>::decodeNumbersEffectively(std::ifstream& inputFile, const uint16_t numberOfElements)
+void CodecHA<charType>::appendCodeLengths(Array<uint8_t>& output, const Array<uint32_t>& lengths)
 {
-    if (numberOfElements < 1) return Array<uint32_t>();
+    uint32_t maxBits = 0;
+    while ((lengths[lengths.size() - 1] >> maxBits) != 0) ++maxBits;
+    appendValue(output, static_cast<uint8_t>(maxBits));
+    BitWriter writer(output);
+    for (const uint32_t& length : lengths) {
+        writer.Write(length, maxBits);
+    }
+    writer.Flush();
+}
 
-    uint8_t maxBits = FileUtils::ReadValueBinary<uint8_t>(inputFile);
-    uint32_t encodedSize = (numberOfElements * maxBits);
+template <typename charType>
+void CodecHA<charType>::decodeCodeLengths(const uint8_t* bits, const size_t bitsSize, const uint8_t maxBits, const uint32_t count, Array<uint32_t>& lengths)
+{
+    if (maxBits == 0 || maxBits > HuffmanDecodeTable<charType>::MAX_CODE_LENGTH) {
+        throw std::runtime_error("CodecHA: Corrupted data!");
+    }
+    BitReader reader(bits, bitsSize);
+    lengths.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        lengths.push_back(reader.Peek(maxBits));
+        reader.Skip(maxBits);
+    }
+}
 
-    BitArray encoded = BitArray::from_file(inputFile, 
-        (encodedSize % 8 == 0) ? (encodedSize) : ((encodedSize / 8 + 1) * 8)
-    );
+template <typename charType>
+void CodecHA<charType>::decodeStreams(const HuffmanDecodeTable<charType>& table, BitReader* readers, const size_t streamsCount,
+                                      const size_t localSize, StringL<charType>& decodedStr)
+{
+    if (streamsCount == 1 && table.HasMultiSymbolTable()) {
+        // one stream: several symbols by one lookup while enough symbols are left
+        // (all MAX_SYMBOLS_PER_LOOKUP symbols of an entry are written, extra ones are overwritten by the next lookup)
+        const size_t start = decodedStr.size();
+        for (size_t i = 0; i < localSize; ++i) {
+            decodedStr.push_back(0);
+        }
+        charType* output = decodedStr.begin() + start;
+        size_t i = 0;
+        while (i + HuffmanDecodeTable<charType>::MAX_SYMBOLS_PER_LOOKUP <= localSize) {
+            i += table.DecodeSymbols(readers[0], output + i);
+        }
+        for (; i < localSize; ++i) {
+            output[i] = table.DecodeSymbol(readers[0]);
+        }
+        return;
+    }
 
-    Array<uint32_t> numbers;
-    uint32_t value;
+    // decode streams in round-robin order
     size_t i = 0;
-    while (numbers.size() < numberOfElements) {
-        value = 0;
-        for (uint8_t _ = 0; _ < maxBits; ++_) {
-            if (encoded.get_bit(i++) == '0') {
-                value <<= 1;
-            } else {
-                value <<= 1; value |= 1;
-            }
+    for (; i + streamsCount <= localSize; i += streamsCount) {
+        for (size_t stream = 0; stream < streamsCount; ++stream) {
+            decodedStr.push_back(table.DecodeSymbol(readers[stream]));
         }
-        numbers.push_back(value);
     }
+    for (size_t stream = 0; i < localSize; ++i, ++stream) {
+        decodedStr.push_back(table.DecodeSymbol(readers[stream]));
+    }
+}
+
+template <typename charType>
+template <typename T>
+void CodecHA<charType>::appendValue(Array<uint8_t>& output, const T value)
+{
+    // the same bytes as FileUtils::AppendValueBinary()
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        output.push_back(bytes[i]);
+    }
+}
 
-    return numbers;
+template <typename charType>
+template <typename T>
+T CodecHA<charType>::readValue(const uint8_t* input, const size_t inputSize, size_t& position)
+{
+    if (inputSize - std::min(position, inputSize) < sizeof(T)) {
+        throw std::runtime_error("CodecHA::Decode(): Corrupted data!");
+    }
+    T value;
+    std::memcpy(&value, input + position, sizeof(T));
+    position += sizeof(T);
+    return value;
 }
 
 // ==== PROTECTED
 
 template <typename charType>
-typename CodecHA<charType>::data CodecHA<charType>::encodeToData(const StringL<charType>& inputStr)
+typename CodecHA<charType>::data_local CodecHA<charType>::encodeBlock(EncoderContext& context, const charType* chars, const size_t size, const uint8_t streamsCount)
 {
-    Array<data_local> localDataItems;
-
-    const size_t maxSizeOfBlock = CompressorSettings::GetHuffmanBlockSize(); // to limit RAM consumption
-    StringL<charType> localString(maxSizeOfBlock); // local string to make huffman algorithm
-    size_t stringPointer = 0; // pointer to the end of localString within an inputStr
-    Array<charType> alphabet;
-    Array<uint32_t> frequencies; // TODO: change to uint16_t or uint8_t for the best memory usage
-                                 // or just use static_cast in encoding function
+    buildCodes(context, chars, size);
+
+    data_local localData;
+    localData.alphabetLength = static_cast<uint32_t>(context.symbols_.size());
+    localData.alphabet = context.symbols_;
+    localData.lengths = context.lengths_;
+    localData.encodedStreams = Array<uint8_t>(size / 2 + 16);
+    writeStreams(context.ranks_.c_arr(), size, context.codeOf_, context.lengthOf_, streamsCount, localData.encodedStreams, localData.streamSizes);
+    return localData;
+}
 
-    // get all the data_local
-    while (stringPointer < inputStr.size()) {
-        // update local string
-        localString.clear();
-        while ((localString.size() < maxSizeOfBlock) && (stringPointer < inputStr.size())) {
-            localString.push_back(inputStr[stringPointer++]);
+template <typename charType>
+void CodecHA<charType>::writeBlock(std::ofstream& outputFile, const data_local& localData, const bool useUTF8)
+{
+    // write alphabet
+    FileUtils::AppendValueBinary(outputFile, localData.alphabetLength);
+    if (useUTF8) {
+        for (const charType& c : localData.alphabet) {
+            CodecUTF8::EncodeCharToBinaryFile(outputFile, c);
         }
-
-        // update alphabet and frequencies
-        alphabet = TextUtils::GetAlphabet(localString);
-        frequencies = TextUtils::GetFrequenciesInt(localString, alphabet);
-        sortInParallel(alphabet, frequencies);
-        
-        // calculate huffman codes
-        HuffmanTree<charType> tree(alphabet, frequencies);
-        Array<typename HuffmanTree<charType>::CanonicalCode> huffmanCanonicalCodes = tree.GetCanonicalCodes(tree, alphabet.size());
-
-        // make huffman codes map
-        std::map<charType, std::pair<uint32_t, uint32_t>> huffmanCodesMap;
-        for (const auto& canonicalCode : huffmanCanonicalCodes) {
-            huffmanCodesMap[canonicalCode.character] = {canonicalCode.code, canonicalCode.codeLength};
+    } else {
+        for (const charType& c : localData.alphabet) {
+            FileUtils::AppendValueBinary(outputFile, c);
         }
+    }
+    // write lengths of codes (the same as in-memory Encode())
+    Array<uint8_t> lengthsBytes(codeLengthsSize(localData.alphabetLength, 32) + 1);
+    appendCodeLengths(lengthsBytes, localData.lengths);
+    outputFile.write(reinterpret_cast<const char*>(lengthsBytes.c_arr()), lengthsBytes.size());
+    // write sizes of streams and the streams
+    for (const uint32_t& streamSize : localData.streamSizes) {
+        FileUtils::AppendValueBinary(outputFile, streamSize);
+    }
+    outputFile.write(reinterpret_cast<const char*>(localData.encodedStreams.c_arr()), localData.encodedStreams.size());
+}
 
-        // encode string with huffman codes
-        BitArray encodedStr;
-        uint32_t code, length;
-        for (const charType& localChar : localString) {
-            code = huffmanCodesMap[localChar].first;
-            length = huffmanCodesMap[localChar].second;
-            for (const char& bit : BinaryUtils::GetBinaryStringFromNumber(code, length)) {
-                encodedStr.push_back(bit);
-            }
-        }
+template <typename charType>
+typename CodecHA<charType>::data_local CodecHA<charType>::readBlock(std::ifstream& inputFile, const bool useUTF8, const uint8_t streamsCount)
+{
+    data_local localData;
+    localData.alphabetLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    if (localData.alphabetLength == 0 || !inputFile) {
+        throw std::runtime_error("CodecHA: Corrupted data!");
+    }
+    localData.alphabet = Array<charType>(localData.alphabetLength);
+    if (useUTF8) {
+        for (uint32_t i = 0; i < localData.alphabetLength; ++i)
+            localData.alphabet.push_back(CodecUTF8::DecodeCharFromBinaryFile<charType>(inputFile));
+    } else {
+        for (uint32_t i = 0; i < localData.alphabetLength; ++i)
+            localData.alphabet.push_back(FileUtils::ReadValueBinary<charType>(inputFile));
+    }
 
-        localDataItems.push_back(data_local(alphabet.size(), huffmanCanonicalCodes, encodedStr));
+    const uint8_t maxBits = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+    Array<uint8_t> lengthsBytes(codeLengthsSize(localData.alphabetLength, maxBits), 0);
+    inputFile.read(reinterpret_cast<char*>(lengthsBytes.begin()), lengthsBytes.size());
+    if (!inputFile) {
+        throw std::runtime_error("CodecHA: Corrupted data!");
+    }
+    decodeCodeLengths(lengthsBytes.c_arr(), lengthsBytes.size(), maxBits, localData.alphabetLength, localData.lengths);
+
+    localData.streamSizes = Array<uint32_t>(streamsCount);
+    size_t totalSize = 0;
+    for (uint8_t i = 0; i < streamsCount; ++i) {
+        localData.streamSizes.push_back(FileUtils::ReadValueBinary<uint32_t>(inputFile));
+        totalSize += localData.streamSizes[i];
+    }
+    if (inputFile.eof()) {
+        throw std::runtime_error("CodecHA: Corrupted data!");
     }
-    
-    return data(inputStr.size(), localDataItems);
+    localData.encodedStreams = Array<uint8_t>(totalSize, 0);
+    inputFile.read(reinterpret_cast<char*>(localData.encodedStreams.begin()), totalSize);
+
+    return localData;
 }
 
 template <typename charType>
-void CodecHA<charType>::encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8)
+void CodecHA<charType>::decodeBlock(DecoderContext& context, const data_local& localData, const size_t localSize, StringL<charType>& decodedStr)
 {
-    FileUtils::AppendValueBinary(outputFile, data.inputStrSize);
+    if (localData.alphabetLength == 0 || localData.alphabet.size() != localData.alphabetLength || localData.lengths.size() != localData.alphabetLength ||
+        localData.streamSizes.size() == 0 || localData.streamSizes.size() > MAX_STREAMS_COUNT) {
+        throw std::runtime_error("CodecHA: Corrupted data!");
+    }
 
-    for (const auto localData : data.localDataItems)
-    {
-        // write length of alphabet
-        FileUtils::AppendValueBinary(outputFile, localData.alphabetLength);
-        // write alphabet and fill array of lengths of huffman codes (effectively)
-        Array<uint32_t> lengthsOfCodes(localData.alphabetLength);
-        if (useUTF8) {
-            for (const auto& canonicalCode : localData.codes) {
-                // write alphabet's character
-                CodecUTF8::EncodeCharToBinaryFile(outputFile, canonicalCode.character);
-                // add length of its huffman code
-                lengthsOfCodes.push_back(canonicalCode.codeLength);
-            }
-        } else {
-            for (const auto& canonicalCode : localData.codes) {
-                // write alphabet's character
-                FileUtils::AppendValueBinary(outputFile, canonicalCode.character);
-                // add length of its huffman code
-                lengthsOfCodes.push_back(canonicalCode.codeLength);
-            }
+    // build decoding table
+    context.table_.Build(localData.alphabet, localData.lengths, localData.streamSizes.size() == 1 && localSize >= MULTI_SYMBOL_MIN_SIZE);
+
+    // set up independent readers of the streams
+    const size_t streamsCount = localData.streamSizes.size();
+    BitReader readers[MAX_STREAMS_COUNT];
+    size_t offset = 0;
+    for (size_t i = 0; i < streamsCount; ++i) {
+        if (offset + localData.streamSizes[i] > localData.encodedStreams.size()) {
+            throw std::runtime_error("CodecHA: Corrupted data!");
         }
-        // write lengths effectively
-        encodeNumbersEffectively(outputFile, lengthsOfCodes);
-        // write encoded str
-        BitArray::to_file(outputFile, localData.encodedStr);
+        readers[i] = BitReader(localData.encodedStreams.c_arr() + offset, localData.streamSizes[i]);
+        offset += localData.streamSizes[i];
     }
+
+    decodeStreams(context.table_, readers, streamsCount, localSize, decodedStr);
 }
 
 template <typename charType>
-StringL<charType> CodecHA<charType>::decodeData(const data& data)
+typename CodecHA<charType>::data CodecHA<charType>::encodeToData(const StringL<charType>& inputStr, const CompressorSettings& settings)
 {
-    const size_t maxSizeOfBlock = CompressorSettings::GetHuffmanBlockSize();
+    Array<data_local> localDataItems;
 
-    uint32_t localDataCount = data.inputStrSize / maxSizeOfBlock + 1;
-    uint32_t lastBlockSize = data.inputStrSize % maxSizeOfBlock;
-    StringL<charType> decodedStr(localDataCount * maxSizeOfBlock);
-    StringL<charType> decodedStrLocal(maxSizeOfBlock);
+    const size_t maxSizeOfBlock = settings.GetHuffmanBlockSize(); // to limit RAM consumption
+    const uint8_t streamsCount = static_cast<uint8_t>(settings.GetHuffmanStreamsCount());
 
-    for (const auto& localData : data.localDataItems) {
-        --localDataCount;
-
-        // get huffman codes map
-        std::map<std::pair<uint32_t, uint32_t>, charType> huffmanCodesMap;
-        std::pair<uint32_t, uint32_t> binRepresentation;
-        std::pair<uint32_t, uint32_t> temp;
-        bool isCodeUsed;
-        for (size_t i = 0; i < localData.alphabetLength; ++i) {
-            uint32_t lengthOfCode = localData.codes[i].codeLength;
-            // find the code of length = lengthOfCode
-            // which has the smallest number (considering the code as the binary representation)
-            // which was not used before and which satisfy the huffman rule
-            for (uint32_t j = 0; j < 1000000000; ++j) {
-                // find the code of length = lengthOfCode
-                // which was not used before
-                binRepresentation = { j, lengthOfCode };
-                if (huffmanCodesMap.find(binRepresentation) == huffmanCodesMap.end()) {
-                    // check if the code satisfies the huffman rule
-                    // (if there are no any codes from which the current code begins)
-                    isCodeUsed = false;
-                    temp = binRepresentation;
-                    for (uint32_t _ = 0; _ < lengthOfCode; ++_) {
-                        temp.first >>= 1;
-                        --temp.second;
-                        if (huffmanCodesMap.find(temp) != huffmanCodesMap.end()) {
-                            isCodeUsed = true;
-                            break;
-                        }
-                    }
-                    if (!isCodeUsed) {
-                        huffmanCodesMap[binRepresentation] = localData.codes[i].character;
-                        break;
-                    }
-                }
-            }
-        }   
+    // get all the data_local
+    EncoderContext context;
+    for (size_t blockStart = 0; blockStart < inputStr.size(); blockStart += maxSizeOfBlock) {
+        const size_t localSize = std::min(maxSizeOfBlock, inputStr.size() - blockStart);
+        localDataItems.push_back(encodeBlock(context, inputStr.c_str() + blockStart, localSize, streamsCount));
+    }
 
-        // read and decode encoded string
-        size_t localSize = (localDataCount > 0) ? maxSizeOfBlock : lastBlockSize;
-        std::pair<uint32_t, uint32_t> currentCode = { 0, 0 };
-        decodedStrLocal.clear();
+    return data(inputStr.size(), static_cast<uint32_t>(maxSizeOfBlock), streamsCount, localDataItems);
+}
 
-        size_t i = 0;
-        while (decodedStrLocal.size() < localSize)
-        {          
-            // update current code  
-            if (localData.encodedStr.get_bit(i++) == '0') {
-                currentCode.first <<= 1;
-            } else {
-                currentCode.first <<= 1;
-                ++currentCode.first;
-            }
-            ++currentCode.second;
+template <typename charType>
+void CodecHA<charType>::encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8)
+{
+    FileUtils::AppendValueBinary(outputFile, data.inputStrSize);
+    FileUtils::AppendValueBinary(outputFile, data.blockSize);
+    FileUtils::AppendValueBinary(outputFile, data.streamsCount);
 
-            // add new character to decoded string
-            if (huffmanCodesMap.find(currentCode) != huffmanCodesMap.end()) {
-                decodedStrLocal.push_back(huffmanCodesMap[currentCode]);
-                currentCode.first = 0;
-                currentCode.second = 0;
-            }
-        }
+    for (const auto& localData : data.localDataItems) {
+        writeBlock(outputFile, localData, useUTF8);
+    }
+}
 
-        decodedStr.push_back(decodedStrLocal);
+template <typename charType>
+StringL<charType> CodecHA<charType>::decodeData(const data& data)
+{
+    DecoderContext context;
+    StringL<charType> decodedStr(data.inputStrSize);
+    for (const auto& localData : data.localDataItems) {
+        size_t localSize = std::min<size_t>(data.blockSize, data.inputStrSize - decodedStr.size());
+        decodeBlock(context, localData, localSize, decodedStr);
     }
 
     return decodedStr;
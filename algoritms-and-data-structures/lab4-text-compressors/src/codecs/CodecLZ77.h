@@ -4,6 +4,8 @@
 
 #include "../helpers/FileUtils.h"
 #include "../helpers/CodecUTF8.h"
+#include "../helpers/SimdUtils.h"
+#include "../helpers/SuffixArray.h"
 #include "../helpers/StringL.h"
 #include "../helpers/Array.h"
 
@@ -23,24 +25,58 @@
  * Memory usage:
  * ...
  * 
+ * Details:
+ * - encodeDeltaToData() / decodeDeltaData() use a reference (for example the previous version of the file) as a preset dictionary:
+ *   besides matches in the search buffer a token can copy any part of the reference (offset 0, length REFERENCE_MATCH,
+ *   then uint32_t position and length in the reference, stored as a long match), so unchanged parts of a new version cost one token.
+ *   Matches are found by hash chains (of MIN_REFERENCE_MATCH characters in the reference, of MIN_WINDOW_MATCH characters in the search buffer),
+ *   the continuation of the previous reference match is checked first. Codec_LZ77_HA::EncodeDelta() writes the tokens
+ * - Max mode (settings.GetLZ77MaxMode()): matches aren't searched in the window, the longest previous factor of every position
+ *   is taken from the suffix array and LCP array of the block (buildLongestPreviousFactors(), linear time), at any distance and of any length.
+ *   Matches which don't fit into a token (offset > 65535 or length > 255) are written as long matches: offset 0, length LONG_MATCH,
+ *   then uint32_t offset and length (only if they are not shorter than MIN_LONG_MATCH, otherwise the longest match in the window is taken
+ *   from the nearest suffixes in suffix array order).
+ *   Decoders accept long matches in any stream, so the format of other modes isn't changed
  */
 template <typename charType>
 class CodecLZ77
 {
 public:
-    static void Encode(const StringL<charType>& text, std::ofstream& outputFile, const bool useUTF8);
+    static void Encode(const StringL<charType>& text, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings = CompressorSettings());
     static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
 private:
     CodecLZ77() = default;
     static int find(const StringL<charType>& target, const StringL<charType>& original, const uint32_t startIndex, const uint32_t endIndex);
 
     const static uint32_t lookaheadBufferSize = 128;
+
+    // delta mode
+    static const uint8_t REFERENCE_MATCH = 255; // length of a token with offset 0 which copies the reference
+    static const uint32_t MIN_REFERENCE_MATCH = 16;
+    static const uint32_t MIN_WINDOW_MATCH = 4;
+    static const uint32_t MAX_WINDOW_MATCH = 255;
+    static const uint32_t HASH_BITS = 16;
+    static const uint32_t MAX_CHAIN_LENGTH = 32;
+    static const uint32_t NO_POSITION = UINT32_MAX;
+
+    static inline uint32_t hashChars(const charType* chars, const uint32_t count);
+    // number of equal leading characters (not more than maxLength)
+    static inline size_t matchLength(const charType* a, const charType* b, const size_t maxLength);
+
+    // max mode
+    static const uint8_t LONG_MATCH = 255; // length of a token with offset 0 which is followed by uint32_t offset and length
+    static const uint32_t MIN_LONG_MATCH = 12;
+    static const uint32_t MAX_SHORT_OFFSET = 65535;
+    static const uint32_t MAX_SHORT_LENGTH = 255;
+    static const uint32_t MAX_WINDOW_CANDIDATES = 64; // neighbours in suffix array checked for a short match in the window
 protected:
     struct data {
         uint32_t inputStrLength;
         Array<uint16_t> offsets;
         Array<uint8_t> lengths;
         StringL<charType> chars;
+        Array<uint32_t> longOffsets; // offsets and lengths of long matches (tokens with offset 0 and length LONG_MATCH)
+        Array<uint32_t> longLengths;
 
         data() = default;
         data(const uint32_t inputStrLength_, const Array<uint16_t>& offsets_, const Array<uint8_t>& lengths_, const StringL<charType> chars_) :
@@ -50,9 +86,14 @@ protected:
         static const data fromString(const StringL<charType>& str, const uint32_t inputStrLength);
     };
 
-    static data encodeToData(const StringL<charType>& inputStr);
+    static data encodeToData(const StringL<charType>& inputStr, const CompressorSettings& settings = CompressorSettings());
+    // tokens of max mode
+    static data factorize(const StringL<charType>& inputStr, const CompressorSettings& settings);
     static void encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8);
     static StringL<charType> decodeData(const data& data);
+    // tokens of delta mode: matches can also copy any part of the reference, decoder should get the same reference
+    static data encodeDeltaToData(const StringL<charType>& text, const StringL<charType>& reference, const CompressorSettings& settings);
+    static StringL<charType> decodeDeltaData(const data& data, const StringL<charType>& reference);
 };
 
 
@@ -61,11 +102,15 @@ protected:
 // ==== PUBLIC ====
 
 template <typename charType>
-void CodecLZ77<charType>::Encode(const StringL<charType>& text, std::ofstream& outputFile, const bool useUTF8)
+void CodecLZ77<charType>::Encode(const StringL<charType>& text, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings)
 {
+    if (settings.GetLZ77MaxMode()) {
+        encodeData(outputFile, factorize(text, settings), useUTF8);
+        return;
+    }
     FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(text.size()));
 
-    const uint32_t searchBufferSize = CompressorSettings::GetLZ77SearchBufferSize();
+    const uint32_t searchBufferSize = settings.GetLZ77SearchBufferSize();
     const uint32_t lookaheadBufferSize = CodecLZ77<charType>::lookaheadBufferSize;
 
     uint32_t i = 0; // pointer within a text
@@ -141,6 +186,13 @@ StringL<charType> CodecLZ77<charType>::Decode(std::ifstream& inputFile, const bo
         }
         else
         {
+            if (offset == 0 && length == LONG_MATCH) {
+                offset = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+                length = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+            }
+            if (offset == 0 || offset > stringPointer || length > inputStrLength - stringPointer || inputFile.eof()) {
+                throw std::runtime_error("CodecLZ77::Decode(): Corrupted data!");
+            }
             uint32_t start = stringPointer - offset;
             uint32_t end = stringPointer - offset + length;
             stringPointer += length;
@@ -155,6 +207,23 @@ StringL<charType> CodecLZ77<charType>::Decode(std::ifstream& inputFile, const bo
 
 // ==== PRIVATE ====
 
+template <typename charType>
+uint32_t CodecLZ77<charType>::hashChars(const charType* chars, const uint32_t count)
+{
+    uint32_t hash = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        hash = (hash ^ static_cast<uint32_t>(chars[i])) * 2654435761u;
+    }
+    return hash >> (32 - HASH_BITS);
+}
+
+template <typename charType>
+size_t CodecLZ77<charType>::matchLength(const charType* a, const charType* b, const size_t maxLength)
+{
+    // bytes of the first different character aren't all equal, so the division gives the number of equal characters
+    return SimdUtils::MatchLength(reinterpret_cast<const uint8_t*>(a), reinterpret_cast<const uint8_t*>(b), maxLength * sizeof(charType)) / sizeof(charType);
+}
+
 /**
  * Searches for the target string within the original string, bounded by the specified start and end indexes.
  * Returns the index of the first occurrence of the target string, or -1 if not found.
@@ -186,9 +255,12 @@ int CodecLZ77<charType>::find(const StringL<charType>& target, const StringL<cha
 // ==== PROTECTED ====
 
 template <typename charType>
-typename CodecLZ77<charType>::data CodecLZ77<charType>::encodeToData(const StringL<charType>& text)
+typename CodecLZ77<charType>::data CodecLZ77<charType>::encodeToData(const StringL<charType>& text, const CompressorSettings& settings)
 {
-    const uint32_t searchBufferSize = CompressorSettings::GetLZ77SearchBufferSize();
+    if (settings.GetLZ77MaxMode()) {
+        return factorize(text, settings);
+    }
+    const uint32_t searchBufferSize = settings.GetLZ77SearchBufferSize();
     const uint32_t lookaheadBufferSize = CodecLZ77<charType>::lookaheadBufferSize;
 
     Array<uint8_t> lengths(text.size());
@@ -240,12 +312,227 @@ typename CodecLZ77<charType>::data CodecLZ77<charType>::encodeToData(const Strin
     return data(text.size(), offsets, lengths, chars);
 }
 
+template <typename charType>
+typename CodecLZ77<charType>::data CodecLZ77<charType>::factorize(const StringL<charType>& inputStr, const CompressorSettings& settings)
+{
+    if (inputStr.size() >= INT32_MAX) {
+        throw std::invalid_argument("CodecLZ77: Text is too long for max mode!");
+    }
+    data result;
+    result.inputStrLength = static_cast<uint32_t>(inputStr.size());
+    if (inputStr.size() == 0) {
+        return result;
+    }
+
+    // longest previous factors of all positions (endChar is never a part of a match, so 0 works for any text)
+    const Array<int> suffixArr = (inputStr.size() >= settings.GetParallelSuffixArrayThreshold()) ?
+        buildSuffixArrayParallel(inputStr, static_cast<charType>(0), settings.GetSuffixArrayThreadsCount()) :
+        buildSuffixArray(inputStr, static_cast<charType>(0));
+    const Array<uint32_t> lcp = buildLCPArray(inputStr, suffixArr);
+    Array<uint32_t> lengths, sources;
+    buildLongestPreviousFactors(suffixArr, lcp, lengths, sources);
+    Array<uint32_t> rank(suffixArr.size(), 0);
+    for (uint32_t r = 0; r < suffixArr.size(); ++r) {
+        rank[suffixArr[r]] = r;
+    }
+
+    // greedy parsing: the longest match at every position
+    size_t i = 0;
+    while (i < inputStr.size()) {
+        uint32_t length = lengths[i];
+        uint32_t offset = static_cast<uint32_t>(i) - sources[i];
+        if (length > 0 && length < MIN_LONG_MATCH && offset > MAX_SHORT_OFFSET) {
+            // the longest match is too far for a token and too short for a long match, take the longest one in the window
+            // from the nearest suffixes in suffix array order (their common prefix with suffix i only decreases with the distance)
+            length = 0;
+            for (int direction = -1; direction <= 1; direction += 2) {
+                uint32_t common = UINT32_MAX;
+                int64_t r = rank[i];
+                for (uint32_t step = 0; step < MAX_WINDOW_CANDIDATES; ++step) {
+                    const uint32_t lcpIndex = static_cast<uint32_t>((direction < 0) ? r : r + 1);
+                    r += direction;
+                    if (r < 0 || r >= static_cast<int64_t>(suffixArr.size())) break;
+                    if (lcp[lcpIndex] < common) common = lcp[lcpIndex];
+                    if (common <= length) break;
+                    const uint32_t j = static_cast<uint32_t>(suffixArr[static_cast<size_t>(r)]);
+                    if (j < i && i - j <= MAX_SHORT_OFFSET) {
+                        length = common;
+                        offset = static_cast<uint32_t>(i) - j;
+                        break;
+                    }
+                }
+            }
+        }
+        if (length >= MIN_LONG_MATCH && (offset > MAX_SHORT_OFFSET || length > MAX_SHORT_LENGTH)) {
+            result.offsets.push_back(0);
+            result.lengths.push_back(LONG_MATCH);
+            result.longOffsets.push_back(offset);
+            result.longLengths.push_back(length);
+            i += length;
+        } else if (length > 0 && offset <= MAX_SHORT_OFFSET) {
+            // length <= MAX_SHORT_LENGTH here
+            result.offsets.push_back(static_cast<uint16_t>(offset));
+            result.lengths.push_back(static_cast<uint8_t>(length));
+            i += length;
+        } else {
+            result.offsets.push_back(0);
+            result.lengths.push_back(0);
+            result.chars.push_back(inputStr[i++]);
+        }
+    }
+    return result;
+}
+
+template <typename charType>
+typename CodecLZ77<charType>::data CodecLZ77<charType>::encodeDeltaToData(const StringL<charType>& text, const StringL<charType>& reference, const CompressorSettings& settings)
+{
+    if (text.size() > UINT32_MAX || reference.size() > UINT32_MAX) {
+        throw std::invalid_argument("CodecLZ77: Text or reference is too long for delta mode!");
+    }
+    data result;
+    result.inputStrLength = static_cast<uint32_t>(text.size());
+
+    const size_t searchBufferSize = settings.GetLZ77SearchBufferSize();
+    const size_t hashSize = static_cast<size_t>(1) << HASH_BITS;
+    const charType* chars = text.c_str();
+    const charType* referenceChars = reference.c_str();
+
+    // chains of positions with the same hash (the last position first)
+    Array<uint32_t> referenceHead(hashSize, NO_POSITION);
+    Array<uint32_t> referenceChain(reference.size() + 1, NO_POSITION);
+    for (size_t p = 0; p + MIN_REFERENCE_MATCH <= reference.size(); ++p) {
+        const uint32_t hash = hashChars(referenceChars + p, MIN_REFERENCE_MATCH);
+        referenceChain[p] = referenceHead[hash];
+        referenceHead[hash] = static_cast<uint32_t>(p);
+    }
+    Array<uint32_t> windowHead(hashSize, NO_POSITION);
+    Array<uint32_t> windowChain(text.size() + 1, NO_POSITION);
+    size_t inserted = 0; // positions of the text before it are in the window chains
+    size_t expected = 0; // position of the reference after the last reference match
+
+    size_t i = 0; // pointer within a text
+    while (i < text.size())
+    {
+        const size_t left = text.size() - i;
+
+        // the longest match in the reference: continuation of the previous match or candidates of the chain
+        size_t referenceLength = 0, referencePosition = 0;
+        if (left >= MIN_REFERENCE_MATCH) {
+            if (expected < reference.size()) {
+                referenceLength = matchLength(chars + i, referenceChars + expected, std::min(left, reference.size() - expected));
+                referencePosition = expected;
+            }
+            if (referenceLength < MIN_REFERENCE_MATCH) {
+                uint32_t candidate = referenceHead[hashChars(chars + i, MIN_REFERENCE_MATCH)];
+                for (uint32_t steps = 0; candidate != NO_POSITION && steps < MAX_CHAIN_LENGTH; ++steps, candidate = referenceChain[candidate]) {
+                    const size_t length = matchLength(chars + i, referenceChars + candidate, std::min(left, reference.size() - candidate));
+                    if (length > referenceLength) {
+                        referenceLength = length;
+                        referencePosition = candidate;
+                    }
+                }
+            }
+        }
+
+        // the longest match in the search buffer
+        size_t windowLength = 0, windowOffset = 0;
+        if (referenceLength < MIN_REFERENCE_MATCH && left >= MIN_WINDOW_MATCH) {
+            const size_t maxLength = (left < MAX_WINDOW_MATCH) ? left : MAX_WINDOW_MATCH;
+            uint32_t candidate = windowHead[hashChars(chars + i, MIN_WINDOW_MATCH)];
+            for (uint32_t steps = 0; candidate != NO_POSITION && steps < MAX_CHAIN_LENGTH && i - candidate <= searchBufferSize;
+                 ++steps, candidate = windowChain[candidate]) {
+                const size_t length = matchLength(chars + i, chars + candidate, maxLength);
+                if (length > windowLength) {
+                    windowLength = length;
+                    windowOffset = i - candidate;
+                }
+            }
+        }
+
+        // add the token (a reference match is stored as a long match: offset 0, length REFERENCE_MATCH, position and length in the reference)
+        size_t advance = 1;
+        if (referenceLength >= MIN_REFERENCE_MATCH) {
+            result.offsets.push_back(0);
+            result.lengths.push_back(REFERENCE_MATCH);
+            result.longOffsets.push_back(static_cast<uint32_t>(referencePosition));
+            result.longLengths.push_back(static_cast<uint32_t>(referenceLength));
+            expected = referencePosition + referenceLength;
+            advance = referenceLength;
+        } else if (windowLength >= MIN_WINDOW_MATCH) {
+            result.offsets.push_back(static_cast<uint16_t>(windowOffset));
+            result.lengths.push_back(static_cast<uint8_t>(windowLength));
+            advance = windowLength;
+        } else {
+            result.offsets.push_back(0);
+            result.lengths.push_back(0);
+            result.chars.push_back(text[i]);
+        }
+
+        // add passed positions to the window chains
+        i += advance;
+        for (; inserted < i && inserted + MIN_WINDOW_MATCH <= text.size(); ++inserted) {
+            const uint32_t hash = hashChars(chars + inserted, MIN_WINDOW_MATCH);
+            windowChain[inserted] = windowHead[hash];
+            windowHead[hash] = static_cast<uint32_t>(inserted);
+        }
+    }
+
+    return result;
+}
+
+template <typename charType>
+StringL<charType> CodecLZ77<charType>::decodeDeltaData(const data& data, const StringL<charType>& reference)
+{
+    StringL<charType> decoded(data.inputStrLength);
+    size_t charsPointer = 0;
+    size_t longPointer = 0;
+
+    for (size_t i = 0; decoded.size() < data.inputStrLength; ++i)
+    {
+        if (i >= data.lengths.size()) {
+            throw std::runtime_error("CodecLZ77::decodeDeltaData(): Corrupted data!");
+        }
+        const uint32_t offset = data.offsets[i];
+        const uint32_t length = data.lengths[i];
+        const size_t left = data.inputStrLength - decoded.size();
+        if (length == 0) {
+            if (charsPointer >= data.chars.size()) {
+                throw std::runtime_error("CodecLZ77::decodeDeltaData(): Corrupted data!");
+            }
+            decoded.push_back(data.chars[charsPointer++]);
+        } else if (offset == 0) {
+            if (length != REFERENCE_MATCH || longPointer >= data.longOffsets.size()) {
+                throw std::runtime_error("CodecLZ77::decodeDeltaData(): Corrupted data!");
+            }
+            const uint32_t position = data.longOffsets[longPointer];
+            const uint32_t referenceMatch = data.longLengths[longPointer++];
+            if (position > reference.size() || referenceMatch > reference.size() - position || referenceMatch > left) {
+                throw std::runtime_error("CodecLZ77::decodeDeltaData(): Corrupted data!");
+            }
+            for (uint32_t j = 0; j < referenceMatch; ++j) {
+                decoded.push_back(reference[position + j]);
+            }
+        } else {
+            if (offset > decoded.size() || length > left) {
+                throw std::runtime_error("CodecLZ77::decodeDeltaData(): Corrupted data!");
+            }
+            const size_t start = decoded.size() - offset;
+            for (uint32_t j = 0; j < length; ++j) {
+                decoded.push_back(decoded[start + j]);
+            }
+        }
+    }
+
+    return decoded;
+}
+
 template <typename charType>
 void CodecLZ77<charType>::encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8)
 {
     FileUtils::AppendValueBinary(outputFile, data.inputStrLength);
 
     size_t charsPointer = 0;
+    size_t longPointer = 0;
 
     for (uint32_t i = 0; i < data.lengths.size(); ++i)
     {
@@ -257,6 +544,9 @@ void CodecLZ77<charType>::encodeData(std::ofstream& outputFile, const data& data
             } else {
                 FileUtils::AppendValueBinary(outputFile, data.chars[charsPointer++]);
             }
+        } else if (data.offsets[i] == 0 && data.lengths[i] == LONG_MATCH) {
+            FileUtils::AppendValueBinary(outputFile, data.longOffsets[longPointer]);
+            FileUtils::AppendValueBinary(outputFile, data.longLengths[longPointer++]);
         }
     }
 }
@@ -266,11 +556,15 @@ StringL<charType> CodecLZ77<charType>::decodeData(const data& data)
 {
     StringL<charType> decoded(data.inputStrLength);
     size_t charsPointer = 0;
+    size_t longPointer = 0;
     uint32_t stringPointer = 0; // pointer within abstract input text (text before encoding)
 
     uint32_t i = 0;
     while (decoded.size() < data.inputStrLength)
     {
+        if (i >= data.lengths.size()) {
+            throw std::runtime_error("CodecLZ77::decodeData(): Corrupted data!");
+        }
         if (data.lengths[i] == 0)
         {
             decoded.push_back(data.chars[charsPointer++]);
@@ -278,9 +572,18 @@ StringL<charType> CodecLZ77<charType>::decodeData(const data& data)
         }
         else
         {
-            uint32_t start = stringPointer - data.offsets[i];
-            uint32_t end = stringPointer - data.offsets[i] + data.lengths[i];
-            stringPointer += data.lengths[i];
+            uint32_t offset = data.offsets[i];
+            uint32_t length = data.lengths[i];
+            if (offset == 0 && length == LONG_MATCH && longPointer < data.longOffsets.size()) {
+                offset = data.longOffsets[longPointer];
+                length = data.longLengths[longPointer++];
+            }
+            if (offset == 0 || offset > stringPointer || length > data.inputStrLength - stringPointer) {
+                throw std::runtime_error("CodecLZ77::decodeData(): Corrupted data!");
+            }
+            uint32_t start = stringPointer - offset;
+            uint32_t end = stringPointer - offset + length;
+            stringPointer += length;
             for (uint32_t j = start; j < end; ++j) {
                 decoded.push_back(decoded[j]);
             }
@@ -295,8 +598,9 @@ StringL<charType> CodecLZ77<charType>::decodeData(const data& data)
 template <typename charType>
 const StringL<charType> CodecLZ77<charType>::data::toString() const
 {
-    StringL<charType> result(offsets.size() + lengths.size() + chars.size());
+    StringL<charType> result(offsets.size() + lengths.size() + chars.size() + 8 * longOffsets.size());
     size_t charsPointer = 0;
+    size_t longPointer = 0;
 
     if (std::is_same<charType, unsigned char>::value)
     {
@@ -307,6 +611,11 @@ const StringL<charType> CodecLZ77<charType>::data::toString() const
             //result.push_back(static_cast<unsigned char>(lengths[i] >> 8));
             result.push_back(static_cast<unsigned char>(lengths[i]));
             if (lengths[i] == 0) { result.push_back(chars[charsPointer++]); }
+            if (offsets[i] == 0 && lengths[i] == LONG_MATCH) {
+                for (int shift = 24; shift >= 0; shift -= 8) result.push_back(static_cast<unsigned char>(longOffsets[longPointer] >> shift));
+                for (int shift = 24; shift >= 0; shift -= 8) result.push_back(static_cast<unsigned char>(longLengths[longPointer] >> shift));
+                ++longPointer;
+            }
         }
     }
     else if ((std::is_same<charType, char16_t>::value) || (std::is_same<charType, unsigned short>::value))
@@ -316,6 +625,12 @@ const StringL<charType> CodecLZ77<charType>::data::toString() const
             result.push_back(static_cast<unsigned short>(offsets[i]));
             result.push_back(static_cast<unsigned short>(lengths[i]));
             if (lengths[i] == 0) { result.push_back(chars[charsPointer++]); }
+            if (offsets[i] == 0 && lengths[i] == LONG_MATCH) {
+                result.push_back(static_cast<unsigned short>(longOffsets[longPointer] >> 16));
+                result.push_back(static_cast<unsigned short>(longOffsets[longPointer]));
+                result.push_back(static_cast<unsigned short>(longLengths[longPointer] >> 16));
+                result.push_back(static_cast<unsigned short>(longLengths[longPointer++]));
+            }
         }
     }
     else if ((std::is_same<charType, char32_t>::value) || (std::is_same<charType, unsigned int>::value))
@@ -324,6 +639,10 @@ const StringL<charType> CodecLZ77<charType>::data::toString() const
         {
             result.push_back(static_cast<unsigned int>((offsets[i] << 8) + lengths[i]));
             if (lengths[i] == 0) { result.push_back(chars[charsPointer++]); }
+            if (offsets[i] == 0 && lengths[i] == LONG_MATCH) {
+                result.push_back(static_cast<unsigned int>(longOffsets[longPointer]));
+                result.push_back(static_cast<unsigned int>(longLengths[longPointer++]));
+            }
         }
     }
     else
@@ -356,6 +675,13 @@ const typename CodecLZ77<charType>::data CodecLZ77<charType>::data::fromString(c
             result.lengths.push_back(length);
             i += 3;
             if (length == 0) { result.chars.push_back(str[i++]); }
+            if (offset == 0 && length == LONG_MATCH && i + 8 <= str.size()) {
+                uint32_t longOffset = 0, longLength = 0;
+                for (int j = 0; j < 4; ++j) longOffset = (longOffset << 8) | static_cast<uint32_t>(str[i++]);
+                for (int j = 0; j < 4; ++j) longLength = (longLength << 8) | static_cast<uint32_t>(str[i++]);
+                result.longOffsets.push_back(longOffset);
+                result.longLengths.push_back(longLength);
+            }
         }
     }
     else if ((std::is_same<charType, char16_t>::value) || (std::is_same<charType, unsigned short>::value))
@@ -367,17 +693,26 @@ const typename CodecLZ77<charType>::data CodecLZ77<charType>::data::fromString(c
             result.lengths.push_back(length);
             result.offsets.push_back(offset);
             if (length == 0) { result.chars.push_back(str[i++]); }
+            if (offset == 0 && length == LONG_MATCH && i + 4 <= str.size()) {
+                result.longOffsets.push_back((static_cast<uint32_t>(str[i]) << 16) | static_cast<uint32_t>(str[i + 1]));
+                result.longLengths.push_back((static_cast<uint32_t>(str[i + 2]) << 16) | static_cast<uint32_t>(str[i + 3]));
+                i += 4;
+            }
         }
     }
     else if ((std::is_same<charType, char32_t>::value) || (std::is_same<charType, unsigned int>::value))
     {
         while (i < str.size())
         {
-            offset = static_cast<uint16_t>(str[i] & 0b00000000111111111111111100000000);
+            offset = static_cast<uint16_t>((str[i] & 0b00000000111111111111111100000000) >> 8);
             length = static_cast<uint8_t>(str[i++] & 0b00000000000000000000000011111111);
             result.offsets.push_back(offset);
             result.lengths.push_back(length);
             if (length == 0) { result.chars.push_back(str[i++]); }
+            if (offset == 0 && length == LONG_MATCH && i + 2 <= str.size()) {
+                result.longOffsets.push_back(static_cast<uint32_t>(str[i++]));
+                result.longLengths.push_back(static_cast<uint32_t>(str[i++]));
+            }
         }
     }
     else
@@ -6,6 +6,8 @@
 #include "../helpers/FileUtils.h"
 #include "../helpers/CodecUTF8.h"
 #include "../helpers/TextUtils.h"
+#include "../helpers/AlphabetMap.h"
+#include "../helpers/MoveToFront.h"
 #include "../helpers/StringL.h"
 #include "../helpers/Array.h"
 
@@ -21,8 +23,13 @@
  * - charType - The unsigned type of the characters in the string (unsigned char, char16_t/unsigned short , char32_t/unsigned int).
  * 
  * Memory usage:
- * θ((sizeof(inputStr)) + θ(inputStr.size() * 4) + O(1)
+ * θ((sizeof(inputStr)) + θ(inputStr.size() * sizeof(charType)) + O(alphabetSize)
  * 
+ * Details:
+ * - MTF works over dense ranks of characters (AlphabetMap), the list and the search are done by MoveToFront (SIMD search in a byte list for
+ *   alphabets of at most 256 characters, a Fenwick tree for large alphabets)
+ * - Codes are less than the alphabet size, so they are kept in charType in data (the next codec reads them as a string without conversion)
+ *   and Encode() / Decode() keep them in the narrowest type which is written to the file (uint8_t, uint16_t or uint32_t)
  */
 template <typename charType>
 class CodecMTF
@@ -32,21 +39,24 @@ public:
     static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
 private:
     CodecMTF() = default;
-    static inline void AlphabetShift(Array<charType>& alphabet, const uint32_t index);
-    static inline const uint32_t GetIndex(const Array<charType>& alphabet, const charType c);
+
+    template <typename codeType>
+    static void encodeCodes(std::ofstream& outputFile, const StringL<charType>& ranks, const size_t alphabetSize);
+    template <typename codeType>
+    static void decodeCodes(std::ifstream& inputFile, const Array<charType>& alphabet, StringL<charType>& decodedStr);
 protected:
     struct data {
         uint32_t alphabetLength;
         Array<charType> alphabet;
         uint32_t inputStrLength;
-        Array<uint32_t> codes;
+        StringL<charType> codes;
 
         data() = default;
-        data(const uint32_t _alphabetLength, const Array<charType>& _alphabet, const uint32_t _inputStrLength, const Array<uint32_t>& _codes) : 
+        data(const uint32_t _alphabetLength, const Array<charType>& _alphabet, const uint32_t _inputStrLength, const StringL<charType>& _codes) : 
             alphabetLength(_alphabetLength), alphabet(_alphabet), inputStrLength(_inputStrLength), codes(_codes) {}
 
         StringL<charType> toString();
-        static Array<uint32_t> codesFromString(const StringL<charType>& str);
+        static StringL<charType> codesFromString(const StringL<charType>& str);
     };
 
     static data encodeToData(const StringL<charType>& inputStr);
@@ -63,18 +73,11 @@ protected:
 template <typename charType>
 void CodecMTF<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
 {
-    Array<charType> alphabet = TextUtils::GetAlphabet<charType>(inputStr);
-
-    Array<uint32_t> codes(inputStr.size());
-    uint32_t index;
-    // move-to-front
-    for (const auto& c : inputStr) {
-        index = GetIndex(alphabet, c);
-        codes.push_back(index);
-        AlphabetShift(alphabet, index);
-    }
+    AlphabetMap<charType> alphabetMap(inputStr);
+    StringL<charType> ranks(inputStr.size(), 0);
+    alphabetMap.ToRanks(inputStr.c_str(), inputStr.size(), ranks.begin());
 
-    std::sort(alphabet.begin(), alphabet.end());
+    const Array<charType>& alphabet = alphabetMap.GetSymbols();
 
     // write alphabet length
     FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(alphabet.size()));
@@ -90,14 +93,11 @@ void CodecMTF<charType>::Encode(const StringL<charType>& inputStr, std::ofstream
     FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(inputStr.size()));
     // write codes
     if (alphabet.size() <= 256) {
-        for (const auto& code : codes)
-            FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(code));
+        encodeCodes<uint8_t>(outputFile, ranks, alphabet.size());
     } else if (alphabet.size() <= 65536) {
-        for (const auto& code : codes)
-            FileUtils::AppendValueBinary(outputFile, static_cast<uint16_t>(code));
+        encodeCodes<uint16_t>(outputFile, ranks, alphabet.size());
     } else {
-        for (const auto& code : codes)
-            FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(code));
+        encodeCodes<uint32_t>(outputFile, ranks, alphabet.size());
     }
 }
 
@@ -118,33 +118,15 @@ StringL<charType> CodecMTF<charType>::Decode(std::ifstream& inputFile, const boo
     }
 
     uint32_t inputStrLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
-    StringL<charType> decodedStr(inputStrLength);
+    StringL<charType> decodedStr(inputStrLength, 0);
 
     // decode
     if (alphabetLength <= 256) {
-        uint8_t index;
-        for (uint32_t i = 0; i < inputStrLength; ++i) {
-            index = FileUtils::ReadValueBinary<uint8_t>(inputFile);
-            decodedStr.push_back(alphabet[index]);
-
-            AlphabetShift(alphabet, index);
-        }
+        decodeCodes<uint8_t>(inputFile, alphabet, decodedStr);
     } else if (alphabetLength <= 65536) {
-        uint16_t index;
-        for (uint32_t i = 0; i < inputStrLength; ++i) {
-            index = FileUtils::ReadValueBinary<uint16_t>(inputFile);
-            decodedStr.push_back(alphabet[index]);
-
-            AlphabetShift(alphabet, index);
-        }
+        decodeCodes<uint16_t>(inputFile, alphabet, decodedStr);
     } else {
-        uint32_t index;
-        for (uint32_t i = 0; i < inputStrLength; ++i) {
-            index = FileUtils::ReadValueBinary<uint32_t>(inputFile);
-            decodedStr.push_back(alphabet[index]);
-
-            AlphabetShift(alphabet, index);
-        }
+        decodeCodes<uint32_t>(inputFile, alphabet, decodedStr);
     }
 
     return decodedStr;
@@ -153,29 +135,27 @@ StringL<charType> CodecMTF<charType>::Decode(std::ifstream& inputFile, const boo
 // ==== PRIVATE ====
 
 template <typename charType>
-inline void CodecMTF<charType>::AlphabetShift(Array<charType>& alphabet, const uint32_t index)
+template <typename codeType>
+void CodecMTF<charType>::encodeCodes(std::ofstream& outputFile, const StringL<charType>& ranks, const size_t alphabetSize)
 {
-    charType temp = alphabet[0], temp2;
-    for (uint32_t i = 1; i <= index; ++i) {
-        temp2 = alphabet[i];
-        alphabet.assign(i, temp);
-        temp = temp2;
-    }
-    alphabet.assign(0, temp);
+    Array<codeType> codes(ranks.size(), 0);
+    MoveToFront::Encode(ranks.c_str(), ranks.size(), alphabetSize, codes.begin());
+    for (const codeType& code : codes)
+        FileUtils::AppendValueBinary(outputFile, code);
 }
 
 template <typename charType>
-const uint32_t CodecMTF<charType>::GetIndex(const Array<charType>& alphabet, const charType c)
+template <typename codeType>
+void CodecMTF<charType>::decodeCodes(std::ifstream& inputFile, const Array<charType>& alphabet, StringL<charType>& decodedStr)
 {
-    for (size_t i = 0; i < alphabet.size(); ++i) {
-        if (alphabet[i] == c) {
-            return static_cast<uint32_t>(i);
-        }
+    Array<codeType> codes(decodedStr.size(), 0);
+    for (size_t i = 0; i < codes.size(); ++i) {
+        codes[i] = FileUtils::ReadValueBinary<codeType>(inputFile);
+    }
+    MoveToFront::Decode(codes.begin(), codes.size(), alphabet.size(), decodedStr.begin());
+    for (size_t i = 0; i < decodedStr.size(); ++i) {
+        decodedStr[i] = alphabet[decodedStr[i]];
     }
-
-    // assume this will never happen
-    throw std::runtime_error("CodecMTF::GetIndex(): Something went wrong!");
-    return 0;
 }
 
 // ==== PROTECTED ====
@@ -183,19 +163,13 @@ const uint32_t CodecMTF<charType>::GetIndex(const Array<charType>& alphabet, con
 template <typename charType>
 typename CodecMTF<charType>::data CodecMTF<charType>::encodeToData(const StringL<charType>& inputStr)
 {
-    Array<charType> alphabet = TextUtils::GetAlphabet<charType>(inputStr);
-
-    Array<uint32_t> codes(inputStr.size());
-    uint32_t index;
-    // move-to-front
-    for (const auto& c : inputStr) {
-        index = GetIndex(alphabet, c);
-        codes.push_back(index);
-        AlphabetShift(alphabet, index);
-    }
+    // ranks are replaced by codes in place
+    AlphabetMap<charType> alphabetMap(inputStr);
+    StringL<charType> codes(inputStr.size(), 0);
+    alphabetMap.ToRanks(inputStr.c_str(), inputStr.size(), codes.begin());
+    MoveToFront::Encode(codes.c_str(), codes.size(), alphabetMap.Size(), codes.begin());
 
-    std::sort(alphabet.begin(), alphabet.end());
-    return data(alphabet.size(), alphabet, inputStr.size(), codes);
+    return data(alphabetMap.Size(), alphabetMap.GetSymbols(), inputStr.size(), codes);
 }
 
 template <typename charType>
@@ -233,13 +207,11 @@ void CodecMTF<charType>::encodeData(std::ofstream& outputFile, const data& data,
 template <typename charType>
 StringL<charType> CodecMTF<charType>::decodeData(const data& data)
 {
-    StringL<charType> decodedStr(data.inputStrLength);
-    Array<charType> alphabet = data.alphabet;
-
-    // decode
-    for (const auto& code : data.codes) {
-        decodedStr.push_back(alphabet[code]);
-        AlphabetShift(alphabet, code);
+    // codes are replaced by ranks, then by characters in place
+    StringL<charType> decodedStr(data.codes.size(), 0);
+    MoveToFront::Decode(data.codes.c_str(), data.codes.size(), data.alphabet.size(), decodedStr.begin());
+    for (size_t i = 0; i < decodedStr.size(); ++i) {
+        decodedStr[i] = data.alphabet[decodedStr[i]];
     }
     return decodedStr;
 }
@@ -247,21 +219,13 @@ StringL<charType> CodecMTF<charType>::decodeData(const data& data)
 template <typename charType>
 StringL<charType> CodecMTF<charType>::data::toString()
 {
-    StringL<charType> result(inputStrLength);
-    for (const uint32_t& code : codes) {
-        result.push_back(static_cast<charType>(code));
-    }
-    return result;
+    return codes;
 }
 
 template <typename charType>
-Array<uint32_t> CodecMTF<charType>::data::codesFromString(const StringL<charType>& str)
+StringL<charType> CodecMTF<charType>::data::codesFromString(const StringL<charType>& str)
 {
-    Array<uint32_t> codes(str.size());
-    for (const auto& c : str) {
-        codes.push_back(static_cast<uint32_t>(c));
-    }
-    return codes;
+    return str;
 }
 
 
@@ -2,12 +2,17 @@
 
 #include <string>
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
 
 #include "../helpers/FileUtils.h"
 #include "../helpers/CodecUTF8.h"
+#include "../helpers/SimdUtils.h"
 #include "../helpers/StringL.h"
 #include "../helpers/Array.h"
 
+#include "../compressor/CompressorSettings.h"
+
 
 /**
  * CodecRLE (encoder - decoder).
@@ -23,17 +28,20 @@
  * if use protected methods:        θ((sizeof(inputStr)) + θ(inputStr.size()) + O(1)
  * if use only public methods:      O(1)
  * 
+ * Details:
+ * - Without utf-8 public methods treat every settings.GetRLEElementStride() characters as one unit
+ *   (e.g. stride = 3 for RGB pixels), find runs comparing 16-32 bytes at once and copy unique units by blocks
  */
 template <typename charType>
 class CodecRLE
 {
 public:
-    static void Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    static void Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings = CompressorSettings());
     static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
 private:
     CodecRLE() = default;
 
-    static void encode(std::ofstream& outputFile, const StringL<charType>& inputStr);
+    static void encode(std::ofstream& outputFile, const StringL<charType>& inputStr, const size_t stride);
     static void encode_utf8(std::ofstream& outputFile, const StringL<charType>& inputStr);
     static StringL<charType> decode(std::ifstream& inputFile);
     static StringL<charType> decode_utf8(std::ifstream& inputFile);
@@ -62,10 +70,10 @@ protected:
 // ==== PUBLIC ====
 
 template <typename charType>
-void CodecRLE<charType>::Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+void CodecRLE<charType>::Encode(StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings)
 {
     if (useUTF8) encode_utf8(outputFile, inputStr);
-    else encode(outputFile, inputStr);
+    else encode(outputFile, inputStr, settings.GetRLEElementStride());
 }
 
 template <typename charType>
@@ -78,114 +86,62 @@ StringL<charType> CodecRLE<charType>::Decode(std::ifstream& inputFile, const boo
 // ==== PRIVATE ====
 
 template <typename charType>
-void CodecRLE<charType>::encode(std::ofstream& outputFile, const StringL<charType>& inputStr)
+void CodecRLE<charType>::encode(std::ofstream& outputFile, const StringL<charType>& inputStr, const size_t stride)
 {
-    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(inputStr.size()));
-
-    int countIdent = 1; // current count of repeating identical characters
-    int countUnique = 1; // current count of repeating unique characters
-    StringL<charType> uniqueSeq; // buffer to store last sequence of unique characters
-    bool flag = false; // show if previous character was part of sequence
-    int maxPossibleNumber = 127; // maximum possible value of int8_t
+    // RLE over raw bytes where one unit = stride characters (e.g. stride = 3 for RGB pixels)
+    const size_t unitSize = stride * sizeof(charType); // size of one unit in bytes
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(inputStr.c_str());
+    const size_t bytesCount = inputStr.size() * sizeof(charType);
+    const size_t unitsCount = bytesCount / unitSize;
+    const size_t maxPossibleNumber = 127; // maximum possible value of int8_t
 
-    uniqueSeq.resize(maxPossibleNumber); // preallocate for optimization
-    charType prev = inputStr[0];
-    uniqueSeq.push_back(prev);
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(inputStr.size()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(stride));
+
+    size_t pos = 0; // current unit
+    size_t literalStart = 0; // first unit of the current sequence of unique units
+
+    // writes sequence of unique units [literalStart, pos) with bulk copies
+    auto flushLiteral = [&]() {
+        while (literalStart < pos) {
+            size_t count = std::min(pos - literalStart, maxPossibleNumber);
+            FileUtils::AppendValueBinary(outputFile, static_cast<int8_t>(-static_cast<int>(count)));
+            outputFile.write(reinterpret_cast<const char*>(bytes + literalStart * unitSize), count * unitSize);
+            literalStart += count;
+        }
+    };
 
     // start RLE
-    for (size_t i = 1; i < inputStr.size(); ++i)
+    while (pos < unitsCount)
     {
-        if (inputStr[i] == prev) 
-        {
-            // record last sequence of unique symbols if it exists
-            if (countUnique > 1) {
-                uniqueSeq.pop_back(); // because "prev" was read as unique
-                --countUnique; // because "prev" was read as unique
-
-                FileUtils::AppendValueBinary(outputFile, static_cast<int8_t>(-countUnique));
-                for (size_t j = 0; j < uniqueSeq.size(); ++j)
-                    FileUtils::AppendValueBinary(outputFile, uniqueSeq[j]);
-
-                countUnique = 1;
-            }
-
-            if (flag) { countIdent = 1; flag = false; } 
-            else { ++countIdent; }
-            
-            countUnique = 0;
-            uniqueSeq.clear();
+        // length of sequence of identical units starting at pos (compare the sequence with itself shifted by one unit)
+        size_t run = 1;
+        if (pos + 1 < unitsCount) {
+            const uint8_t* unit = bytes + pos * unitSize;
+            run += SimdUtils::MatchLength(unit, unit + unitSize, (unitsCount - pos - 1) * unitSize) / unitSize;
         }
-        else 
-        {
-            // record last sequence of identical symbols if it exists
-            if (countIdent > 1) {
-                if (countIdent >= maxPossibleNumber) {
-                    for (int i = 0; i < (countIdent / maxPossibleNumber); ++i) {
-                        FileUtils::AppendValueBinary(outputFile, static_cast<int8_t>(maxPossibleNumber));
-                        FileUtils::AppendValueBinary(outputFile, prev);
-                    }
-                }
-                if (countIdent % maxPossibleNumber != 0) {
-                    FileUtils::AppendValueBinary(outputFile, static_cast<int8_t>(countIdent % maxPossibleNumber));
-                    FileUtils::AppendValueBinary(outputFile, prev);
-                }
-                flag = true;
-                countIdent = 1;
-            } else if (countIdent == 0) {
-                countIdent = 1;
-            }
 
-            if (flag) {
-                countUnique = 1;
-                uniqueSeq.clear();
-                uniqueSeq.push_back(inputStr[i]);
-                flag = false;
-            } else {
-                if (countUnique == 0) {
-                    countUnique = 1;
-                    uniqueSeq.clear();
-                    uniqueSeq.push_back(prev);
-                }
-
-                ++countUnique;
-                uniqueSeq.push_back(inputStr[i]);
-            }
-            countIdent = 1;
-
-            // limit length of sequence
-            if (countUnique == maxPossibleNumber) {
-                FileUtils::AppendValueBinary(outputFile, static_cast<int8_t>(-countUnique));
-                for (size_t j = 0; j < uniqueSeq.size(); ++j) {
-                    FileUtils::AppendValueBinary(outputFile, uniqueSeq[j]);                
-                }
-                flag = true;
-                countUnique = 0;
-                uniqueSeq.clear();
+        if (run > 1) {
+            flushLiteral();
+            while (run > 0) {
+                size_t count = std::min(run, maxPossibleNumber);
+                FileUtils::AppendValueBinary(outputFile, static_cast<int8_t>(count));
+                outputFile.write(reinterpret_cast<const char*>(bytes + pos * unitSize), unitSize);
+                pos += count;
+                run -= count;
             }
+            literalStart = pos;
+        } else if (unitSize == 1) {
+            // jump right to the start of the next sequence of identical bytes
+            pos += SimdUtils::FindNeighbourRepeat(bytes + pos, unitsCount - pos);
+        } else {
+            ++pos;
         }
-        prev = inputStr[i];
     }
+    flushLiteral();
 
-    // record last sequence which was lost in the loop
-    if (countIdent > 1) {
-        if (countIdent >= maxPossibleNumber) {
-            for (int i = 0; i < (countIdent / maxPossibleNumber); ++i) {
-                FileUtils::AppendValueBinary(outputFile, static_cast<int8_t>(maxPossibleNumber));
-                FileUtils::AppendValueBinary(outputFile, prev);
-            }
-        }
-        if (countIdent % maxPossibleNumber != 0) {
-            FileUtils::AppendValueBinary(outputFile, static_cast<int8_t>(countIdent % maxPossibleNumber));
-            FileUtils::AppendValueBinary(outputFile, prev);
-        }
-    }
-    if (countUnique > 0) {
-        FileUtils::AppendValueBinary(outputFile, static_cast<int8_t>(-countUnique));
-        for (size_t j = 0; j < uniqueSeq.size(); ++j) {
-            FileUtils::AppendValueBinary(outputFile, uniqueSeq[j]);
-        }
-    }
-    
+    // write bytes which don't form a whole unit
+    outputFile.write(reinterpret_cast<const char*>(bytes + unitsCount * unitSize), bytesCount - unitsCount * unitSize);
 }
 
 template <typename charType>
@@ -303,30 +259,52 @@ template <typename charType>
 StringL<charType> CodecRLE<charType>::decode(std::ifstream& inputFile)
 {
     uint32_t inputStrLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    const size_t stride = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+    // the same range as CompressorSettings::SetRLEElementStride() (0 would divide by zero, larger strides would read past the block)
+    if (stride < 1 || stride > 4) {
+        throw std::runtime_error("CodecRLE::decode(): Corrupted data!");
+    }
+    const size_t unitSize = stride * sizeof(charType);
+    const size_t bytesCount = static_cast<size_t>(inputStrLength) * sizeof(charType);
+    const size_t unitsCount = bytesCount / unitSize;
 
-    StringL<charType> decodedStr(inputStrLength);
+    StringL<charType> decodedStr(inputStrLength, 0);
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(decodedStr.begin());
 
-    uint32_t counter = 0;
+    size_t counter = 0; // number of decoded units
     int8_t number;
-    while (counter < inputStrLength)
+    while (counter < unitsCount)
     {
         number = FileUtils::ReadValueBinary<int8_t>(inputFile);
+        size_t count = (number < 0) ? -static_cast<int>(number) : number;
+        if (count == 0 || counter + count > unitsCount || inputFile.eof()) {
+            throw std::runtime_error("CodecRLE::decode(): Corrupted data!");
+        }
 
+        uint8_t* dest = bytes + counter * unitSize;
         if (number < 0) {
-            for (int8_t i = 0; i < (-number); ++i) {
-                decodedStr.push_back(FileUtils::ReadValueBinary<charType>(inputFile));
-                ++counter;
-            }
+            // sequence of unique units is copied at once
+            inputFile.read(reinterpret_cast<char*>(dest), count * unitSize);
         } else {
-            charType code = FileUtils::ReadValueBinary<charType>(inputFile);
-
-            for (int8_t i = 0; i < number; ++i) {
-                decodedStr.push_back(code);
-                ++counter;
+            // sequence of identical units is filled like memset
+            inputFile.read(reinterpret_cast<char*>(dest), unitSize);
+            if (unitSize == 1) {
+                std::memset(dest + 1, dest[0], count - 1);
+            } else {
+                size_t filled = unitSize, total = count * unitSize;
+                while (filled < total) {
+                    size_t chunk = std::min(filled, total - filled);
+                    std::memcpy(dest + filled, dest, chunk);
+                    filled += chunk;
+                }
             }
         }
+        counter += count;
     }
 
+    // read bytes which don't form a whole unit
+    inputFile.read(reinterpret_cast<char*>(bytes + unitsCount * unitSize), bytesCount - unitsCount * unitSize);
+
     return decodedStr;
 }
 
@@ -498,6 +476,7 @@ void CodecRLE<charType>::encodeData(std::ofstream& outputFile, const data& data,
             }
         }
     } else {
+        FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(1)); // stride (data always holds single characters)
         for (const auto& number : data.encodedNumbers) {
             FileUtils::AppendValueBinary(outputFile, number);
             if (number < 0) {
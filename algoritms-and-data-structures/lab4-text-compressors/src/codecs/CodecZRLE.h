@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+#include "../helpers/FileUtils.h"
+#include "../helpers/CodecUTF8.h"
+#include "../helpers/StringL.h"
+#include "../helpers/Array.h"
+
+
+/**
+ * CodecZRLE (encoder - decoder).
+ *
+ * Brief:
+ * - Class defines static methods to encode / decode any string given in StringL class using zero-run-length method (RUNA / RUNB)
+ * - It also defines methods to use a class with other codecs. Those methods defined in "protected"
+ *
+ * Parameters:
+ * - charType - The unsigned type of the characters in the string (unsigned char, char16_t/unsigned short , char32_t/unsigned int).
+ *
+ * Memory usage:
+ * θ(4 * inputStr.size()) + O(1)
+ *
+ * Details:
+ * - Codec is specialized for the output of MTF where most of codes are zeros
+ * - Every run of zeros of length n is written in bijective base-2 with digits RUNA (= 1) and RUNB (= 2), least significant digit first,
+ *   so the run takes about log2(n) symbols. Symbol 0 is RUNA, symbol 1 is RUNB, any other code c is written as c + 1
+ * - In strings symbols which don't fit into charType are escaped by the maximum value of charType
+ */
+template <typename charType>
+class CodecZRLE
+{
+public:
+    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+private:
+    CodecZRLE() = default;
+protected:
+    static const uint32_t RUNA = 0;
+    static const uint32_t RUNB = 1;
+
+    // append a run of zeros to symbols (Array<uint32_t>) or to their string form (StringL<charType>, the same as data::toString() writes them)
+    template <typename symbolsType>
+    static inline void appendRun(symbolsType& symbols, uint32_t runLength);
+    // append a nonzero code to the string form of symbols
+    static inline void appendCode(StringL<charType>& str, const uint32_t code);
+
+    struct data {
+        uint32_t codesLength; // number of codes before encoding
+        Array<uint32_t> symbols; // RUNA, RUNB and shifted codes
+
+        data() = default;
+        data(const uint32_t _codesLength, const Array<uint32_t>& _symbols) :
+            codesLength(_codesLength), symbols(_symbols) {}
+
+        StringL<charType> toString() const;
+        static data fromString(const StringL<charType>& str);
+    };
+
+    static data encodeToData(const Array<uint32_t>& codes);
+    static Array<uint32_t> decodeData(const data& data);
+};
+
+
+// START IMPLEMENTATION
+
+// ==== PUBLIC ====
+
+template <typename charType>
+void CodecZRLE<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+{
+    Array<uint32_t> codes(inputStr.size());
+    for (const charType& c : inputStr) {
+        codes.push_back(static_cast<uint32_t>(c));
+    }
+
+    data zrleData = encodeToData(codes);
+    codes.free_memory();
+    StringL<charType> encodedStr = zrleData.toString();
+
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(encodedStr.size()));
+    if (useUTF8) {
+        for (const charType& c : encodedStr)
+            CodecUTF8::EncodeCharToBinaryFile(outputFile, c);
+    } else {
+        for (const charType& c : encodedStr)
+            FileUtils::AppendValueBinary(outputFile, c);
+    }
+}
+
+template <typename charType>
+StringL<charType> CodecZRLE<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+{
+    uint32_t encodedStrLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+
+    StringL<charType> encodedStr(encodedStrLength);
+    if (useUTF8) {
+        for (uint32_t i = 0; i < encodedStrLength; ++i)
+            encodedStr.push_back(CodecUTF8::DecodeCharFromBinaryFile<charType>(inputFile));
+    } else {
+        for (uint32_t i = 0; i < encodedStrLength; ++i)
+            encodedStr.push_back(FileUtils::ReadValueBinary<charType>(inputFile));
+    }
+
+    Array<uint32_t> codes = decodeData(data::fromString(encodedStr));
+    encodedStr.free_memory();
+
+    StringL<charType> decodedStr(codes.size());
+    for (const uint32_t& code : codes) {
+        decodedStr.push_back(static_cast<charType>(code));
+    }
+    return decodedStr;
+}
+
+// ==== PROTECTED ====
+
+template <typename charType>
+template <typename symbolsType>
+void CodecZRLE<charType>::appendRun(symbolsType& symbols, uint32_t runLength)
+{
+    // bijective base-2: runLength = sum(digit_i * 2^i), digit_i in {1 (RUNA), 2 (RUNB)}
+    while (runLength > 0) {
+        if (runLength & 1) {
+            symbols.push_back(RUNA);
+            runLength = (runLength - 1) >> 1;
+        } else {
+            symbols.push_back(RUNB);
+            runLength = (runLength - 2) >> 1;
+        }
+    }
+}
+
+template <typename charType>
+void CodecZRLE<charType>::appendCode(StringL<charType>& str, const uint32_t code)
+{
+    const uint32_t maxDirect = std::numeric_limits<charType>::max(); // escape value
+    const uint32_t symbol = code + 1;
+    if (symbol < maxDirect) {
+        str.push_back(static_cast<charType>(symbol));
+    } else {
+        str.push_back(static_cast<charType>(maxDirect));
+        str.push_back(static_cast<charType>(symbol - maxDirect));
+    }
+}
+
+template <typename charType>
+typename CodecZRLE<charType>::data CodecZRLE<charType>::encodeToData(const Array<uint32_t>& codes)
+{
+    Array<uint32_t> symbols(codes.size()); // the worst case: there are no zeros
+
+    uint32_t runLength = 0;
+    for (const uint32_t& code : codes) {
+        if (code == 0) {
+            ++runLength;
+        } else {
+            appendRun(symbols, runLength);
+            runLength = 0;
+            symbols.push_back(code + 1);
+        }
+    }
+    appendRun(symbols, runLength);
+
+    return data(codes.size(), symbols);
+}
+
+template <typename charType>
+Array<uint32_t> CodecZRLE<charType>::decodeData(const data& data)
+{
+    Array<uint32_t> codes(data.codesLength);
+
+    uint32_t runLength = 0, weight = 1;
+    for (const uint32_t& symbol : data.symbols) {
+        if (symbol <= RUNB) {
+            runLength += (symbol == RUNA) ? weight : (weight << 1);
+            weight <<= 1;
+        } else {
+            while (runLength > 0) { codes.push_back(0); --runLength; }
+            weight = 1;
+            codes.push_back(symbol - 1);
+        }
+    }
+    while (runLength > 0) { codes.push_back(0); --runLength; }
+
+    return codes;
+}
+
+template <typename charType>
+StringL<charType> CodecZRLE<charType>::data::toString() const
+{
+    const uint32_t maxDirect = std::numeric_limits<charType>::max(); // escape value
+
+    StringL<charType> result(symbols.size());
+    for (const uint32_t& symbol : symbols) {
+        if (symbol < maxDirect) {
+            result.push_back(static_cast<charType>(symbol));
+        } else {
+            result.push_back(static_cast<charType>(maxDirect));
+            result.push_back(static_cast<charType>(symbol - maxDirect));
+        }
+    }
+    return result;
+}
+
+template <typename charType>
+typename CodecZRLE<charType>::data CodecZRLE<charType>::data::fromString(const StringL<charType>& str)
+{
+    const uint32_t maxDirect = std::numeric_limits<charType>::max();
+
+    Array<uint32_t> symbols(str.size());
+    uint32_t codesLength = 0, weight = 1;
+    size_t i = 0;
+    while (i < str.size()) {
+        uint32_t symbol = str[i++];
+        if (symbol == maxDirect) {
+            if (i == str.size()) {
+                throw std::runtime_error("CodecZRLE: Corrupted data!");
+            }
+            symbol += str[i++];
+        }
+        symbols.push_back(symbol);
+
+        // count length of decoded codes to preallocate memory while decoding
+        if (symbol <= RUNB) {
+            codesLength += (symbol == RUNA) ? weight : (weight << 1);
+            weight <<= 1;
+        } else {
+            ++codesLength;
+            weight = 1;
+        }
+    }
+
+    return data(codesLength, symbols);
+}
+
+
+// END IMPLEMENTATION
\ No newline at end of file
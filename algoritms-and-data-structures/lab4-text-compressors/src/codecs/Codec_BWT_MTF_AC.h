@@ -33,11 +33,15 @@ class Codec_BWT_MTF_AC: CodecBWT<charType>,
 private:
     Codec_BWT_MTF_AC() = default;
 public:
-    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings = CompressorSettings());
     static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+    // decodes all stages but the inverse BWT: returns the BWT string, its primary index and checkpoints
+    static StringL<charType> DecodeBWT(std::ifstream& inputFile, const bool useUTF8, uint32_t& indexBWT, uint32_t& checkpointStep, Array<uint32_t>& checkpoints);
 protected:
     struct data {
         uint32_t indexBWT;
+        uint32_t checkpointStepBWT;
+        Array<uint32_t> checkpointsBWT;
         uint32_t alphabetLengthMTF;
         Array<charType> alphabetMTF;
         typename CodecAC<charType>::data dataAC;
@@ -49,13 +53,15 @@ protected:
 // START IMPLEMENTATION
 
 template <typename charType>
-void Codec_BWT_MTF_AC<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+void Codec_BWT_MTF_AC<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings)
 {
     // ==== GET DATA ====
     Codec_BWT_MTF_AC<charType>::data data;
 
-    auto bwtData = CodecBWT<charType>::encodeToData(inputStr);
+    auto bwtData = CodecBWT<charType>::encodeToData(inputStr, settings);
     data.indexBWT = bwtData.index;
+    data.checkpointStepBWT = bwtData.checkpointStep;
+    data.checkpointsBWT = bwtData.checkpoints;
     std::cout << "\tBWT done." << std::endl;
 
     auto mtfData = CodecMTF<charType>::encodeToData(bwtData.encodedStr);
@@ -83,10 +89,11 @@ void Codec_BWT_MTF_AC<charType>::Encode(const StringL<charType>& inputStr, std::
             FileUtils::AppendValueBinary(outputFile, c);
     }
     FileUtils::AppendValueBinary(outputFile, data.indexBWT);
+    CodecBWT<charType>::encodeCheckpoints(outputFile, data.checkpointStepBWT, data.checkpointsBWT);
 }
 
 template <typename charType>
-StringL<charType> Codec_BWT_MTF_AC<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+StringL<charType> Codec_BWT_MTF_AC<charType>::DecodeBWT(std::ifstream& inputFile, const bool useUTF8, uint32_t& indexBWT, uint32_t& checkpointStep, Array<uint32_t>& checkpoints)
 {
     // decode AC
     StringL<charType> strAC = CodecAC<charType>::Decode(inputFile, useUTF8);
@@ -105,16 +112,29 @@ StringL<charType> Codec_BWT_MTF_AC<charType>::Decode(std::ifstream& inputFile, c
         }
     }
     uint32_t inputStrLengthtMTF = strAC.size();
-    Array<uint32_t> codesMTF = CodecMTF<charType>::data::codesFromString(strAC);
+    StringL<charType> codesMTF = CodecMTF<charType>::data::codesFromString(strAC);
     strAC.free_memory();
     StringL<charType> strMTF = CodecMTF<charType>::decodeData(typename CodecMTF<charType>::data(alphabetLengthMTF, alphabetMTF, inputStrLengthtMTF, codesMTF));
     alphabetMTF.free_memory();
     codesMTF.free_memory();
     std::cout << "\tMTF done." << std::endl;
 
+    // read BWT data
+    indexBWT = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    CodecBWT<charType>::decodeCheckpoints(inputFile, checkpointStep, checkpoints);
+
+    return strMTF;
+}
+
+template <typename charType>
+StringL<charType> Codec_BWT_MTF_AC<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+{
+    uint32_t index, checkpointStep;
+    Array<uint32_t> checkpoints;
+    StringL<charType> strBWT = DecodeBWT(inputFile, useUTF8, index, checkpointStep, checkpoints);
+
     // decode BWT
-    uint32_t index = FileUtils::ReadValueBinary<uint32_t>(inputFile);
-    StringL<charType> decodedStr = CodecBWT<charType>::decodeData(typename CodecBWT<charType>::data(index, strMTF.size(), strMTF));
+    StringL<charType> decodedStr = CodecBWT<charType>::decodeData(typename CodecBWT<charType>::data(index, strBWT.size(), strBWT, checkpointStep, checkpoints));
     std::cout << "\tBWT done." << std::endl;
 
     return decodedStr;
@@ -32,11 +32,15 @@ class Codec_BWT_MTF_HA: CodecBWT<charType>,
 private:
     Codec_BWT_MTF_HA() = default;
 public:
-    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings = CompressorSettings());
     static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+    // decodes all stages but the inverse BWT: returns the BWT string, its primary index and checkpoints
+    static StringL<charType> DecodeBWT(std::ifstream& inputFile, const bool useUTF8, uint32_t& indexBWT, uint32_t& checkpointStep, Array<uint32_t>& checkpoints);
 protected:
     struct data {
         uint32_t indexBWT;
+        uint32_t checkpointStepBWT;
+        Array<uint32_t> checkpointsBWT;
         uint32_t alphabetLengthMTF;
         Array<charType> alphabetMTF;
         typename CodecHA<charType>::data dataHA;
@@ -48,13 +52,15 @@ protected:
 // START IMPLEMENTATION
 
 template <typename charType>
-void Codec_BWT_MTF_HA<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+void Codec_BWT_MTF_HA<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings)
 {
     // ==== GET DATA ====
     Codec_BWT_MTF_HA<charType>::data data;
 
-    auto bwtData = CodecBWT<charType>::encodeToData(inputStr);
+    auto bwtData = CodecBWT<charType>::encodeToData(inputStr, settings);
     data.indexBWT = bwtData.index;
+    data.checkpointStepBWT = bwtData.checkpointStep;
+    data.checkpointsBWT = bwtData.checkpoints;
     std::cout << "\tBWT done." << std::endl;
 
     auto mtfData = CodecMTF<charType>::encodeToData(bwtData.encodedStr);
@@ -66,7 +72,7 @@ void Codec_BWT_MTF_HA<charType>::Encode(const StringL<charType>& inputStr, std::
     StringL<charType> mtfStr = mtfData.toString();
     mtfData.codes.free_memory();
     mtfData.alphabet.free_memory();
-    auto haData = CodecHA<charType>::encodeToData(mtfStr);
+    auto haData = CodecHA<charType>::encodeToData(mtfStr, settings);
     mtfStr.free_memory();
     data.dataHA = haData;
     std::cout << "\tHA done." << std::endl;
@@ -82,10 +88,11 @@ void Codec_BWT_MTF_HA<charType>::Encode(const StringL<charType>& inputStr, std::
             FileUtils::AppendValueBinary(outputFile, c);
     }
     FileUtils::AppendValueBinary(outputFile, data.indexBWT);
+    CodecBWT<charType>::encodeCheckpoints(outputFile, data.checkpointStepBWT, data.checkpointsBWT);
 }
 
 template <typename charType>
-StringL<charType> Codec_BWT_MTF_HA<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+StringL<charType> Codec_BWT_MTF_HA<charType>::DecodeBWT(std::ifstream& inputFile, const bool useUTF8, uint32_t& indexBWT, uint32_t& checkpointStep, Array<uint32_t>& checkpoints)
 {
     // decode HA
     StringL<charType> strHA = CodecHA<charType>::Decode(inputFile, useUTF8);
@@ -93,7 +100,7 @@ StringL<charType> Codec_BWT_MTF_HA<charType>::Decode(std::ifstream& inputFile, c
 
     // decode MTF
     uint32_t strLengthtMTF = strHA.size();
-    Array<uint32_t> codesMTF = CodecMTF<charType>::data::codesFromString(strHA);
+    StringL<charType> codesMTF = CodecMTF<charType>::data::codesFromString(strHA);
     strHA.free_memory();
     uint32_t alphabetLengthMTF = FileUtils::ReadValueBinary<uint32_t>(inputFile);
     Array<charType> alphabetMTF(alphabetLengthMTF);
@@ -111,9 +118,22 @@ StringL<charType> Codec_BWT_MTF_HA<charType>::Decode(std::ifstream& inputFile, c
     codesMTF.free_memory();
     std::cout << "\tMTF done." << std::endl;
 
+    // read BWT data
+    indexBWT = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    CodecBWT<charType>::decodeCheckpoints(inputFile, checkpointStep, checkpoints);
+
+    return strMTF;
+}
+
+template <typename charType>
+StringL<charType> Codec_BWT_MTF_HA<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+{
+    uint32_t index, checkpointStep;
+    Array<uint32_t> checkpoints;
+    StringL<charType> strBWT = DecodeBWT(inputFile, useUTF8, index, checkpointStep, checkpoints);
+
     // decode BWT
-    uint32_t index = FileUtils::ReadValueBinary<uint32_t>(inputFile);
-    StringL<charType> decodedStr = CodecBWT<charType>::decodeData(typename CodecBWT<charType>::data(index, strMTF.size(), strMTF));
+    StringL<charType> decodedStr = CodecBWT<charType>::decodeData(typename CodecBWT<charType>::data(index, strBWT.size(), strBWT, checkpointStep, checkpoints));
     std::cout << "\tBWT done." << std::endl;
 
     return decodedStr;
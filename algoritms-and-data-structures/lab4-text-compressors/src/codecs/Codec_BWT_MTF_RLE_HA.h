@@ -34,11 +34,15 @@ class Codec_BWT_MTF_RLE_HA: CodecBWT<charType>,
 private:
     Codec_BWT_MTF_RLE_HA() = default;
 public:
-    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings = CompressorSettings());
     static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+    // decodes all stages but the inverse BWT: returns the BWT string, its primary index and checkpoints
+    static StringL<charType> DecodeBWT(std::ifstream& inputFile, const bool useUTF8, uint32_t& indexBWT, uint32_t& checkpointStep, Array<uint32_t>& checkpoints);
 protected:
     struct data {
         uint32_t indexBWT;
+        uint32_t checkpointStepBWT;
+        Array<uint32_t> checkpointsBWT;
         uint32_t alphabetLengthMTF;
         Array<charType> alphabetMTF;
         typename CodecHA<charType>::data dataHA;
@@ -50,13 +54,15 @@ protected:
 // START IMPLEMENTATION
 
 template <typename charType>
-void Codec_BWT_MTF_RLE_HA<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+void Codec_BWT_MTF_RLE_HA<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings)
 {
     // ==== GET DATA ====
     Codec_BWT_MTF_RLE_HA<charType>::data data;
 
-    auto bwtData = CodecBWT<charType>::encodeToData(inputStr);
+    auto bwtData = CodecBWT<charType>::encodeToData(inputStr, settings);
     data.indexBWT = bwtData.index;
+    data.checkpointStepBWT = bwtData.checkpointStep;
+    data.checkpointsBWT = bwtData.checkpoints;
     std::cout << "\tBWT done." << std::endl;
 
     auto mtfData = CodecMTF<charType>::encodeToData(bwtData.encodedStr);
@@ -75,7 +81,7 @@ void Codec_BWT_MTF_RLE_HA<charType>::Encode(const StringL<charType>& inputStr, s
     StringL<charType> rleStr = rleData.toString();
     rleData.encodedNumbers.free_memory();
     rleData.encodedChars.free_memory();
-    auto haData = CodecHA<charType>::encodeToData(rleStr);
+    auto haData = CodecHA<charType>::encodeToData(rleStr, settings);
     rleStr.free_memory();
     data.dataHA = haData;
     std::cout << "\tHA done." << std::endl;
@@ -91,10 +97,11 @@ void Codec_BWT_MTF_RLE_HA<charType>::Encode(const StringL<charType>& inputStr, s
             FileUtils::AppendValueBinary(outputFile, c);
     }
     FileUtils::AppendValueBinary(outputFile, data.indexBWT);
+    CodecBWT<charType>::encodeCheckpoints(outputFile, data.checkpointStepBWT, data.checkpointsBWT);
 }
 
 template <typename charType>
-StringL<charType> Codec_BWT_MTF_RLE_HA<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+StringL<charType> Codec_BWT_MTF_RLE_HA<charType>::DecodeBWT(std::ifstream& inputFile, const bool useUTF8, uint32_t& indexBWT, uint32_t& checkpointStep, Array<uint32_t>& checkpoints)
 {
     // decode HA
     StringL<charType> strHA = CodecHA<charType>::Decode(inputFile, useUTF8);
@@ -121,16 +128,29 @@ StringL<charType> Codec_BWT_MTF_RLE_HA<charType>::Decode(std::ifstream& inputFil
         }
     }
     uint32_t strLengthtMTF = strRLE.size();
-    Array<uint32_t> codesMTF = CodecMTF<charType>::data::codesFromString(strRLE);
+    StringL<charType> codesMTF = CodecMTF<charType>::data::codesFromString(strRLE);
     strRLE.free_memory();
     StringL<charType> strMTF = CodecMTF<charType>::decodeData(typename CodecMTF<charType>::data(alphabetLengthMTF, alphabetMTF, strLengthtMTF, codesMTF));
     alphabetMTF.free_memory();
     codesMTF.free_memory();
     std::cout << "\tMTF done." << std::endl;
 
+    // read BWT data
+    indexBWT = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    CodecBWT<charType>::decodeCheckpoints(inputFile, checkpointStep, checkpoints);
+
+    return strMTF;
+}
+
+template <typename charType>
+StringL<charType> Codec_BWT_MTF_RLE_HA<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+{
+    uint32_t index, checkpointStep;
+    Array<uint32_t> checkpoints;
+    StringL<charType> strBWT = DecodeBWT(inputFile, useUTF8, index, checkpointStep, checkpoints);
+
     // decode BWT
-    uint32_t index = FileUtils::ReadValueBinary<uint32_t>(inputFile);
-    StringL<charType> decodedStr = CodecBWT<charType>::decodeData(typename CodecBWT<charType>::data(index, strMTF.size(), strMTF));
+    StringL<charType> decodedStr = CodecBWT<charType>::decodeData(typename CodecBWT<charType>::data(index, strBWT.size(), strBWT, checkpointStep, checkpoints));
     std::cout << "\tBWT done." << std::endl;
 
     return decodedStr;
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "../helpers/FileUtils.h"
+#include "../helpers/CodecUTF8.h"
+#include "../helpers/AlphabetMap.h"
+#include "../helpers/SimdUtils.h"
+#include "../helpers/StringL.h"
+#include "../helpers/Array.h"
+
+#include "CodecBWT.h"
+#include "CodecMTF.h"
+#include "CodecZRLE.h"
+
+/**
+ * Codec_BWT_MTF_ZRLE (encoder - decoder).
+ *
+ * Brief:
+ * - Class defines protected static methods which do BWT, MTF and ZRLE (zero-run-length) stages of codecs Codec_BWT_MTF_ZRLE_* in one pass,
+ *   the entropy coder of every codec encodes the result
+ *
+ * Parameters:
+ * - charType - The unsigned type of the characters in the string (unsigned char, char16_t/unsigned short , char32_t/unsigned int).
+ *
+ * Memory usage:
+ * θ((4 + 2 * sizeof(charType)) * inputStr.size()) + O(alphabetSize)
+ *
+ * Details:
+ * - Encoder reads the suffix array once: every row gives a BWT character, its MTF code is found and the run of zero codes is extended
+ *   or written as RUNA / RUNB symbols right away, so the BWT string, MTF codes (4 bytes per code) and ZRLE symbols are never stored,
+ *   only the string of ZRLE symbols (in the form of CodecZRLE::data::toString()) is built
+ * - MTF list of an alphabet of at most MAX_BYTE_ALPHABET characters is kept as bytes of ranks: the position is found by SimdUtils::FindByte()
+ *   (16 / 32 ranks per comparison), the list is shifted by memmove. Larger alphabets use a list of uint32_t ranks
+ * - Decoder turns ZRLE symbols into the BWT string directly (without MTF codes)
+ * - Output is the same as of CodecBWT, CodecMTF and CodecZRLE applied one after another
+ */
+template <typename charType>
+class Codec_BWT_MTF_ZRLE: protected CodecBWT<charType>,
+                          protected CodecMTF<charType>,
+                          protected CodecZRLE<charType>
+{
+protected:
+    Codec_BWT_MTF_ZRLE() = default;
+
+    static const uint32_t MAX_BYTE_ALPHABET = 256;
+
+    struct data {
+        uint32_t indexBWT;
+        uint32_t checkpointStepBWT;
+        Array<uint32_t> checkpointsBWT;
+        Array<charType> alphabetMTF;
+        StringL<charType> strZRLE; // input of the entropy coder
+        data() = default;
+    };
+
+    static data encodeToData(const StringL<charType>& inputStr, const CompressorSettings& settings = CompressorSettings());
+    // writes data of MTF and BWT (it follows data of the entropy coder)
+    static void encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8);
+    // reads data of MTF and BWT and returns the BWT string of the decoded ZRLE symbols
+    static StringL<charType> decodeData(std::ifstream& inputFile, const bool useUTF8, const StringL<charType>& strZRLE,
+                                        uint32_t& indexBWT, uint32_t& checkpointStep, Array<uint32_t>& checkpoints);
+private:
+    template <typename listType>
+    static inline uint32_t moveToFront(listType* list, const size_t size, const uint32_t rank);
+};
+
+
+// START IMPLEMENTATION
+
+// ==== PRIVATE ====
+
+template <typename charType>
+template <typename listType>
+uint32_t Codec_BWT_MTF_ZRLE<charType>::moveToFront(listType* list, const size_t size, const uint32_t rank)
+{
+    size_t index;
+    if constexpr (sizeof(listType) == 1) {
+        index = SimdUtils::FindByte(list, size, static_cast<uint8_t>(rank));
+    } else {
+        index = 0;
+        while (index < size && list[index] != rank) ++index;
+    }
+    if (index == size) {
+        throw std::runtime_error("Codec_BWT_MTF_ZRLE: Something went wrong!");
+    }
+    std::memmove(list + 1, list, index * sizeof(listType));
+    list[0] = static_cast<listType>(rank);
+    return static_cast<uint32_t>(index);
+}
+
+// ==== PROTECTED ====
+
+template <typename charType>
+typename Codec_BWT_MTF_ZRLE<charType>::data Codec_BWT_MTF_ZRLE<charType>::encodeToData(const StringL<charType>& inputStr, const CompressorSettings& settings)
+{
+    // the same end character and checkpoints as CodecBWT::encodeToData()
+    const charType endChar = '\0';
+    data result;
+
+    // alphabet of the BWT string: characters of inputStr and endChar
+    AlphabetMap<charType> alphabetMap(inputStr);
+    const bool hasEndChar = alphabetMap.Size() > 0 && alphabetMap.Symbol(0) == endChar;
+    const uint32_t rankShift = hasEndChar ? 0 : 1;
+    result.alphabetMTF = Array<charType>(alphabetMap.Size() + rankShift);
+    if (!hasEndChar) {
+        result.alphabetMTF.push_back(endChar);
+    }
+    for (const charType& c : alphabetMap.GetSymbols()) {
+        result.alphabetMTF.push_back(c);
+    }
+    const size_t alphabetSize = result.alphabetMTF.size();
+
+    Array<int> suffixArray = CodecBWT<charType>::getSuffixArray(inputStr, endChar, settings);
+    const uint32_t step = CodecBWT<charType>::getCheckpointStep(static_cast<uint32_t>(inputStr.size()), settings.GetBWTCheckpointsCount());
+    result.checkpointStepBWT = step;
+    result.checkpointsBWT = Array<uint32_t>((step > 0) ? (inputStr.size() - 1) / step : 0, 0);
+    result.indexBWT = 0;
+    result.strZRLE = StringL<charType>(inputStr.size() / 4 + 16); // grows if MTF codes are rarely zeros
+
+    // MTF list of ranks (the list begins with the sorted alphabet)
+    Array<uint8_t> byteList(MAX_BYTE_ALPHABET, 0);
+    Array<uint32_t> wideList;
+    const bool byteAlphabet = alphabetSize <= MAX_BYTE_ALPHABET;
+    if (byteAlphabet) {
+        for (size_t r = 0; r < alphabetSize; ++r) byteList[r] = static_cast<uint8_t>(r);
+    } else {
+        wideList = Array<uint32_t>(alphabetSize, 0);
+        for (size_t r = 0; r < alphabetSize; ++r) wideList[r] = static_cast<uint32_t>(r);
+    }
+    uint32_t front = 0; // rank at the front of the list
+
+    uint32_t runLength = 0;
+    for (size_t i = 0; i < suffixArray.size(); ++i) {
+        // BWT character of the row
+        const int position = suffixArray[i];
+        uint32_t rank = 0;
+        if (position == 0) {
+            result.indexBWT = static_cast<uint32_t>(i);
+        } else {
+            rank = alphabetMap.Rank(inputStr[static_cast<size_t>(position) - 1]) + rankShift;
+            if (step > 0 && static_cast<size_t>(position) < inputStr.size() && position % step == 0) {
+                result.checkpointsBWT[position / step - 1] = static_cast<uint32_t>(i);
+            }
+        }
+
+        // MTF code and ZRLE symbols
+        if (rank == front) {
+            ++runLength;
+            continue;
+        }
+        CodecZRLE<charType>::appendRun(result.strZRLE, runLength);
+        runLength = 0;
+        const uint32_t code = byteAlphabet ? moveToFront(&byteList[0], alphabetSize, rank) : moveToFront(&wideList[0], alphabetSize, rank);
+        CodecZRLE<charType>::appendCode(result.strZRLE, code);
+        front = rank;
+    }
+    CodecZRLE<charType>::appendRun(result.strZRLE, runLength);
+
+    return result;
+}
+
+template <typename charType>
+void Codec_BWT_MTF_ZRLE<charType>::encodeData(std::ofstream& outputFile, const data& data, const bool useUTF8)
+{
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(data.alphabetMTF.size()));
+    if (useUTF8) {
+        for (const charType c : data.alphabetMTF)
+            CodecUTF8::EncodeCharToBinaryFile(outputFile, c);
+    } else {
+        for (const charType c : data.alphabetMTF)
+            FileUtils::AppendValueBinary(outputFile, c);
+    }
+    FileUtils::AppendValueBinary(outputFile, data.indexBWT);
+    CodecBWT<charType>::encodeCheckpoints(outputFile, data.checkpointStepBWT, data.checkpointsBWT);
+}
+
+template <typename charType>
+StringL<charType> Codec_BWT_MTF_ZRLE<charType>::decodeData(std::ifstream& inputFile, const bool useUTF8, const StringL<charType>& strZRLE,
+                                                           uint32_t& indexBWT, uint32_t& checkpointStep, Array<uint32_t>& checkpoints)
+{
+    // read MTF alphabet
+    uint32_t alphabetLengthMTF = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    Array<charType> alphabet(alphabetLengthMTF);
+    if (useUTF8) {
+        while (alphabet.size() < alphabetLengthMTF && inputFile) {
+            alphabet.push_back(CodecUTF8::DecodeCharFromBinaryFile<charType>(inputFile));
+        }
+    } else {
+        while (alphabet.size() < alphabetLengthMTF && inputFile) {
+            alphabet.push_back(FileUtils::ReadValueBinary<charType>(inputFile));
+        }
+    }
+
+    // length of the BWT string (the same count as CodecZRLE::data::fromString() does)
+    const uint32_t maxDirect = std::numeric_limits<charType>::max();
+    uint64_t length = 0, weight = 1;
+    for (size_t i = 0; i < strZRLE.size(); ++i) {
+        const uint32_t symbol = strZRLE[i];
+        if (symbol <= CodecZRLE<charType>::RUNB) {
+            length += (symbol == CodecZRLE<charType>::RUNA) ? weight : (weight << 1);
+            weight <<= 1;
+        } else {
+            if (symbol == maxDirect) ++i;
+            ++length;
+            weight = 1;
+        }
+    }
+    if (length > UINT32_MAX || (length > 0 && alphabet.size() == 0)) {
+        throw std::runtime_error("Codec_BWT_MTF_ZRLE: Corrupted data!");
+    }
+
+    // ZRLE symbols -> MTF codes -> characters of the list
+    StringL<charType> strBWT(static_cast<size_t>(length));
+    uint32_t runLength = 0;
+    weight = 1;
+    size_t i = 0;
+    while (i <= strZRLE.size()) {
+        uint32_t symbol = 0;
+        const bool last = i == strZRLE.size();
+        if (!last) {
+            symbol = strZRLE[i++];
+            if (symbol == maxDirect) {
+                if (i == strZRLE.size()) throw std::runtime_error("Codec_BWT_MTF_ZRLE: Corrupted data!");
+                symbol += strZRLE[i++];
+            }
+            if (symbol <= CodecZRLE<charType>::RUNB) {
+                runLength += (symbol == CodecZRLE<charType>::RUNA) ? static_cast<uint32_t>(weight) : static_cast<uint32_t>(weight << 1);
+                weight <<= 1;
+                continue;
+            }
+        }
+        while (runLength > 0) { strBWT.push_back(alphabet[0]); --runLength; }
+        weight = 1;
+        if (last) break;
+
+        const uint32_t code = symbol - 1;
+        if (code >= alphabet.size()) {
+            throw std::runtime_error("Codec_BWT_MTF_ZRLE: Corrupted data!");
+        }
+        const charType c = alphabet[code];
+        std::memmove(&alphabet[1], &alphabet[0], code * sizeof(charType));
+        alphabet[0] = c;
+        strBWT.push_back(c);
+    }
+
+    // read BWT data
+    indexBWT = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    CodecBWT<charType>::decodeCheckpoints(inputFile, checkpointStep, checkpoints);
+
+    return strBWT;
+}
+
+
+// END IMPLEMENTATION
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+
+#include "../helpers/FileUtils.h"
+#include "../helpers/CodecUTF8.h"
+#include "../helpers/StringL.h"
+#include "../helpers/Array.h"
+
+#include "Codec_BWT_MTF_ZRLE.h"
+#include "CodecHA.h"
+
+/**
+ * Codec_BWT_MTF_ZRLE_HA (encoder - decoder).
+ * 
+ * Brief:
+ * - Class defines static methods to encode / decode any string given in StringL class using BWT, MTF, ZRLE (zero-run-length) and HA methods in order
+ * 
+ * Parameters:
+ * - charType - The unsigned type of the characters in the string (unsigned char, char16_t/unsigned short , char32_t/unsigned int).
+ * 
+ * Memory usage:
+ * ...
+ * 
+ */
+template <typename charType>
+class Codec_BWT_MTF_ZRLE_HA: Codec_BWT_MTF_ZRLE<charType>, 
+                             CodecHA<charType>
+{
+private:
+    Codec_BWT_MTF_ZRLE_HA() = default;
+public:
+    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings = CompressorSettings());
+    static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+    // decodes all stages but the inverse BWT: returns the BWT string, its primary index and checkpoints
+    static StringL<charType> DecodeBWT(std::ifstream& inputFile, const bool useUTF8, uint32_t& indexBWT, uint32_t& checkpointStep, Array<uint32_t>& checkpoints);
+};
+
+
+// START IMPLEMENTATION
+
+template <typename charType>
+void Codec_BWT_MTF_ZRLE_HA<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings)
+{
+    // ==== GET DATA ====
+    // BWT, MTF and ZRLE in one pass (without the BWT string and MTF codes)
+    auto data = Codec_BWT_MTF_ZRLE<charType>::encodeToData(inputStr, settings);
+    std::cout << "\tBWT, MTF, ZRLE done." << std::endl;
+
+    auto haData = CodecHA<charType>::encodeToData(data.strZRLE, settings);
+    data.strZRLE.free_memory();
+    std::cout << "\tHA done." << std::endl;
+
+    // ==== WRITE DATA ====
+    CodecHA<charType>::encodeData(outputFile, haData, useUTF8);
+    Codec_BWT_MTF_ZRLE<charType>::encodeData(outputFile, data, useUTF8);
+}
+
+template <typename charType>
+StringL<charType> Codec_BWT_MTF_ZRLE_HA<charType>::DecodeBWT(std::ifstream& inputFile, const bool useUTF8, uint32_t& indexBWT, uint32_t& checkpointStep, Array<uint32_t>& checkpoints)
+{
+    // decode HA
+    StringL<charType> strHA = CodecHA<charType>::Decode(inputFile, useUTF8);
+    std::cout << "\tHA done." << std::endl;
+
+    // decode ZRLE and MTF (straight to the BWT string)
+    StringL<charType> strBWT = Codec_BWT_MTF_ZRLE<charType>::decodeData(inputFile, useUTF8, strHA, indexBWT, checkpointStep, checkpoints);
+    strHA.free_memory();
+    std::cout << "\tZRLE, MTF done." << std::endl;
+
+    return strBWT;
+}
+
+template <typename charType>
+StringL<charType> Codec_BWT_MTF_ZRLE_HA<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+{
+    uint32_t index, checkpointStep;
+    Array<uint32_t> checkpoints;
+    StringL<charType> strBWT = DecodeBWT(inputFile, useUTF8, index, checkpointStep, checkpoints);
+
+    // decode BWT
+    StringL<charType> decodedStr = CodecBWT<charType>::decodeData(typename CodecBWT<charType>::data(index, strBWT.size(), strBWT, checkpointStep, checkpoints));
+    std::cout << "\tBWT done." << std::endl;
+
+    return decodedStr;
+}
+
+
+// END IMPLEMENTATION
\ No newline at end of file
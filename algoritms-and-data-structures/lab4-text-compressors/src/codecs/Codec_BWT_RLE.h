@@ -29,11 +29,15 @@ class Codec_BWT_RLE: CodecBWT<charType>,
 private:
     Codec_BWT_RLE() = default;
 public:
-    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings = CompressorSettings());
     static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+    // decodes all stages but the inverse BWT: returns the BWT string, its primary index and checkpoints
+    static StringL<charType> DecodeBWT(std::ifstream& inputFile, const bool useUTF8, uint32_t& indexBWT, uint32_t& checkpointStep, Array<uint32_t>& checkpoints);
 protected:
     struct data {
         uint32_t indexBWT;
+        uint32_t checkpointStepBWT;
+        Array<uint32_t> checkpointsBWT;
         typename CodecRLE<charType>::data dataRLE;
         data() = default;
     };
@@ -43,13 +47,15 @@ protected:
 // START IMPLEMENTATION
 
 template <typename charType>
-void Codec_BWT_RLE<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+void Codec_BWT_RLE<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings)
 {
     // ==== GET DATA ====
     Codec_BWT_RLE<charType>::data data;
 
-    auto bwtData = CodecBWT<charType>::encodeToData(inputStr);
+    auto bwtData = CodecBWT<charType>::encodeToData(inputStr, settings);
     data.indexBWT = bwtData.index;
+    data.checkpointStepBWT = bwtData.checkpointStep;
+    data.checkpointsBWT = bwtData.checkpoints;
     std::cout << "\tBWT done." << std::endl;
 
     auto rleData = CodecRLE<charType>::encodeToData(bwtData.encodedStr);
@@ -60,18 +66,32 @@ void Codec_BWT_RLE<charType>::Encode(const StringL<charType>& inputStr, std::ofs
     // ==== WRITE DATA ====
     CodecRLE<charType>::encodeData(outputFile, data.dataRLE, useUTF8);
     FileUtils::AppendValueBinary(outputFile, data.indexBWT);
+    CodecBWT<charType>::encodeCheckpoints(outputFile, data.checkpointStepBWT, data.checkpointsBWT);
 }
 
 template <typename charType>
-StringL<charType> Codec_BWT_RLE<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+StringL<charType> Codec_BWT_RLE<charType>::DecodeBWT(std::ifstream& inputFile, const bool useUTF8, uint32_t& indexBWT, uint32_t& checkpointStep, Array<uint32_t>& checkpoints)
 {
     // decode RLE
     StringL<charType> strRLE = CodecRLE<charType>::Decode(inputFile, useUTF8);
     std::cout << "\tRLE done." << std::endl;
 
+    // read BWT data
+    indexBWT = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    CodecBWT<charType>::decodeCheckpoints(inputFile, checkpointStep, checkpoints);
+
+    return strRLE;
+}
+
+template <typename charType>
+StringL<charType> Codec_BWT_RLE<charType>::Decode(std::ifstream& inputFile, const bool useUTF8)
+{
+    uint32_t index, checkpointStep;
+    Array<uint32_t> checkpoints;
+    StringL<charType> strBWT = DecodeBWT(inputFile, useUTF8, index, checkpointStep, checkpoints);
+
     // decode BWT
-    uint32_t index = FileUtils::ReadValueBinary<uint32_t>(inputFile);
-    StringL<charType> decodedStr = CodecBWT<charType>::decodeData(typename CodecBWT<charType>::data(index, strRLE.size(), strRLE));
+    StringL<charType> decodedStr = CodecBWT<charType>::decodeData(typename CodecBWT<charType>::data(index, strBWT.size(), strBWT, checkpointStep, checkpoints));
     std::cout << "\tBWT done." << std::endl;
 
     return decodedStr;
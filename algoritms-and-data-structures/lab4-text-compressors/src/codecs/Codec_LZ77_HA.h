@@ -3,6 +3,7 @@
 #include <cstdint>
 
 #include "../helpers/FileUtils.h"
+#include "../helpers/CRC32C.h"
 #include "../helpers/StringL.h"
 #include "../helpers/Array.h"
 
@@ -21,6 +22,10 @@
  * Memory usage:
  * ...
  * 
+ * Details:
+ * - EncodeDelta() / DecodeDelta() encode tokens of the delta mode of CodecLZ77 (matches can copy any part of a reference) by HA
+ *   in the same way. Size and CRC-32C of the reference are written first, so decoding with another reference fails.
+ *   Tokens aren't code points, so HA writes them without UTF-8
  */
 template <typename charType>
 class Codec_LZ77_HA: CodecLZ77<charType>, 
@@ -29,8 +34,10 @@ class Codec_LZ77_HA: CodecLZ77<charType>,
 private:
     Codec_LZ77_HA() = default;
 public:
-    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings = CompressorSettings());
     static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
+    static void EncodeDelta(const StringL<charType>& inputStr, const StringL<charType>& reference, std::ofstream& outputFile, const CompressorSettings& settings = CompressorSettings());
+    static StringL<charType> DecodeDelta(std::ifstream& inputFile, const StringL<charType>& reference);
 protected:
     struct data {
         uint32_t inputStrLength;
@@ -43,21 +50,21 @@ protected:
 // START IMPLEMENTATION
 
 template <typename charType>
-void Codec_LZ77_HA<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+void Codec_LZ77_HA<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings)
 {
     // ==== GET DATA ====
     Codec_LZ77_HA<charType>::data data;
 
     data.inputStrLength = inputStr.size();
 
-    auto lz77Data = CodecLZ77<charType>::encodeToData(inputStr);
+    auto lz77Data = CodecLZ77<charType>::encodeToData(inputStr, settings);
     StringL<charType> strLZ77 = lz77Data.toString();
     lz77Data.lengths.free_memory();
     lz77Data.offsets.free_memory();
     lz77Data.chars.free_memory();
     std::cout << "\tLZ77 done." << std::endl;
 
-    auto haData = CodecHA<charType>::encodeToData(strLZ77);
+    auto haData = CodecHA<charType>::encodeToData(strLZ77, settings);
     strLZ77.free_memory();
     data.dataHA = haData;
     std::cout << "\tHA done." << std::endl;
@@ -84,5 +91,59 @@ StringL<charType> Codec_LZ77_HA<charType>::Decode(std::ifstream& inputFile, cons
     return decodedStr;
 }
 
+template <typename charType>
+void Codec_LZ77_HA<charType>::EncodeDelta(const StringL<charType>& inputStr, const StringL<charType>& reference, std::ofstream& outputFile, const CompressorSettings& settings)
+{
+    // ==== GET DATA ====
+    Codec_LZ77_HA<charType>::data data;
+
+    auto lz77Data = CodecLZ77<charType>::encodeDeltaToData(inputStr, reference, settings);
+    data.inputStrLength = lz77Data.inputStrLength;
+    StringL<charType> strLZ77 = lz77Data.toString();
+    lz77Data.lengths.free_memory();
+    lz77Data.offsets.free_memory();
+    lz77Data.chars.free_memory();
+    lz77Data.longOffsets.free_memory();
+    lz77Data.longLengths.free_memory();
+    std::cout << "\tLZ77 done." << std::endl;
+
+    auto haData = CodecHA<charType>::encodeToData(strLZ77, settings);
+    strLZ77.free_memory();
+    data.dataHA = haData;
+    std::cout << "\tHA done." << std::endl;
+
+    // ==== WRITE DATA ====
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(reference.size()));
+    FileUtils::AppendValueBinary(outputFile, CRC32C::Compute(reference.c_str(), reference.size() * sizeof(charType)));
+    CodecHA<charType>::encodeData(outputFile, data.dataHA, false);
+    FileUtils::AppendValueBinary(outputFile, data.inputStrLength);
+}
+
+template <typename charType>
+StringL<charType> Codec_LZ77_HA<charType>::DecodeDelta(std::ifstream& inputFile, const StringL<charType>& reference)
+{
+    const uint32_t referenceLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    const uint32_t referenceCrc = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    if (!inputFile) {
+        throw std::runtime_error("Codec_LZ77_HA::DecodeDelta(): Corrupted data!");
+    }
+    if (referenceLength != reference.size() || referenceCrc != CRC32C::Compute(reference.c_str(), reference.size() * sizeof(charType))) {
+        throw std::runtime_error("Codec_LZ77_HA::DecodeDelta(): Reference doesn't match the encoded data!");
+    }
+
+    // decode HA
+    StringL<charType> strHA = CodecHA<charType>::Decode(inputFile, false);
+    std::cout << "\tHA done." << std::endl;
+
+    // decode LZ77
+    uint32_t inputStrLength = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    auto dataLZ77 = CodecLZ77<charType>::data::fromString(strHA, inputStrLength);
+    strHA.free_memory();
+    StringL<charType> decodedStr = CodecLZ77<charType>::decodeDeltaData(dataLZ77, reference);
+    std::cout << "\tLZ77 done." << std::endl;
+
+    return decodedStr;
+}
+
 
 // END IMPLEMENTATION
\ No newline at end of file
@@ -30,7 +30,7 @@ class Codec_RLE_HA: CodecRLE<charType>,
 private:
     Codec_RLE_HA() = default;
 public:
-    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8);
+    static void Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings = CompressorSettings());
     static StringL<charType> Decode(std::ifstream& inputFile, const bool useUTF8);
 protected:
     struct data {
@@ -43,7 +43,7 @@ protected:
 // START IMPLEMENTATION
 
 template <typename charType>
-void Codec_RLE_HA<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8)
+void Codec_RLE_HA<charType>::Encode(const StringL<charType>& inputStr, std::ofstream& outputFile, const bool useUTF8, const CompressorSettings& settings)
 {
     // ==== GET DATA ====
     Codec_RLE_HA<charType>::data data;
@@ -54,7 +54,7 @@ void Codec_RLE_HA<charType>::Encode(const StringL<charType>& inputStr, std::ofst
     StringL<charType> rleStr = rleData.toString();
     rleData.encodedNumbers.free_memory();
     rleData.encodedChars.free_memory();
-    auto haData = CodecHA<charType>::encodeToData(rleStr);
+    auto haData = CodecHA<charType>::encodeToData(rleStr, settings);
     rleStr.free_memory();
     data.dataHA = haData;
     std::cout << "\tHA done." << std::endl;
@@ -1,17 +1,151 @@
 #pragma once
 
-struct CompressorSettings
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+/**
+ * CompressorSettings.
+ *
+ * Brief:
+ * - Class defines parameters of one compression / decompression call, an object is passed to FileCompressor and codecs
+ *
+ * Details:
+ * - Every call gets its own object, so concurrent compressions with different parameters don't affect each other
+ * - Named presets: Fast() (small LZ77 window, large Huffman blocks, 8 Huffman streams and 7 BWT checkpoints for fast decoding), Default(),
+ *   Max() (LZ77 max mode without window limit, one Huffman stream without per-stream overhead); FromPreset() returns a preset by its name ("fast", "default", "max")
+ * - Parameters needed for decoding are recorded in the compressed data, so decoding doesn't depend on the settings of the encoder
+ * - Batch archives: SetSolidArchive(true) encodes new chunks of all files as one stream (blocks cross borders of files),
+ *   SetBatchOrder() sets the order of files in the stream (as given, by extensions and names, by extensions and similarity of content)
+ * - SetMemoryBudget() limits memory of BWT: a block whose prefix doubling suffix array wouldn't fit into the budget is sorted by SA-IS
+ *   (about 5 bytes per character instead of about 20, the result is the same)
+ */
+class CompressorSettings
 {
 public:
-    static void SetHuffmanBlockSize(const size_t size) { HuffmanBlockSize_ = size; }
-    static void SetLZ77SearchBufferSize(const size_t size) { LZ77searchBufferSize_ = size; }
-    static const size_t GetHuffmanBlockSize() { return HuffmanBlockSize_; }
-    static const size_t GetLZ77SearchBufferSize() { return LZ77searchBufferSize_; }
+    enum BatchOrder : uint8_t { INPUT_ORDER = 0, EXTENSION_ORDER = 1, SIMILARITY_ORDER = 2 };
+
+    CompressorSettings() :
+        HuffmanBlockSize_(10000), LZ77searchBufferSize_(32768), RLEElementStride_(1), HuffmanStreamsCount_(4),
+        SuffixArrayThreadsCount_(0), ParallelSuffixArrayThreshold_(1 << 16), BlockSize_(0), TransposeStride_(3),
+        ImageWidth_(0), ImagePixelSize_(1), VerifyChecksums_(true), BWTCheckpointsCount_(0), DedupChunkSize_(8192),
+        SolidArchive_(false), BatchOrder_(EXTENSION_ORDER), LZ77MaxMode_(false), MemoryBudget_(0) {}
+
+    static CompressorSettings Fast() {
+        CompressorSettings settings;
+        settings.SetLZ77SearchBufferSize(4096);
+        settings.SetHuffmanBlockSize(65536);
+        settings.SetHuffmanStreamsCount(8);
+        settings.SetBWTCheckpointsCount(7);
+        return settings;
+    }
+    static CompressorSettings Default() { return CompressorSettings(); }
+    static CompressorSettings Max() {
+        CompressorSettings settings;
+        settings.SetLZ77SearchBufferSize(MAX_LZ77_SEARCH_BUFFER_SIZE);
+        settings.SetLZ77MaxMode(true);
+        settings.SetHuffmanBlockSize(32768);
+        settings.SetHuffmanStreamsCount(1);
+        return settings;
+    }
+    static CompressorSettings FromPreset(const std::string& name) {
+        if (name == "fast") return Fast();
+        if (name == "default") return Default();
+        if (name == "max") return Max();
+        throw std::invalid_argument("CompressorSettings: Unknown preset " + name + "!");
+    }
+
+    void SetHuffmanBlockSize(const size_t size) {
+        if (size < 1 || size > UINT32_MAX) throw std::invalid_argument("CompressorSettings: Huffman block size should be in [1, 2^32 - 1]!");
+        HuffmanBlockSize_ = size;
+    }
+    void SetLZ77SearchBufferSize(const size_t size) {
+        if (size < 1 || size > MAX_LZ77_SEARCH_BUFFER_SIZE) throw std::invalid_argument("CompressorSettings: LZ77 search buffer size should be in [1, 65535]!");
+        LZ77searchBufferSize_ = size;
+    }
+    void SetRLEElementStride(const size_t stride) {
+        if (stride < 1 || stride > 4) throw std::invalid_argument("CompressorSettings: RLE element stride should be in [1, 4]!");
+        RLEElementStride_ = stride;
+    }
+    void SetHuffmanStreamsCount(const size_t count) {
+        if (count < 1 || count > 8) throw std::invalid_argument("CompressorSettings: Huffman streams count should be in [1, 8]!");
+        HuffmanStreamsCount_ = count;
+    }
+    void SetSuffixArrayThreadsCount(const size_t count) { SuffixArrayThreadsCount_ = count; }
+    void SetParallelSuffixArrayThreshold(const size_t size) { ParallelSuffixArrayThreshold_ = size; }
+    void SetBlockSize(const size_t size) { BlockSize_ = size; }
+    void SetTransposeStride(const size_t stride) {
+        if (stride < 1 || stride > 16) throw std::invalid_argument("CompressorSettings: Transpose stride should be in [1, 16]!");
+        TransposeStride_ = stride;
+    }
+    void SetImageWidth(const size_t width) {
+        if (width > UINT32_MAX) throw std::invalid_argument("CompressorSettings: Image width should be in [0, 2^32 - 1]!");
+        ImageWidth_ = width;
+    }
+    void SetImagePixelSize(const size_t size) {
+        if (size < 1 || size > 8) throw std::invalid_argument("CompressorSettings: Image pixel size should be in [1, 8]!");
+        ImagePixelSize_ = size;
+    }
+    void SetVerifyChecksums(const bool verify) { VerifyChecksums_ = verify; }
+    void SetBWTCheckpointsCount(const size_t count) {
+        if (count > MAX_BWT_CHECKPOINTS_COUNT) throw std::invalid_argument("CompressorSettings: BWT checkpoints count should be in [0, 255]!");
+        BWTCheckpointsCount_ = count;
+    }
+    void SetDedupChunkSize(const size_t size) {
+        if (size != 0 && (size < 256 || size > (1 << 22) || (size & (size - 1)) != 0)) {
+            throw std::invalid_argument("CompressorSettings: Dedup chunk size should be 0 or a power of two in [256, 2^22]!");
+        }
+        DedupChunkSize_ = size;
+    }
+    void SetSolidArchive(const bool solid) { SolidArchive_ = solid; }
+    void SetLZ77MaxMode(const bool maxMode) { LZ77MaxMode_ = maxMode; }
+    void SetMemoryBudget(const size_t bytes) { MemoryBudget_ = bytes; }
+    void SetBatchOrder(const BatchOrder order) {
+        if (order > SIMILARITY_ORDER) throw std::invalid_argument("CompressorSettings: Unknown batch order!");
+        BatchOrder_ = order;
+    }
+    size_t GetHuffmanBlockSize() const { return HuffmanBlockSize_; }
+    size_t GetLZ77SearchBufferSize() const { return LZ77searchBufferSize_; }
+    size_t GetRLEElementStride() const { return RLEElementStride_; }
+    size_t GetHuffmanStreamsCount() const { return HuffmanStreamsCount_; }
+    size_t GetSuffixArrayThreadsCount() const {
+        if (SuffixArrayThreadsCount_ > 0) return SuffixArrayThreadsCount_;
+        size_t hardwareThreads = std::thread::hardware_concurrency();
+        return (hardwareThreads > 0) ? hardwareThreads : 1;
+    }
+    size_t GetParallelSuffixArrayThreshold() const { return ParallelSuffixArrayThreshold_; }
+    size_t GetBlockSize() const { return BlockSize_; }
+    size_t GetTransposeStride() const { return TransposeStride_; }
+    size_t GetImageWidth() const { return ImageWidth_; }
+    size_t GetImagePixelSize() const { return ImagePixelSize_; }
+    bool GetVerifyChecksums() const { return VerifyChecksums_; }
+    size_t GetBWTCheckpointsCount() const { return BWTCheckpointsCount_; }
+    size_t GetDedupChunkSize() const { return DedupChunkSize_; }
+    bool GetSolidArchive() const { return SolidArchive_; }
+    BatchOrder GetBatchOrder() const { return BatchOrder_; }
+    bool GetLZ77MaxMode() const { return LZ77MaxMode_; }
+    size_t GetMemoryBudget() const { return MemoryBudget_; }
 private:
-    static size_t HuffmanBlockSize_;
-    static size_t LZ77searchBufferSize_;
-};
+    static const size_t MAX_LZ77_SEARCH_BUFFER_SIZE = 65535; // LZ77 offsets are stored in uint16_t
+    static const size_t MAX_BWT_CHECKPOINTS_COUNT = 255;
 
-// Set default values
-size_t CompressorSettings::HuffmanBlockSize_ = 10000;
-size_t CompressorSettings::LZ77searchBufferSize_ = 32768;
\ No newline at end of file
+    size_t HuffmanBlockSize_;
+    size_t LZ77searchBufferSize_;
+    size_t RLEElementStride_; // number of characters treated as one unit by RLE (3 for RGB pixels)
+    size_t HuffmanStreamsCount_; // number of interleaved bit streams in every Huffman block
+    size_t SuffixArrayThreadsCount_; // 0 - use all hardware threads
+    size_t ParallelSuffixArrayThreshold_; // BWT uses parallel suffix array for strings not shorter than this
+    size_t BlockSize_; // size of independent blocks of compressed files in bytes (0 - one block), allows range decompression
+    size_t TransposeStride_; // stride of "STRIDE+" filter (3 for RGB pixels: planes of channels are compressed one after another)
+    size_t ImageWidth_; // width of images in pixels for "PREDICT+" filter (0 - the whole block is one row)
+    size_t ImagePixelSize_; // characters per pixel for "PREDICT+" filter (3 for RGB pixels)
+    bool VerifyChecksums_; // false - skip CRC verification while decompressing (for trusted data)
+    size_t BWTCheckpointsCount_; // rows of BWT stored besides the primary index, the inverse BWT decodes count + 1 segments in parallel
+    size_t DedupChunkSize_; // average size of content-defined chunks of batch archives (0 - whole files are deduplicated)
+    bool SolidArchive_; // true - blocks of batch archives cross borders of files (small files share tables of codecs)
+    BatchOrder BatchOrder_; // order of files in batch archives
+    bool LZ77MaxMode_; // LZ77 takes the longest previous match at any distance (suffix array factorization) instead of searching the window
+    size_t MemoryBudget_; // bytes for the suffix array construction of BWT (0 - no limit), larger blocks use the low-memory construction
+};
\ No newline at end of file
@@ -1,22 +1,43 @@
 #pragma once
 
+#include <map>
+#include <filesystem>
+#include <cstring>
+
 #include "../codecs/CodecRLE.h"
+#include "../codecs/CodecZRLE.h"
 #include "../codecs/CodecMTF.h"
 #include "../codecs/CodecBWT.h"
 #include "../codecs/CodecAC.h"
 #include "../codecs/CodecHA.h"
 #include "../codecs/CodecLZ77.h"
+#include "../codecs/CodecANS.h"
 #include "../codecs/Codec_BWT_RLE.h"
 #include "../codecs/Codec_BWT_MTF_RLE_AC.h"
 #include "../codecs/Codec_BWT_MTF_AC.h"
 #include "../codecs/Codec_BWT_MTF_HA.h"
 #include "../codecs/Codec_BWT_MTF_RLE_HA.h"
+#include "../codecs/Codec_BWT_MTF_ZRLE_AC.h"
+#include "../codecs/Codec_BWT_MTF_ZRLE_HA.h"
 #include "../codecs/Codec_RLE_HA.h"
 #include "../codecs/Codec_LZ77_HA.h"
+#include "../codecs/Codec_BWT_MTF_ZRLE_ANS.h"
+#include "../codecs/Codec_LZ77_ANS.h"
 
 #include "../helpers/FileUtils.h"
 #include "../helpers/CodecUTF8.h"
 #include "../helpers/StringL.h"
+#include "../helpers/Array.h"
+#include "../helpers/CRC32C.h"
+#include "../helpers/StrideFilter.h"
+#include "../helpers/PredictiveFilter.h"
+#include "../helpers/FMIndex.h"
+#include "../helpers/ContentChunker.h"
+#include "../helpers/ChunkStore.h"
+#include "../helpers/MemoryStats.h"
+#include "../helpers/StreamBuffers.h"
+
+#include "CompressorSettings.h"
 
 typedef unsigned char char8;
 typedef unsigned short char16;
@@ -31,116 +52,783 @@ typedef unsigned int char32;
  * Details:
  * - From .txt files class reads content using utf-8, from other files class reads content by 1 byte and then saves it in string
  * - For .txt files class automatically determines the type of the string (char8, char16, char32) by maximum character in file
- * - Possible codec types: "RLE", "MTF", "BWT", "AC", "HA", "LZ77", "BWT+RLE", "BWT+MTF+RLE+AC", "BWT+MTF+AC", "BWT+MTF+HA", "BWT+MTF+RLE+HA", "RLE+HA", "LZ77+HA"
+ * - Every call takes its own CompressorSettings (presets: CompressorSettings::Fast(), Default(), Max()),
+ *   all of its parameters are recorded in the header and can be read back by ReadSettings()
+ * - Content is split into independent blocks of settings.GetBlockSize() bytes (0 - one block for the whole file), the index of blocks follows them.
+ *   A block has at most 2^32 - 1 characters (a larger whole file is split into several blocks)
+ * - Compressed file: [useUTF8][stringType if useUTF8][codec type][settings][blocks][index][footer: index offset, file CRC, index CRC, format version, magic]
+ * - Every block has CRC-32C of its encoded bytes (computed while they are written, verified on the bytes which are decoded) and of its characters, the whole content has CRC-32C of all characters
+ *   (verification can be disabled by settings.SetVerifyChecksums(false))
+ * - Possible codec types: "RLE", "MTF", "BWT", "AC", "HA", "LZ77", "BWT+RLE", "BWT+MTF+RLE+AC", "BWT+MTF+AC", "BWT+MTF+HA", "BWT+MTF+RLE+HA", "RLE+HA", "LZ77+HA", "ZRLE", "BWT+MTF+ZRLE+AC", "BWT+MTF+ZRLE+HA",
+ *   "ANS", "BWT+MTF+ZRLE+ANS", "LZ77+ANS", any of them can be preceded by filters "STRIDE+" and "PREDICT+" (see Compress())
  */
 class FileCompressor
 {
 public:
-    static void Compress(const char* inputPath, const char* outputPath, const std::string& codecType);
-    static void Decompress(const char* inputPath, const char* outputPath, const std::string& codecType);
+    // filters change the content of every block before the codec, their parameters are written before the block:
+    // "STRIDE+" transposes it with settings.GetTransposeStride() (channels of raw images become separate planes),
+    // "PREDICT+" replaces pixels by differences from PNG-style predictions (rows of settings.GetImageWidth() pixels of settings.GetImagePixelSize() characters).
+    // Filters can be combined: "STRIDE+PREDICT+HA"
+    static void Compress(const char* inputPath, const char* outputPath, const std::string& codecType, const CompressorSettings& settings = CompressorSettings());
+    static void Decompress(const char* inputPath, const char* outputPath, const std::string& codecType, const CompressorSettings& settings = CompressorSettings());
+    // compresses the file at inputPath as a delta from the file at referencePath (codec type "DELTA"): every block is encoded by Codec_LZ77_HA::EncodeDelta()
+    // which copies unchanged parts from the whole reference. The reference isn't stored, so the same reference is needed to decompress
+    // (its size and CRC-32C are checked), Decompress(), DecompressRange() and Append() reject such files
+    static void CompressDelta(const char* inputPath, const char* referencePath, const char* outputPath, const CompressorSettings& settings = CompressorSettings());
+    static void DecompressDelta(const char* inputPath, const char* referencePath, const char* outputPath, const CompressorSettings& settings = CompressorSettings());
+    // compresses the file at inputPath and appends it to the compressed file at archivePath with the parameters recorded in the header
+    // (only thread counts, the memory budget and checksum verification, which don't change the encoded data, are taken from settings).
+    // New blocks of a text file get the string type of their own characters.
+    // Old blocks aren't decoded, new blocks, index and footer are written after the old footer, the old index remains as unused bytes.
+    // If appending fails, the file is cut back to its old size. If the process is killed (or the file can't be cut), the old footer is still
+    // in the file: readers use the last footer whose index matches its CRC-32C, and the next Append() cuts the bytes after it
+    static void Append(const char* archivePath, const char* inputPath, const CompressorSettings& settings = CompressorSettings());
+    // returns bytes [offset, offset + length) of the original file (range is cut by the end of file), only blocks covering the range are decoded
+    static Array<uint8_t> DecompressRange(const char* inputPath, const size_t offset, const size_t length, const CompressorSettings& settings = CompressorSettings());
+    // returns parameters which were used to compress the file (all fields of CompressorSettings, thread counts, the memory budget
+    // and checksum verification are those of the compressing call)
+    static CompressorSettings ReadSettings(const char* inputPath);
+    // number of occurrences of the pattern (UTF-8 for text files) in a file compressed with a BWT codec: every block is decoded only up to
+    // its BWT string, the inverse BWT is replaced by an FMIndex of the block. Occurrences which cross borders of blocks aren't found
+    static uint64_t Count(const char* inputPath, const std::string& pattern, const CompressorSettings& settings = CompressorSettings());
+    // positions of occurrences in ascending order (in characters of the content: bytes for binary files, code points for text files)
+    static Array<uint64_t> Locate(const char* inputPath, const std::string& pattern, const CompressorSettings& settings = CompressorSettings());
+    // compresses files into one archive with codec type "BATCH+" + codecType (files are stored by their names without directories).
+    // Files are read as bytes and split by ContentChunker into chunks of about settings.GetDedupChunkSize() bytes, a chunk equal to an already stored one
+    // (ChunkStore) is kept as a reference, so only new chunks are encoded. New chunks of every file form its own blocks, in solid mode
+    // (settings.SetSolidArchive(true)) new chunks of all files are one stream split only by the block size, so small files share tables of entropy coders
+    // and the LZ77 window. Files are ordered by settings.GetBatchOrder().
+    // Archive: [header][file table: names, sizes, CRC-32C and chunk ids of files; offsets and sizes of chunks][blocks][index][footer]
+    static void CompressBatch(const Array<std::string>& inputPaths, const char* outputPath, const std::string& codecType, const CompressorSettings& settings = CompressorSettings());
+    // decompresses all files of the archive into outputDirectory
+    static void DecompressBatch(const char* inputPath, const char* outputDirectory, const CompressorSettings& settings = CompressorSettings());
+    // decompresses one file of the archive to outputPath (only blocks holding its chunks are decoded, chunks may cross borders of blocks)
+    static void ExtractFromBatch(const char* inputPath, const std::string& fileName, const char* outputPath, const CompressorSettings& settings = CompressorSettings());
+    // names of files in the archive
+    static Array<std::string> ListBatch(const char* inputPath);
+    // opt-in accounting of memory allocated by Array / StringL / BitArray (off by default) for all following calls: every block is encoded
+    // in the stage "encode <codec type>" and decoded in the stage "decode <codec type>" (filters are enclosing stages of their inner codec types),
+    // codecs can mark their own stages ("BWT suffix array"). Peaks of stages can be compared with per-codec memory budgets
+    static void EnableMemoryStats(const bool enable);
+    // counters since the last ResetMemoryStats() (or the start of the program): numbers of allocations and deep copies,
+    // allocated and peak live bytes, allocations and peaks of stages
+    static MemoryStats::report GetMemoryStats();
+    static void ResetMemoryStats();
 private:
     FileCompressor() = default;
 
+    static const uint32_t CONTAINER_MAGIC = 0x4B4C4246; // "FBLK"
+    static const uint8_t FORMAT_VERSION = 1; // version of the layout of the header, the index and the footer
+    static const uint32_t MAX_BATCH_NAME_LENGTH = 65535;
+    static const size_t SIMILARITY_SAMPLE_SIZE = 1 << 16; // bytes of the beginning of a file in its histogram
+    static const size_t MAX_SIMILARITY_GROUP = 1024; // larger groups of files with one extension stay in order of names
+    static const size_t MAX_BLOCK_CHARS = UINT32_MAX; // codecs and the index store numbers of characters in uint32_t
+    static const uint64_t INDEX_ENTRY_SIZE = 4 * sizeof(uint64_t) + 3 * sizeof(uint32_t) + sizeof(uint8_t);
+    static const uint64_t FOOTER_SIZE = sizeof(uint64_t) + 3 * sizeof(uint32_t) + sizeof(uint8_t);
+    static const uint64_t FOOTER_SCAN_CHUNK_SIZE = 1 << 16; // bytes read at once while looking for the last valid footer
+
+    struct blockInfo {
+        uint64_t rawOffset; // offset of the block in the original file (in bytes)
+        uint64_t rawSize; // size of the block in the original file (in bytes)
+        uint64_t compressedOffset; // offset of the encoded block in the compressed file
+        uint64_t compressedSize; // size of the encoded block
+        uint32_t charsCount; // number of characters in the block
+        uint32_t crc; // CRC-32C of characters of the block
+        uint32_t compressedCrc; // CRC-32C of the encoded block
+        uint8_t stringType; // 8, 16 or 32 (blocks added by Append() can have another string type than the header)
+        blockInfo() = default;
+        blockInfo(const uint64_t _rawOffset, const uint64_t _rawSize, const uint64_t _compressedOffset, const uint32_t _charsCount, const uint32_t _crc,
+                  const uint8_t _stringType) :
+            rawOffset(_rawOffset), rawSize(_rawSize), compressedOffset(_compressedOffset), compressedSize(0), charsCount(_charsCount), crc(_crc), compressedCrc(0),
+            stringType(_stringType) {}
+    };
+    struct containerInfo {
+        bool useUTF8;
+        uint8_t stringType; // 8, 16 or 32 (string type of the compressed file and of its reference)
+        std::string codecType;
+        CompressorSettings settings; // settings of the encoder
+        Array<blockInfo> blocks;
+        uint32_t crc; // CRC-32C of all characters
+        uint64_t headerEnd; // offset after the header
+        uint64_t end; // offset after the footer (bytes after it are left by an interrupted Append())
+    };
+    struct batchFile {
+        std::string name;
+        uint64_t size;
+        uint32_t crc; // CRC-32C of the content
+        Array<uint32_t> chunks; // ids of chunks in order of the content
+    };
+    struct batchTable {
+        Array<batchFile> files;
+        Array<uint64_t> chunkOffsets; // offsets of chunks in the content of blocks
+        Array<uint32_t> chunkSizes;
+    };
+
+    // referencePath - reference of DELTA codec (nullptr for other codecs)
+    static void compressFile(const char* inputPath, const char* outputPath, const std::string& codecType, const CompressorSettings& settings, const char* referencePath);
+    template <typename charType>
+    static void compress(const char* inputPath, std::ofstream& outputFile, const std::string& codecType, const bool useUTF8, const CompressorSettings& settings,
+                         Array<blockInfo>& blocks, uint32_t& fileCrc, const char* referencePath = nullptr);
+    // encodes characters [begin, end) of inputStr as blocks, rawOffset - offset of inputStr[begin] in the original content (in bytes)
+    template <typename charType>
+    static void encodeBlocks(StringL<charType>& inputStr, const size_t begin, const size_t end, const uint64_t rawOffset, std::ofstream& outputFile,
+                             const std::string& codecType, const bool useUTF8, const CompressorSettings& settings, Array<blockInfo>& blocks, uint32_t& fileCrc,
+                             const StringL<charType>* reference = nullptr);
+    template <typename charType>
+    static void decompress(std::ifstream& inputFile, const char* outputPath, const containerInfo& info, const CompressorSettings& settings, const char* referencePath = nullptr);
+    // decodes the block as a string of charType (its string type), appends it to outputFile and continues fileCrc with its characters
+    template <typename charType>
+    static void decompressBlock(std::ifstream& inputFile, std::ofstream& outputFile, const containerInfo& info, const blockInfo& block, const bool verifyChecksums,
+                                uint32_t& fileCrc, const StringL<charType>* reference = nullptr);
+    static Array<uint8_t> decompressRange(std::ifstream& inputFile, const containerInfo& info, const uint64_t begin, const uint64_t end, const CompressorSettings& settings);
+    // bytes of the block in the original file
+    template <typename charType>
+    static std::string decodeBlockBytes(std::ifstream& inputFile, const containerInfo& info, const blockInfo& block, const bool verifyChecksums);
+
+    template <typename charType>
+    static void encodeString(StringL<charType>& inputStr, std::ofstream& outputFile, const std::string& codecType, const bool useUTF8, const CompressorSettings& settings,
+                             const StringL<charType>* reference = nullptr);
+    template <typename charType>
+    static StringL<charType> decodeString(std::ifstream& inputFile, const std::string& codecType, const bool useUTF8, const StringL<charType>* reference = nullptr);
+    template <typename charType>
+    static StringL<charType> decodeBlock(std::ifstream& inputFile, const containerInfo& info, const blockInfo& block, const bool verifyChecksums,
+                                         const StringL<charType>* reference = nullptr);
+
+    // search in every block, positions are collected only if they are given
+    static uint64_t search(std::ifstream& inputFile, const containerInfo& info, const std::string& pattern, const bool verifyChecksums, Array<uint64_t>* positions);
+    // search in blocks [firstBlock, lastBlock) of string type charType, charsOffset - number of characters before firstBlock
+    template <typename charType>
+    static uint64_t searchBlocks(std::ifstream& inputFile, const containerInfo& info, const size_t firstBlock, const size_t lastBlock, const std::string& pattern,
+                                 const bool verifyChecksums, uint64_t charsOffset, Array<uint64_t>* positions);
     template <typename charType>
-    static void compress(const char* inputPath, std::ofstream& outputFile, const std::string& codecType, const bool useUTF8);
+    static StringL<charType> decodeBWTString(std::ifstream& inputFile, const std::string& codecType, const bool useUTF8, uint32_t& index);
+    // false - the pattern has characters which don't fit into charType (so it can't occur)
     template <typename charType>
-    static void decompress(std::ifstream& inputFile, const char* outputPath, const std::string& codecType, const bool useUTF8);
+    static bool patternToStringL(const std::string& pattern, const bool useUTF8, StringL<charType>& result);
+
+    static bool stripFilterPrefix(const std::string& codecType, const std::string& prefix, std::string& innerCodecType);
+
+    // reads the header and the file table of a batch archive, info gets codec type of blocks
+    static batchTable readBatch(std::ifstream& inputFile, containerInfo& info);
+    static void writeBatchTable(std::ofstream& outputFile, const batchTable& table);
+    // indices of inputPaths in order of files in the archive: as given, by extensions and names, or by extensions and similarity
+    // (greedy chain of the nearest byte histograms of their beginnings)
+    static Array<size_t> orderBatchFiles(const Array<std::string>& inputPaths, const CompressorSettings::BatchOrder order);
+    // decodedBlocks - blocks decoded by previous calls (new decoded blocks are added)
+    static void extractBatchFile(std::ifstream& inputFile, const containerInfo& info, const batchTable& table, const size_t fileIndex, const std::string& outputPath,
+                                 const bool verifyChecksums, std::map<size_t, StringL<char8>>& decodedBlocks);
+    static void writeSettings(std::ofstream& outputFile, const CompressorSettings& settings);
+    static CompressorSettings readSettings(std::ifstream& inputFile);
+    static void writeIndex(std::ofstream& outputFile, const Array<blockInfo>& blocks, const uint32_t crc);
+    // reads the footer which ends at footerEnd and the index before it into info, false - they aren't a valid footer and index
+    static bool readIndex(std::ifstream& inputFile, const uint64_t footerEnd, containerInfo& info);
+    // reads the encoded block into encoded (of block.compressedSize bytes) and verifies its CRC, the decoder then reads the same bytes
+    static void readEncodedBlock(std::ifstream& inputFile, const blockInfo& block, const bool verifyChecksums, Array<char>& encoded);
+    static uint8_t getStringTypeBits(const std::string& stringType);
+    static containerInfo readContainerInfo(std::ifstream& inputFile);
 
     template <typename charType>
     static void writeStringLToFile(const char* outputPath, const StringL<charType>& str, const bool useUTF8);
     template <typename charType>
+    static void appendStringLToFile(std::ofstream& outputFile, const StringL<charType>& str, const bool useUTF8);
+    template <typename charType>
     static StringL<charType> readContentToStringL(const char* filepath, const bool useUTF8);
     static const std::string checkStringType(const char* filepath);
 };
 
-void FileCompressor::Compress(const char* inputPath, const char* outputPath, const std::string& codecType)
+void FileCompressor::Compress(const char* inputPath, const char* outputPath, const std::string& codecType, const CompressorSettings& settings)
+{
+    compressFile(inputPath, outputPath, codecType, settings, nullptr);
+}
+
+void FileCompressor::CompressDelta(const char* inputPath, const char* referencePath, const char* outputPath, const CompressorSettings& settings)
+{
+    compressFile(inputPath, outputPath, "DELTA", settings, referencePath);
+}
+
+void FileCompressor::compressFile(const char* inputPath, const char* outputPath, const std::string& codecType, const CompressorSettings& settings, const char* referencePath)
 {
     bool useUTF8 = FileUtils::IsTextFile(inputPath) ? true : false;
 
+    std::string stringType = useUTF8 ? checkStringType(inputPath) : "string8";
+    // the reference is read with the same string type (it is used as a part of the content)
+    if (useUTF8 && referencePath) {
+        const std::string referenceType = checkStringType(referencePath);
+        if (getStringTypeBits(referenceType) > getStringTypeBits(stringType)) {
+            stringType = referenceType;
+        }
+    }
+
     std::ofstream outputFile = FileUtils::OpenFileBinaryWrite(outputPath);
     FileUtils::AppendValueBinary(outputFile, useUTF8);
-
     if (useUTF8) {
-        std::string stringType = checkStringType(inputPath);
-        if (stringType == "string8") {
-            FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(8));
-            compress<char8>(inputPath, outputFile, codecType, useUTF8);
-        } else if (stringType == "string16") {
-            FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(16));
-            compress<char16>(inputPath, outputFile, codecType, useUTF8);
-        } else {
-            FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(32));
-            compress<char32>(inputPath, outputFile, codecType, useUTF8);
-        }
+        FileUtils::AppendValueBinary(outputFile, getStringTypeBits(stringType));
+    }
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(codecType.size()));
+    outputFile.write(codecType.c_str(), codecType.size());
+    writeSettings(outputFile, settings);
+
+    Array<blockInfo> blocks;
+    uint32_t fileCrc = 0;
+
+    if (stringType == "string8") {
+        compress<char8>(inputPath, outputFile, codecType, useUTF8, settings, blocks, fileCrc, referencePath);
+    } else if (stringType == "string16") {
+        compress<char16>(inputPath, outputFile, codecType, useUTF8, settings, blocks, fileCrc, referencePath);
     } else {
-        compress<char8>(inputPath, outputFile, codecType, useUTF8);
+        compress<char32>(inputPath, outputFile, codecType, useUTF8, settings, blocks, fileCrc, referencePath);
     }
 
+    writeIndex(outputFile, blocks, fileCrc);
     FileUtils::CloseFile(outputFile);
 }
 
-void FileCompressor::Decompress(const char* inputPath, const char* outputPath, const std::string& codecType)
+void FileCompressor::Append(const char* archivePath, const char* inputPath, const CompressorSettings& settings)
 {
-    std::ifstream inputFile = FileUtils::OpenFileBinaryRead(inputPath);
-    
-    bool useUTF8 = FileUtils::ReadValueBinary<bool>(inputFile);
+    std::ifstream archiveFile = FileUtils::OpenFileBinaryRead(archivePath);
+    containerInfo info = readContainerInfo(archiveFile);
+    FileUtils::CloseFile(archiveFile);
+    const size_t archiveSize = static_cast<size_t>(info.end);
+    if (FileUtils::FileSize(archivePath) != archiveSize) {
+        // bytes of an interrupted Append() after the last valid footer
+        FileUtils::TruncateFile(archivePath, archiveSize);
+    }
 
-    if (useUTF8) {
-        uint8_t stringType = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+    // the content is read in the same way as the content of the archive, but with its own string type
+    // (the index keeps the string type of every block, so a wide character can be appended to an ASCII file)
+    if (FileUtils::FileSize(inputPath) == 0) {
+        return;
+    }
+
+    // new blocks are encoded as the old ones, parameters which don't change the encoded data belong to this call
+    CompressorSettings appendSettings = info.settings;
+    appendSettings.SetSuffixArrayThreadsCount(settings.GetSuffixArrayThreadsCount());
+    appendSettings.SetParallelSuffixArrayThreshold(settings.GetParallelSuffixArrayThreshold());
+    appendSettings.SetMemoryBudget(settings.GetMemoryBudget());
+    appendSettings.SetVerifyChecksums(settings.GetVerifyChecksums());
 
+    uint64_t rawSize = 0;
+    if (info.blocks.size() > 0) {
+        rawSize = info.blocks[info.blocks.size() - 1].rawOffset + info.blocks[info.blocks.size() - 1].rawSize;
+    }
+
+    std::ofstream outputFile = FileUtils::OpenFileBinaryAppend(archivePath);
+    try {
+        Array<blockInfo> newBlocks;
+        uint32_t fileCrc = info.crc;
+        const uint8_t stringType = info.useUTF8 ? getStringTypeBits(checkStringType(inputPath)) : 8;
         if (stringType == 8) {
-            decompress<char8>(inputFile, outputPath, codecType, useUTF8);
+            compress<char8>(inputPath, outputFile, info.codecType, info.useUTF8, appendSettings, newBlocks, fileCrc);
         } else if (stringType == 16) {
-            decompress<char16>(inputFile, outputPath, codecType, useUTF8);
+            compress<char16>(inputPath, outputFile, info.codecType, info.useUTF8, appendSettings, newBlocks, fileCrc);
         } else {
-            decompress<char32>(inputFile, outputPath, codecType, useUTF8);
+            compress<char32>(inputPath, outputFile, info.codecType, info.useUTF8, appendSettings, newBlocks, fileCrc);
+        }
+        for (blockInfo& block : newBlocks) {
+            block.rawOffset += rawSize;
+            info.blocks.push_back(block);
         }
+
+        writeIndex(outputFile, info.blocks, fileCrc);
+        outputFile.flush();
+        if (!outputFile) {
+            throw std::runtime_error("FileCompressor: Failed to write to " + std::string(archivePath));
+        }
+    } catch (...) {
+        // the old index and footer are untouched, cutting new bytes restores the file
+        FileUtils::CloseFile(outputFile);
+        FileUtils::TruncateFile(archivePath, archiveSize);
+        throw;
+    }
+    FileUtils::CloseFile(outputFile);
+}
+
+void FileCompressor::Decompress(const char* inputPath, const char* outputPath, const std::string& codecType, const CompressorSettings& settings)
+{
+    std::ifstream inputFile = FileUtils::OpenFileBinaryRead(inputPath);
+    
+    containerInfo info = readContainerInfo(inputFile);
+    if (info.codecType != codecType) {
+        FileUtils::CloseFile(inputFile);
+        throw std::invalid_argument("File was compressed with codec type " + info.codecType + ", not " + codecType);
+    }
+    if (info.codecType == "DELTA") {
+        FileUtils::CloseFile(inputFile);
+        throw std::invalid_argument("FileCompressor: DELTA file needs the reference file (use DecompressDelta)");
+    }
+    std::string innerCodecType;
+    if (stripFilterPrefix(info.codecType, "BATCH+", innerCodecType)) {
+        FileUtils::CloseFile(inputFile);
+        throw std::invalid_argument("FileCompressor: File is a batch archive (use DecompressBatch)");
+    }
+
+    if (info.stringType == 8) {
+        decompress<char8>(inputFile, outputPath, info, settings);
+    } else if (info.stringType == 16) {
+        decompress<char16>(inputFile, outputPath, info, settings);
+    } else {
+        decompress<char32>(inputFile, outputPath, info, settings);
+    }
+
+    FileUtils::CloseFile(inputFile);
+}
+
+void FileCompressor::DecompressDelta(const char* inputPath, const char* referencePath, const char* outputPath, const CompressorSettings& settings)
+{
+    std::ifstream inputFile = FileUtils::OpenFileBinaryRead(inputPath);
+
+    containerInfo info = readContainerInfo(inputFile);
+    if (info.codecType != "DELTA") {
+        FileUtils::CloseFile(inputFile);
+        throw std::invalid_argument("File was compressed with codec type " + info.codecType + ", not DELTA");
+    }
+
+    if (info.stringType == 8) {
+        decompress<char8>(inputFile, outputPath, info, settings, referencePath);
+    } else if (info.stringType == 16) {
+        decompress<char16>(inputFile, outputPath, info, settings, referencePath);
     } else {
-        decompress<char8>(inputFile, outputPath, codecType, useUTF8);
+        decompress<char32>(inputFile, outputPath, info, settings, referencePath);
     }
 
     FileUtils::CloseFile(inputFile);
 }
 
+Array<uint8_t> FileCompressor::DecompressRange(const char* inputPath, const size_t offset, const size_t length, const CompressorSettings& settings)
+{
+    std::ifstream inputFile = FileUtils::OpenFileBinaryRead(inputPath);
+
+    containerInfo info = readContainerInfo(inputFile);
+    uint64_t fileSize = 0;
+    if (info.blocks.size() > 0) {
+        fileSize = info.blocks[info.blocks.size() - 1].rawOffset + info.blocks[info.blocks.size() - 1].rawSize;
+    }
+    uint64_t begin = std::min<uint64_t>(offset, fileSize);
+    uint64_t end = std::min<uint64_t>(begin + length, fileSize);
+
+    Array<uint8_t> result = decompressRange(inputFile, info, begin, end, settings);
+
+    FileUtils::CloseFile(inputFile);
+    return result;
+}
+
+CompressorSettings FileCompressor::ReadSettings(const char* inputPath)
+{
+    std::ifstream inputFile = FileUtils::OpenFileBinaryRead(inputPath);
+    containerInfo info = readContainerInfo(inputFile);
+    FileUtils::CloseFile(inputFile);
+    return info.settings;
+}
+
+uint64_t FileCompressor::Count(const char* inputPath, const std::string& pattern, const CompressorSettings& settings)
+{
+    std::ifstream inputFile = FileUtils::OpenFileBinaryRead(inputPath);
+
+    containerInfo info = readContainerInfo(inputFile);
+    uint64_t count = search(inputFile, info, pattern, settings.GetVerifyChecksums(), nullptr);
+
+    FileUtils::CloseFile(inputFile);
+    return count;
+}
+
+Array<uint64_t> FileCompressor::Locate(const char* inputPath, const std::string& pattern, const CompressorSettings& settings)
+{
+    std::ifstream inputFile = FileUtils::OpenFileBinaryRead(inputPath);
+
+    containerInfo info = readContainerInfo(inputFile);
+    Array<uint64_t> positions;
+    search(inputFile, info, pattern, settings.GetVerifyChecksums(), &positions);
+
+    FileUtils::CloseFile(inputFile);
+    return positions;
+}
+
+void FileCompressor::CompressBatch(const Array<std::string>& inputPaths, const char* outputPath, const std::string& codecType, const CompressorSettings& settings)
+{
+    // content of blocks (new chunks of all files) and the file table
+    batchTable table;
+    StringL<char8> content;
+    Array<size_t> contentEnds; // end of new chunks of every file
+    ChunkStore store;
+    Array<size_t> chunkEnds;
+    for (const size_t& index : orderBatchFiles(inputPaths, settings.GetBatchOrder())) {
+        const std::string& path = inputPaths[index];
+        batchFile file;
+        file.name = std::filesystem::path(path).filename().string();
+        if (file.name.empty() || file.name.size() > MAX_BATCH_NAME_LENGTH) {
+            throw std::invalid_argument("FileCompressor: Invalid file name " + path);
+        }
+        for (const batchFile& other : table.files) {
+            if (other.name == file.name) {
+                throw std::invalid_argument("FileCompressor: Batch has two files with name " + file.name);
+            }
+        }
+
+        StringL<char8> data = readContentToStringL<char8>(path.c_str(), false);
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.c_str());
+        file.size = data.size();
+        file.crc = CRC32C::Compute(bytes, data.size());
+
+        ContentChunker::Split(bytes, data.size(), settings.GetDedupChunkSize(), chunkEnds);
+        size_t chunkBegin = 0;
+        for (const size_t& chunkEnd : chunkEnds) {
+            bool isNew;
+            const uint32_t id = store.FindOrAdd(bytes + chunkBegin, chunkEnd - chunkBegin, reinterpret_cast<const uint8_t*>(content.c_str()), content.size(), isNew);
+            if (isNew) {
+                for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+                    content.push_back(data[i]);
+                }
+            }
+            file.chunks.push_back(id);
+            chunkBegin = chunkEnd;
+        }
+        contentEnds.push_back(content.size());
+        table.files.push_back(file);
+    }
+    for (uint32_t id = 0; id < store.Size(); ++id) {
+        table.chunkOffsets.push_back(store.GetOffset(id));
+        table.chunkSizes.push_back(store.GetSize(id));
+    }
+
+    std::ofstream outputFile = FileUtils::OpenFileBinaryWrite(outputPath);
+    const std::string batchCodecType = "BATCH+" + codecType;
+    FileUtils::AppendValueBinary(outputFile, false);
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(batchCodecType.size()));
+    outputFile.write(batchCodecType.c_str(), batchCodecType.size());
+    writeSettings(outputFile, settings);
+    writeBatchTable(outputFile, table);
+
+    // not solid: blocks don't cross borders of files, so a file is extracted by its own blocks (and blocks of its duplicate chunks)
+    Array<blockInfo> blocks;
+    uint32_t contentCrc = 0;
+    if (settings.GetSolidArchive()) {
+        encodeBlocks(content, 0, content.size(), 0, outputFile, codecType, false, settings, blocks, contentCrc);
+    } else {
+        size_t begin = 0;
+        for (const size_t& end : contentEnds) {
+            encodeBlocks(content, begin, end, begin, outputFile, codecType, false, settings, blocks, contentCrc);
+            begin = end;
+        }
+    }
+
+    writeIndex(outputFile, blocks, contentCrc);
+    FileUtils::CloseFile(outputFile);
+}
+
+void FileCompressor::DecompressBatch(const char* inputPath, const char* outputDirectory, const CompressorSettings& settings)
+{
+    std::ifstream inputFile = FileUtils::OpenFileBinaryRead(inputPath);
+    containerInfo info = readContainerInfo(inputFile);
+    const batchTable table = readBatch(inputFile, info);
+
+    // every block is decoded once (duplicate chunks of later files refer to blocks of earlier files)
+    std::map<size_t, StringL<char8>> decodedBlocks;
+    for (size_t i = 0; i < table.files.size(); ++i) {
+        const std::string outputPath = (std::filesystem::path(outputDirectory) / table.files[i].name).string();
+        extractBatchFile(inputFile, info, table, i, outputPath, settings.GetVerifyChecksums(), decodedBlocks);
+    }
+
+    FileUtils::CloseFile(inputFile);
+}
+
+void FileCompressor::ExtractFromBatch(const char* inputPath, const std::string& fileName, const char* outputPath, const CompressorSettings& settings)
+{
+    std::ifstream inputFile = FileUtils::OpenFileBinaryRead(inputPath);
+    containerInfo info = readContainerInfo(inputFile);
+    const batchTable table = readBatch(inputFile, info);
+
+    for (size_t i = 0; i < table.files.size(); ++i) {
+        if (table.files[i].name == fileName) {
+            std::map<size_t, StringL<char8>> decodedBlocks;
+            extractBatchFile(inputFile, info, table, i, outputPath, settings.GetVerifyChecksums(), decodedBlocks);
+            FileUtils::CloseFile(inputFile);
+            return;
+        }
+    }
+    FileUtils::CloseFile(inputFile);
+    throw std::invalid_argument("FileCompressor: Batch archive has no file " + fileName);
+}
+
+void FileCompressor::EnableMemoryStats(const bool enable)
+{
+    MemoryStats::Enable(enable);
+}
+
+MemoryStats::report FileCompressor::GetMemoryStats()
+{
+    return MemoryStats::GetReport();
+}
+
+void FileCompressor::ResetMemoryStats()
+{
+    MemoryStats::Reset();
+}
+
+Array<std::string> FileCompressor::ListBatch(const char* inputPath)
+{
+    std::ifstream inputFile = FileUtils::OpenFileBinaryRead(inputPath);
+    containerInfo info = readContainerInfo(inputFile);
+    const batchTable table = readBatch(inputFile, info);
+    FileUtils::CloseFile(inputFile);
+
+    Array<std::string> names(table.files.size());
+    for (const batchFile& file : table.files) {
+        names.push_back(file.name);
+    }
+    return names;
+}
+
 template <typename charType>
-void FileCompressor::compress(const char* inputPath, std::ofstream& outputFile, const std::string& codecType, const bool useUTF8)
+void FileCompressor::compress(const char* inputPath, std::ofstream& outputFile, const std::string& codecType, const bool useUTF8, const CompressorSettings& settings,
+                              Array<blockInfo>& blocks, uint32_t& fileCrc, const char* referencePath)
 {
     StringL<charType> inputStr = readContentToStringL<charType>(inputPath, useUTF8);
+    StringL<charType> reference;
+    if (referencePath) {
+        reference = readContentToStringL<charType>(referencePath, useUTF8);
+    }
+    encodeBlocks(inputStr, 0, inputStr.size(), 0, outputFile, codecType, useUTF8, settings, blocks, fileCrc, referencePath ? &reference : nullptr);
+}
+
+template <typename charType>
+void FileCompressor::encodeBlocks(StringL<charType>& inputStr, const size_t begin, const size_t end, const uint64_t rawOffset, std::ofstream& outputFile,
+                                  const std::string& codecType, const bool useUTF8, const CompressorSettings& settings, Array<blockInfo>& blocks, uint32_t& fileCrc,
+                                  const StringL<charType>* reference)
+{
+    const size_t blockSize = settings.GetBlockSize();
+    size_t charPointer = begin; // beginning of the current block within inputStr
+    uint64_t blockOffset = rawOffset;
+
+    while (charPointer < end) {
+        // find the end of the block (blocks don't split characters and have at most MAX_BLOCK_CHARS characters)
+        size_t blockEnd = charPointer;
+        uint64_t rawSize = 0;
+        while (blockEnd < end && (blockSize == 0 || rawSize < blockSize) && blockEnd - charPointer < MAX_BLOCK_CHARS) {
+            rawSize += useUTF8 ? CodecUTF8::GetEncodedCharLength(inputStr[blockEnd]) : sizeof(charType);
+            ++blockEnd;
+        }
+
+        const charType* blockChars = inputStr.c_str() + charPointer;
+        const size_t blockBytes = (blockEnd - charPointer) * sizeof(charType);
+        uint32_t blockCrc = CRC32C::Compute(blockChars, blockBytes);
+        fileCrc = CRC32C::Compute(blockChars, blockBytes, fileCrc);
+
+        blocks.push_back(blockInfo(blockOffset, rawSize, static_cast<uint64_t>(outputFile.tellp()), static_cast<uint32_t>(blockEnd - charPointer), blockCrc,
+                                 static_cast<uint8_t>(sizeof(charType) * 8)));
+        {
+            // CRC of the encoded block is computed from the bytes of the codec on their way to the file
+            CRC32CStreamBuffer crcBuffer(outputFile.rdbuf());
+            StreamBufferSwap bufferSwap(outputFile, &crcBuffer);
+            if (charPointer == 0 && blockEnd == inputStr.size()) {
+                encodeString(inputStr, outputFile, codecType, useUTF8, settings, reference); // the only block, don't copy the string
+            } else {
+                StringL<charType> blockStr = inputStr.substr(charPointer, blockEnd - charPointer);
+                encodeString(blockStr, outputFile, codecType, useUTF8, settings, reference);
+            }
+            if (!crcBuffer.Good()) {
+                throw std::runtime_error("FileCompressor: Failed to write the compressed file!");
+            }
+            blocks[blocks.size() - 1].compressedCrc = crcBuffer.GetCrc();
+        }
+        blocks[blocks.size() - 1].compressedSize = static_cast<uint64_t>(outputFile.tellp()) - blocks[blocks.size() - 1].compressedOffset;
+
+        charPointer = blockEnd;
+        blockOffset += rawSize;
+    }
+}
+
+template <typename charType>
+void FileCompressor::decompress(std::ifstream& inputFile, const char* outputPath, const containerInfo& info, const CompressorSettings& settings, const char* referencePath)
+{
+    StringL<charType> reference;
+    if (referencePath) {
+        reference = readContentToStringL<charType>(referencePath, info.useUTF8);
+    }
+    std::ofstream outputFile = FileUtils::OpenFileBinaryWrite(outputPath);
+
+    uint32_t fileCrc = 0;
+    for (const blockInfo& block : info.blocks) {
+        // only blocks of the string type of the file use the reference (DELTA files can't be appended to)
+        if (block.stringType == sizeof(charType) * 8) {
+            decompressBlock<charType>(inputFile, outputFile, info, block, settings.GetVerifyChecksums(), fileCrc, referencePath ? &reference : nullptr);
+        } else if (block.stringType == 8) {
+            decompressBlock<char8>(inputFile, outputFile, info, block, settings.GetVerifyChecksums(), fileCrc);
+        } else if (block.stringType == 16) {
+            decompressBlock<char16>(inputFile, outputFile, info, block, settings.GetVerifyChecksums(), fileCrc);
+        } else {
+            decompressBlock<char32>(inputFile, outputFile, info, block, settings.GetVerifyChecksums(), fileCrc);
+        }
+    }
+
+    FileUtils::CloseFile(outputFile);
+    if (settings.GetVerifyChecksums() && fileCrc != info.crc) {
+        throw std::runtime_error("FileCompressor: Checksum mismatch, file is corrupted!");
+    }
+}
+
+template <typename charType>
+void FileCompressor::decompressBlock(std::ifstream& inputFile, std::ofstream& outputFile, const containerInfo& info, const blockInfo& block, const bool verifyChecksums,
+                                     uint32_t& fileCrc, const StringL<charType>* reference)
+{
+    StringL<charType> decodedStr = decodeBlock<charType>(inputFile, info, block, verifyChecksums, reference);
+    if (verifyChecksums) {
+        fileCrc = CRC32C::Compute(decodedStr.c_str(), decodedStr.size() * sizeof(charType), fileCrc);
+    }
+    appendStringLToFile(outputFile, decodedStr, info.useUTF8);
+}
+
+Array<uint8_t> FileCompressor::decompressRange(std::ifstream& inputFile, const containerInfo& info, const uint64_t begin, const uint64_t end, const CompressorSettings& settings)
+{
+    Array<uint8_t> result(end - begin);
+
+    for (const blockInfo& block : info.blocks) {
+        // skip blocks which don't cover the range
+        if (block.rawOffset + block.rawSize <= begin || block.rawOffset >= end) continue;
+
+        std::string blockBytes;
+        if (block.stringType == 8) {
+            blockBytes = decodeBlockBytes<char8>(inputFile, info, block, settings.GetVerifyChecksums());
+        } else if (block.stringType == 16) {
+            blockBytes = decodeBlockBytes<char16>(inputFile, info, block, settings.GetVerifyChecksums());
+        } else {
+            blockBytes = decodeBlockBytes<char32>(inputFile, info, block, settings.GetVerifyChecksums());
+        }
+
+        // copy the part of the block which is in the range
+        uint64_t from = std::max(begin, block.rawOffset) - block.rawOffset;
+        uint64_t to = std::min(end, block.rawOffset + block.rawSize) - block.rawOffset;
+        for (uint64_t i = from; i < to; ++i) {
+            result.push_back(static_cast<uint8_t>(blockBytes[i]));
+        }
+    }
+
+    return result;
+}
+
+template <typename charType>
+std::string FileCompressor::decodeBlockBytes(std::ifstream& inputFile, const containerInfo& info, const blockInfo& block, const bool verifyChecksums)
+{
+    StringL<charType> decodedStr = decodeBlock<charType>(inputFile, info, block, verifyChecksums);
+
+    std::string blockBytes;
+    if (info.useUTF8) {
+        blockBytes.reserve(block.rawSize);
+        for (const charType& c : decodedStr)
+            CodecUTF8::EncodeCharToString(blockBytes, c);
+    } else {
+        blockBytes.assign(reinterpret_cast<const char*>(decodedStr.c_str()), decodedStr.size() * sizeof(charType));
+    }
+    return blockBytes;
+}
+
+template <typename charType>
+void FileCompressor::encodeString(StringL<charType>& inputStr, std::ofstream& outputFile, const std::string& codecType, const bool useUTF8, const CompressorSettings& settings,
+                                  const StringL<charType>* reference)
+{
+    MemoryStats::Scope scope(MemoryStats::IsEnabled() ? "encode " + codecType : std::string());
+    std::string innerCodecType;
+    if (stripFilterPrefix(codecType, "STRIDE+", innerCodecType)) {
+        // write the stride, then encode planes with the rest of the chain
+        FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(settings.GetTransposeStride()));
+        StringL<charType> transposedStr = StrideFilter::Transpose(inputStr, settings.GetTransposeStride());
+        encodeString(transposedStr, outputFile, innerCodecType, useUTF8, settings, reference);
+        return;
+    }
+    if (stripFilterPrefix(codecType, "PREDICT+", innerCodecType)) {
+        // write sizes of rows and pixels and filters of rows, then encode differences with the rest of the chain
+        const size_t pixelSize = settings.GetImagePixelSize();
+        const size_t rowSize = (settings.GetImageWidth() > 0) ? settings.GetImageWidth() * pixelSize : std::max<size_t>(inputStr.size(), 1);
+        if (rowSize > UINT32_MAX) {
+            throw std::invalid_argument("FileCompressor: Row of the image is too long!");
+        }
+        Array<uint8_t> rowFilters;
+        StringL<charType> differences = PredictiveFilter::Encode(inputStr, rowSize, pixelSize, rowFilters);
+        FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(rowSize));
+        FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(pixelSize));
+        FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(rowFilters.size()));
+        outputFile.write(reinterpret_cast<const char*>(rowFilters.c_arr()), rowFilters.size());
+        // differences wrap around charType, they aren't code points, so the rest of the chain writes them without UTF-8
+        encodeString(differences, outputFile, innerCodecType, false, settings, reference);
+        return;
+    }
 
     if (codecType == "RLE") {
-        CodecRLE<charType>::Encode(inputStr, outputFile, useUTF8);
+        CodecRLE<charType>::Encode(inputStr, outputFile, useUTF8, settings);
     } else if (codecType == "MTF") {
         CodecMTF<charType>::Encode(inputStr, outputFile, useUTF8);
     } else if (codecType == "BWT") {
-        CodecBWT<charType>::Encode(inputStr, outputFile, useUTF8);
+        CodecBWT<charType>::Encode(inputStr, outputFile, useUTF8, settings);
     } else if (codecType == "AC") {
         CodecAC<charType>::Encode(inputStr, outputFile, useUTF8);
     } else if (codecType == "HA") {
-        CodecHA<charType>::Encode(inputStr, outputFile, useUTF8);
+        CodecHA<charType>::Encode(inputStr, outputFile, useUTF8, settings);
     } else if (codecType == "LZ77") {
-        CodecLZ77<charType>::Encode(inputStr, outputFile, useUTF8);  
+        CodecLZ77<charType>::Encode(inputStr, outputFile, useUTF8, settings);  
     } else if (codecType == "BWT+RLE") {
-        Codec_BWT_RLE<charType>::Encode(inputStr, outputFile, useUTF8);
+        Codec_BWT_RLE<charType>::Encode(inputStr, outputFile, useUTF8, settings);
     } else if (codecType == "BWT+MTF+AC") {
-        Codec_BWT_MTF_AC<charType>::Encode(inputStr, outputFile, useUTF8);
+        Codec_BWT_MTF_AC<charType>::Encode(inputStr, outputFile, useUTF8, settings);
     } else if (codecType == "BWT+MTF+HA") {
-        Codec_BWT_MTF_HA<charType>::Encode(inputStr, outputFile, useUTF8);
+        Codec_BWT_MTF_HA<charType>::Encode(inputStr, outputFile, useUTF8, settings);
     } else if (codecType == "BWT+MTF+RLE+AC") {
-        Codec_BWT_MTF_RLE_AC<charType>::Encode(inputStr, outputFile, useUTF8);
+        Codec_BWT_MTF_RLE_AC<charType>::Encode(inputStr, outputFile, useUTF8, settings);
     } else if (codecType == "BWT+MTF+RLE+HA") {
-        Codec_BWT_MTF_RLE_HA<charType>::Encode(inputStr, outputFile, useUTF8);
+        Codec_BWT_MTF_RLE_HA<charType>::Encode(inputStr, outputFile, useUTF8, settings);
     } else if (codecType == "RLE+HA") {
-        Codec_RLE_HA<charType>::Encode(inputStr, outputFile, useUTF8);
+        Codec_RLE_HA<charType>::Encode(inputStr, outputFile, useUTF8, settings);
+    } else if (codecType == "ZRLE") {
+        CodecZRLE<charType>::Encode(inputStr, outputFile, useUTF8);
+    } else if (codecType == "BWT+MTF+ZRLE+AC") {
+        Codec_BWT_MTF_ZRLE_AC<charType>::Encode(inputStr, outputFile, useUTF8, settings);
+    } else if (codecType == "BWT+MTF+ZRLE+HA") {
+        Codec_BWT_MTF_ZRLE_HA<charType>::Encode(inputStr, outputFile, useUTF8, settings);
     } else if (codecType == "LZ77+HA") {
-        Codec_LZ77_HA<charType>::Encode(inputStr, outputFile, useUTF8);
+        Codec_LZ77_HA<charType>::Encode(inputStr, outputFile, useUTF8, settings);
+    } else if (codecType == "ANS") {
+        CodecANS<charType>::Encode(inputStr, outputFile, useUTF8);
+    } else if (codecType == "BWT+MTF+ZRLE+ANS") {
+        Codec_BWT_MTF_ZRLE_ANS<charType>::Encode(inputStr, outputFile, useUTF8, settings);
+    } else if (codecType == "LZ77+ANS") {
+        Codec_LZ77_ANS<charType>::Encode(inputStr, outputFile, useUTF8, settings);
+    } else if (codecType == "DELTA") {
+        if (!reference) {
+            throw std::invalid_argument("FileCompressor: DELTA codec needs a reference file (use CompressDelta)");
+        }
+        Codec_LZ77_HA<charType>::EncodeDelta(inputStr, *reference, outputFile, settings);
     } else {
         throw std::invalid_argument("Unknown codec type: " + codecType);
     }
 }
 
 template <typename charType>
-void FileCompressor::decompress(std::ifstream& inputFile, const char* outputPath, const std::string& codecType, const bool useUTF8)
+StringL<charType> FileCompressor::decodeString(std::ifstream& inputFile, const std::string& codecType, const bool useUTF8, const StringL<charType>* reference)
 {
+    MemoryStats::Scope scope(MemoryStats::IsEnabled() ? "decode " + codecType : std::string());
+    std::string innerCodecType;
+    if (stripFilterPrefix(codecType, "STRIDE+", innerCodecType)) {
+        const uint8_t stride = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+        if (stride < 1 || stride > StrideFilter::MAX_STRIDE) {
+            throw std::runtime_error("FileCompressor: Invalid stride of STRIDE filter!");
+        }
+        StringL<charType> planes = decodeString<charType>(inputFile, innerCodecType, useUTF8, reference);
+        return StrideFilter::Untranspose(planes, stride);
+    }
+    if (stripFilterPrefix(codecType, "PREDICT+", innerCodecType)) {
+        const uint32_t rowSize = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+        const uint8_t pixelSize = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+        const uint32_t rowsCount = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+        if (rowSize < 1 || pixelSize < 1 || pixelSize > PredictiveFilter::MAX_PIXEL_SIZE || !inputFile) {
+            throw std::runtime_error("FileCompressor: Invalid header of PREDICT filter!");
+        }
+        Array<uint8_t> rowFilters(rowsCount, 0);
+        inputFile.read(reinterpret_cast<char*>(rowFilters.begin()), rowsCount);
+        if (static_cast<uint32_t>(inputFile.gcount()) != rowsCount) {
+            throw std::runtime_error("FileCompressor: Invalid header of PREDICT filter!");
+        }
+        StringL<charType> differences = decodeString<charType>(inputFile, innerCodecType, false, reference);
+        return PredictiveFilter::Decode(differences, rowSize, pixelSize, rowFilters);
+    }
+
     StringL<charType> decodedStr;
     if (codecType == "RLE") {
         decodedStr = CodecRLE<charType>::Decode(inputFile, useUTF8);
@@ -166,13 +854,603 @@ void FileCompressor::decompress(std::ifstream& inputFile, const char* outputPath
         decodedStr = Codec_BWT_MTF_RLE_HA<charType>::Decode(inputFile, useUTF8);
     } else if (codecType == "RLE+HA") {
         decodedStr = Codec_RLE_HA<charType>::Decode(inputFile, useUTF8);
+    } else if (codecType == "ZRLE") {
+        decodedStr = CodecZRLE<charType>::Decode(inputFile, useUTF8);
+    } else if (codecType == "BWT+MTF+ZRLE+AC") {
+        decodedStr = Codec_BWT_MTF_ZRLE_AC<charType>::Decode(inputFile, useUTF8);
+    } else if (codecType == "BWT+MTF+ZRLE+HA") {
+        decodedStr = Codec_BWT_MTF_ZRLE_HA<charType>::Decode(inputFile, useUTF8);
     } else if (codecType == "LZ77+HA") {
         decodedStr = Codec_LZ77_HA<charType>::Decode(inputFile, useUTF8);
+    } else if (codecType == "ANS") {
+        decodedStr = CodecANS<charType>::Decode(inputFile, useUTF8);
+    } else if (codecType == "BWT+MTF+ZRLE+ANS") {
+        decodedStr = Codec_BWT_MTF_ZRLE_ANS<charType>::Decode(inputFile, useUTF8);
+    } else if (codecType == "LZ77+ANS") {
+        decodedStr = Codec_LZ77_ANS<charType>::Decode(inputFile, useUTF8);
+    } else if (codecType == "DELTA") {
+        if (!reference) {
+            throw std::runtime_error("DELTA codec needs the reference file");
+        }
+        decodedStr = Codec_LZ77_HA<charType>::DecodeDelta(inputFile, *reference);
     } else {
-        FileUtils::CloseFile(inputFile);
         throw std::runtime_error("Unknown codec type: " + codecType);
     }
-    writeStringLToFile(outputPath, decodedStr, useUTF8);
+    return decodedStr;
+}
+
+template <typename charType>
+StringL<charType> FileCompressor::decodeBlock(std::ifstream& inputFile, const containerInfo& info, const blockInfo& block, const bool verifyChecksums,
+                                             const StringL<charType>* reference)
+{
+    Array<char> encoded(static_cast<size_t>(block.compressedSize), 0);
+    readEncodedBlock(inputFile, block, verifyChecksums, encoded);
+    MemoryStreamBuffer blockBuffer(encoded.c_arr(), encoded.size());
+    StreamBufferSwap bufferSwap(inputFile, &blockBuffer);
+
+    StringL<charType> decodedStr;
+    try {
+        decodedStr = decodeString<charType>(inputFile, info.codecType, info.useUTF8, reference);
+    } catch (const std::exception& e) {
+        throw std::runtime_error("FileCompressor: Corrupted block at offset " + std::to_string(block.rawOffset) + " (" + e.what() + ")");
+    }
+
+    if (decodedStr.size() != block.charsCount) {
+        throw std::runtime_error("FileCompressor: Corrupted block at offset " + std::to_string(block.rawOffset) + "!");
+    }
+    if (verifyChecksums && CRC32C::Compute(decodedStr.c_str(), decodedStr.size() * sizeof(charType)) != block.crc) {
+        throw std::runtime_error("FileCompressor: Checksum mismatch in block at offset " + std::to_string(block.rawOffset) + "!");
+    }
+    return decodedStr;
+}
+
+uint64_t FileCompressor::search(std::ifstream& inputFile, const containerInfo& info, const std::string& pattern, const bool verifyChecksums, Array<uint64_t>* positions)
+{
+    // all BWT codecs start with "BWT" (filters change the content before BWT, so their files can't be searched)
+    if (info.codecType.compare(0, 3, "BWT") != 0) {
+        throw std::invalid_argument("FileCompressor: Search needs a file compressed with a BWT codec, not " + info.codecType);
+    }
+
+    uint64_t count = 0;
+    uint64_t charsOffset = 0; // number of characters in the previous blocks
+    // consecutive blocks of one string type are searched by one call (blocks added by Append() can have another string type)
+    for (size_t firstBlock = 0; firstBlock < info.blocks.size();) {
+        const uint8_t stringType = info.blocks[firstBlock].stringType;
+        size_t lastBlock = firstBlock;
+        uint64_t charsCount = 0;
+        while (lastBlock < info.blocks.size() && info.blocks[lastBlock].stringType == stringType) {
+            charsCount += info.blocks[lastBlock].charsCount;
+            ++lastBlock;
+        }
+
+        if (stringType == 8) {
+            count += searchBlocks<char8>(inputFile, info, firstBlock, lastBlock, pattern, verifyChecksums, charsOffset, positions);
+        } else if (stringType == 16) {
+            count += searchBlocks<char16>(inputFile, info, firstBlock, lastBlock, pattern, verifyChecksums, charsOffset, positions);
+        } else {
+            count += searchBlocks<char32>(inputFile, info, firstBlock, lastBlock, pattern, verifyChecksums, charsOffset, positions);
+        }
+        firstBlock = lastBlock;
+        charsOffset += charsCount;
+    }
+    return positions ? positions->size() : count;
+}
+
+template <typename charType>
+uint64_t FileCompressor::searchBlocks(std::ifstream& inputFile, const containerInfo& info, const size_t firstBlock, const size_t lastBlock, const std::string& pattern,
+                                      const bool verifyChecksums, uint64_t charsOffset, Array<uint64_t>* positions)
+{
+    StringL<charType> patternStr;
+    if (!patternToStringL(pattern, info.useUTF8, patternStr) || patternStr.size() == 0) {
+        return 0;
+    }
+
+    uint64_t count = 0;
+    FMIndex<charType> index;
+    for (size_t i = firstBlock; i < lastBlock; ++i) {
+        const blockInfo& block = info.blocks[i];
+        Array<char> encoded(static_cast<size_t>(block.compressedSize), 0);
+        readEncodedBlock(inputFile, block, verifyChecksums, encoded);
+        MemoryStreamBuffer blockBuffer(encoded.c_arr(), encoded.size());
+        StreamBufferSwap bufferSwap(inputFile, &blockBuffer);
+
+        try {
+            uint32_t indexBWT;
+            StringL<charType> bwt = decodeBWTString<charType>(inputFile, info.codecType, info.useUTF8, indexBWT);
+            if (bwt.size() != static_cast<size_t>(block.charsCount) + 1) {
+                throw std::runtime_error("Invalid size of BWT string");
+            }
+            index.Build(bwt, indexBWT);
+        } catch (const std::exception& e) {
+            throw std::runtime_error("FileCompressor: Corrupted block at offset " + std::to_string(block.rawOffset) + " (" + e.what() + ")");
+        }
+
+        if (positions) {
+            for (const uint32_t& position : index.Locate(patternStr)) {
+                positions->push_back(charsOffset + position);
+            }
+        } else {
+            count += index.Count(patternStr);
+        }
+        charsOffset += block.charsCount;
+    }
+    return count;
+}
+
+template <typename charType>
+StringL<charType> FileCompressor::decodeBWTString(std::ifstream& inputFile, const std::string& codecType, const bool useUTF8, uint32_t& index)
+{
+    uint32_t checkpointStep;
+    Array<uint32_t> checkpoints;
+    if (codecType == "BWT") {
+        return CodecBWT<charType>::DecodeBWT(inputFile, useUTF8, index, checkpointStep, checkpoints);
+    } else if (codecType == "BWT+RLE") {
+        return Codec_BWT_RLE<charType>::DecodeBWT(inputFile, useUTF8, index, checkpointStep, checkpoints);
+    } else if (codecType == "BWT+MTF+AC") {
+        return Codec_BWT_MTF_AC<charType>::DecodeBWT(inputFile, useUTF8, index, checkpointStep, checkpoints);
+    } else if (codecType == "BWT+MTF+HA") {
+        return Codec_BWT_MTF_HA<charType>::DecodeBWT(inputFile, useUTF8, index, checkpointStep, checkpoints);
+    } else if (codecType == "BWT+MTF+RLE+AC") {
+        return Codec_BWT_MTF_RLE_AC<charType>::DecodeBWT(inputFile, useUTF8, index, checkpointStep, checkpoints);
+    } else if (codecType == "BWT+MTF+RLE+HA") {
+        return Codec_BWT_MTF_RLE_HA<charType>::DecodeBWT(inputFile, useUTF8, index, checkpointStep, checkpoints);
+    } else if (codecType == "BWT+MTF+ZRLE+AC") {
+        return Codec_BWT_MTF_ZRLE_AC<charType>::DecodeBWT(inputFile, useUTF8, index, checkpointStep, checkpoints);
+    } else if (codecType == "BWT+MTF+ZRLE+HA") {
+        return Codec_BWT_MTF_ZRLE_HA<charType>::DecodeBWT(inputFile, useUTF8, index, checkpointStep, checkpoints);
+    } else if (codecType == "BWT+MTF+ZRLE+ANS") {
+        return Codec_BWT_MTF_ZRLE_ANS<charType>::DecodeBWT(inputFile, useUTF8, index, checkpointStep, checkpoints);
+    }
+    throw std::runtime_error("Unknown codec type: " + codecType);
+}
+
+template <typename charType>
+bool FileCompressor::patternToStringL(const std::string& pattern, const bool useUTF8, StringL<charType>& result)
+{
+    result.clear();
+    for (size_t i = 0; i < pattern.size();) {
+        if (!useUTF8) {
+            result.push_back(static_cast<charType>(static_cast<uint8_t>(pattern[i++])));
+            continue;
+        }
+        const uint8_t first = static_cast<uint8_t>(pattern[i]);
+        const size_t length = (first < 0x80) ? 1 : (((first & 0xE0) == 0xC0) ? 2 : (((first & 0xF0) == 0xE0) ? 3 : 4));
+        const char32_t c = CodecUTF8::DecodeCharFromString<char32_t>(pattern.substr(i, length));
+        if (static_cast<uint64_t>(c) > static_cast<uint64_t>(static_cast<charType>(~static_cast<charType>(0)))) {
+            return false;
+        }
+        result.push_back(static_cast<charType>(c));
+        i += length;
+    }
+    return true;
+}
+
+bool FileCompressor::stripFilterPrefix(const std::string& codecType, const std::string& prefix, std::string& innerCodecType)
+{
+    if (codecType.compare(0, prefix.size(), prefix) != 0) return false;
+    innerCodecType = codecType.substr(prefix.size());
+    return true;
+}
+
+FileCompressor::batchTable FileCompressor::readBatch(std::ifstream& inputFile, containerInfo& info)
+{
+    std::string innerCodecType;
+    if (!stripFilterPrefix(info.codecType, "BATCH+", innerCodecType)) {
+        throw std::invalid_argument("FileCompressor: File is not a batch archive!");
+    }
+    info.codecType = innerCodecType;
+    uint64_t contentSize = 0;
+    if (info.blocks.size() > 0) {
+        contentSize = info.blocks[info.blocks.size() - 1].rawOffset + info.blocks[info.blocks.size() - 1].rawSize;
+    }
+
+    // the table follows the header
+    inputFile.clear();
+    inputFile.seekg(info.headerEnd);
+    batchTable table;
+    const uint32_t filesCount = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    for (uint32_t i = 0; i < filesCount && inputFile; ++i) {
+        batchFile file;
+        file.name.resize(FileUtils::ReadValueBinary<uint16_t>(inputFile));
+        inputFile.read(&file.name[0], file.name.size());
+        file.size = FileUtils::ReadValueBinary<uint64_t>(inputFile);
+        file.crc = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+        const uint32_t chunksCount = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+        for (uint32_t j = 0; j < chunksCount && inputFile; ++j) {
+            file.chunks.push_back(FileUtils::ReadValueBinary<uint32_t>(inputFile));
+        }
+        table.files.push_back(file);
+    }
+    const uint32_t chunksCount = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    for (uint32_t i = 0; i < chunksCount && inputFile; ++i) {
+        table.chunkOffsets.push_back(FileUtils::ReadValueBinary<uint64_t>(inputFile));
+        table.chunkSizes.push_back(FileUtils::ReadValueBinary<uint32_t>(inputFile));
+    }
+    if (!inputFile) {
+        throw std::runtime_error("FileCompressor: File table of the batch archive is corrupted!");
+    }
+
+    // chunks should lie in the content and give the sizes of files
+    for (uint32_t i = 0; i < chunksCount; ++i) {
+        if (table.chunkOffsets[i] > contentSize || table.chunkSizes[i] > contentSize - table.chunkOffsets[i]) {
+            throw std::runtime_error("FileCompressor: File table of the batch archive is corrupted!");
+        }
+    }
+    for (const batchFile& file : table.files) {
+        uint64_t size = 0;
+        for (const uint32_t& id : file.chunks) {
+            if (id >= chunksCount) {
+                throw std::runtime_error("FileCompressor: File table of the batch archive is corrupted!");
+            }
+            size += table.chunkSizes[id];
+        }
+        // names without directories only, so files are extracted into the given directory
+        const std::filesystem::path name(file.name);
+        if (size != file.size || file.name.empty() || name.filename() != name || file.name == "." || file.name == "..") {
+            throw std::runtime_error("FileCompressor: File table of the batch archive is corrupted!");
+        }
+    }
+    return table;
+}
+
+void FileCompressor::writeBatchTable(std::ofstream& outputFile, const batchTable& table)
+{
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(table.files.size()));
+    for (const batchFile& file : table.files) {
+        FileUtils::AppendValueBinary(outputFile, static_cast<uint16_t>(file.name.size()));
+        outputFile.write(file.name.c_str(), file.name.size());
+        FileUtils::AppendValueBinary(outputFile, file.size);
+        FileUtils::AppendValueBinary(outputFile, file.crc);
+        FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(file.chunks.size()));
+        for (const uint32_t& id : file.chunks) {
+            FileUtils::AppendValueBinary(outputFile, id);
+        }
+    }
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(table.chunkOffsets.size()));
+    for (size_t i = 0; i < table.chunkOffsets.size(); ++i) {
+        FileUtils::AppendValueBinary(outputFile, table.chunkOffsets[i]);
+        FileUtils::AppendValueBinary(outputFile, table.chunkSizes[i]);
+    }
+}
+
+Array<size_t> FileCompressor::orderBatchFiles(const Array<std::string>& inputPaths, const CompressorSettings::BatchOrder order)
+{
+    Array<size_t> indices(inputPaths.size());
+    for (size_t i = 0; i < inputPaths.size(); ++i) {
+        indices.push_back(i);
+    }
+    if (order == CompressorSettings::INPUT_ORDER || inputPaths.size() < 2) {
+        return indices;
+    }
+
+    // files with the same extension become neighbours
+    Array<std::string> names(inputPaths.size());
+    Array<std::string> extensions(inputPaths.size());
+    for (const std::string& path : inputPaths) {
+        const std::filesystem::path filePath(path);
+        names.push_back(filePath.filename().string());
+        extensions.push_back(filePath.extension().string());
+    }
+    std::sort(indices.begin(), indices.end(), [&names, &extensions](const size_t a, const size_t b) {
+        return (extensions[a] != extensions[b]) ? extensions[a] < extensions[b] : names[a] < names[b];
+    });
+    if (order == CompressorSettings::EXTENSION_ORDER) {
+        return indices;
+    }
+
+    // byte histograms of the beginnings of files (normalized to the sum 2^16)
+    Array<uint32_t> histograms(inputPaths.size() * 256, 0);
+    Array<uint8_t> buffer(SIMILARITY_SAMPLE_SIZE, 0);
+    for (size_t i = 0; i < inputPaths.size(); ++i) {
+        std::ifstream file = FileUtils::OpenFileBinaryRead(inputPaths[i].c_str());
+        file.read(reinterpret_cast<char*>(buffer.begin()), SIMILARITY_SAMPLE_SIZE);
+        const size_t sampleSize = static_cast<size_t>(file.gcount());
+        FileUtils::CloseFile(file);
+
+        uint32_t* histogram = histograms.begin() + i * 256;
+        for (size_t j = 0; j < sampleSize; ++j) {
+            ++histogram[buffer[j]];
+        }
+        for (size_t c = 0; sampleSize > 0 && c < 256; ++c) {
+            histogram[c] = static_cast<uint32_t>((static_cast<uint64_t>(histogram[c]) << 16) / sampleSize);
+        }
+    }
+
+    // in every group of one extension the next file is the nearest to the previous one
+    for (size_t groupBegin = 0; groupBegin < indices.size();) {
+        size_t groupEnd = groupBegin + 1;
+        while (groupEnd < indices.size() && extensions[indices[groupEnd]] == extensions[indices[groupBegin]]) {
+            ++groupEnd;
+        }
+        for (size_t i = groupBegin + 1; i < groupEnd && groupEnd - groupBegin <= MAX_SIMILARITY_GROUP; ++i) {
+            const uint32_t* previous = histograms.begin() + indices[i - 1] * 256;
+            size_t nearest = i;
+            uint64_t nearestDistance = UINT64_MAX;
+            for (size_t j = i; j < groupEnd; ++j) {
+                const uint32_t* histogram = histograms.begin() + indices[j] * 256;
+                uint64_t distance = 0;
+                for (size_t c = 0; c < 256; ++c) {
+                    distance += (histogram[c] > previous[c]) ? histogram[c] - previous[c] : previous[c] - histogram[c];
+                }
+                if (distance < nearestDistance) {
+                    nearestDistance = distance;
+                    nearest = j;
+                }
+            }
+            const size_t index = indices[nearest];
+            indices[nearest] = indices[i];
+            indices[i] = index;
+        }
+        groupBegin = groupEnd;
+    }
+    return indices;
+}
+
+void FileCompressor::extractBatchFile(std::ifstream& inputFile, const containerInfo& info, const batchTable& table, const size_t fileIndex, const std::string& outputPath,
+                                      const bool verifyChecksums, std::map<size_t, StringL<char8>>& decodedBlocks)
+{
+    const batchFile& file = table.files[fileIndex];
+    std::ofstream outputFile = FileUtils::OpenFileBinaryWrite(outputPath.c_str());
+
+    uint32_t crc = 0;
+    for (const uint32_t& id : file.chunks) {
+        uint64_t position = table.chunkOffsets[id];
+        uint64_t left = table.chunkSizes[id];
+        while (left > 0) {
+            // the block which holds the position (blocks are sorted by offsets)
+            size_t low = 0, high = info.blocks.size();
+            while (high - low > 1) {
+                const size_t middle = (low + high) / 2;
+                if (info.blocks[middle].rawOffset <= position) low = middle;
+                else high = middle;
+            }
+            const blockInfo& block = info.blocks[low];
+            if (position < block.rawOffset || position >= block.rawOffset + block.rawSize) {
+                throw std::runtime_error("FileCompressor: File table of the batch archive is corrupted!");
+            }
+
+            auto decoded = decodedBlocks.find(low);
+            if (decoded == decodedBlocks.end()) {
+                decoded = decodedBlocks.emplace(low, decodeBlock<char8>(inputFile, info, block, verifyChecksums)).first;
+            }
+            const uint64_t from = position - block.rawOffset;
+            const uint64_t count = std::min(left, block.rawSize - from);
+            const char8* chars = decoded->second.c_str() + from;
+            outputFile.write(reinterpret_cast<const char*>(chars), count);
+            if (verifyChecksums) {
+                crc = CRC32C::Compute(chars, count, crc);
+            }
+            position += count;
+            left -= count;
+        }
+    }
+
+    FileUtils::CloseFile(outputFile);
+    if (verifyChecksums && crc != file.crc) {
+        throw std::runtime_error("FileCompressor: Checksum mismatch in file " + file.name + "!");
+    }
+}
+
+void FileCompressor::writeSettings(std::ofstream& outputFile, const CompressorSettings& settings)
+{
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint64_t>(settings.GetBlockSize()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(settings.GetHuffmanBlockSize()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(settings.GetHuffmanStreamsCount()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(settings.GetLZ77SearchBufferSize()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(settings.GetRLEElementStride()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint64_t>(settings.GetSuffixArrayThreadsCount()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint64_t>(settings.GetParallelSuffixArrayThreshold()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(settings.GetTransposeStride()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(settings.GetImageWidth()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(settings.GetImagePixelSize()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(settings.GetVerifyChecksums()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(settings.GetBWTCheckpointsCount()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(settings.GetDedupChunkSize()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(settings.GetSolidArchive()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(settings.GetBatchOrder()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint8_t>(settings.GetLZ77MaxMode()));
+    FileUtils::AppendValueBinary(outputFile, static_cast<uint64_t>(settings.GetMemoryBudget()));
+}
+
+CompressorSettings FileCompressor::readSettings(std::ifstream& inputFile)
+{
+    CompressorSettings settings;
+    try {
+        settings.SetBlockSize(static_cast<size_t>(FileUtils::ReadValueBinary<uint64_t>(inputFile)));
+        settings.SetHuffmanBlockSize(FileUtils::ReadValueBinary<uint32_t>(inputFile));
+        settings.SetHuffmanStreamsCount(FileUtils::ReadValueBinary<uint8_t>(inputFile));
+        settings.SetLZ77SearchBufferSize(FileUtils::ReadValueBinary<uint32_t>(inputFile));
+        settings.SetRLEElementStride(FileUtils::ReadValueBinary<uint8_t>(inputFile));
+        settings.SetSuffixArrayThreadsCount(static_cast<size_t>(FileUtils::ReadValueBinary<uint64_t>(inputFile)));
+        settings.SetParallelSuffixArrayThreshold(static_cast<size_t>(FileUtils::ReadValueBinary<uint64_t>(inputFile)));
+        settings.SetTransposeStride(FileUtils::ReadValueBinary<uint8_t>(inputFile));
+        settings.SetImageWidth(FileUtils::ReadValueBinary<uint32_t>(inputFile));
+        settings.SetImagePixelSize(FileUtils::ReadValueBinary<uint8_t>(inputFile));
+        settings.SetVerifyChecksums(FileUtils::ReadValueBinary<uint8_t>(inputFile) != 0);
+        settings.SetBWTCheckpointsCount(FileUtils::ReadValueBinary<uint8_t>(inputFile));
+        settings.SetDedupChunkSize(FileUtils::ReadValueBinary<uint32_t>(inputFile));
+        settings.SetSolidArchive(FileUtils::ReadValueBinary<uint8_t>(inputFile) != 0);
+        settings.SetBatchOrder(static_cast<CompressorSettings::BatchOrder>(FileUtils::ReadValueBinary<uint8_t>(inputFile)));
+        settings.SetLZ77MaxMode(FileUtils::ReadValueBinary<uint8_t>(inputFile) != 0);
+        settings.SetMemoryBudget(static_cast<size_t>(FileUtils::ReadValueBinary<uint64_t>(inputFile)));
+    } catch (const std::invalid_argument&) {
+        throw std::runtime_error("FileCompressor: File is not compressed or corrupted!");
+    }
+    return settings;
+}
+
+void FileCompressor::writeIndex(std::ofstream& outputFile, const Array<blockInfo>& blocks, const uint32_t crc)
+{
+    uint64_t indexOffset = static_cast<uint64_t>(outputFile.tellp());
+
+    uint32_t indexCrc = 0;
+    {
+        CRC32CStreamBuffer crcBuffer(outputFile.rdbuf());
+        StreamBufferSwap bufferSwap(outputFile, &crcBuffer);
+        FileUtils::AppendValueBinary(outputFile, static_cast<uint32_t>(blocks.size()));
+        for (const blockInfo& block : blocks) {
+            FileUtils::AppendValueBinary(outputFile, block.rawOffset);
+            FileUtils::AppendValueBinary(outputFile, block.rawSize);
+            FileUtils::AppendValueBinary(outputFile, block.compressedOffset);
+            FileUtils::AppendValueBinary(outputFile, block.compressedSize);
+            FileUtils::AppendValueBinary(outputFile, block.charsCount);
+            FileUtils::AppendValueBinary(outputFile, block.crc);
+            FileUtils::AppendValueBinary(outputFile, block.compressedCrc);
+            FileUtils::AppendValueBinary(outputFile, block.stringType);
+        }
+        if (!crcBuffer.Good()) {
+            throw std::runtime_error("FileCompressor: Failed to write the compressed file!");
+        }
+        indexCrc = crcBuffer.GetCrc();
+    }
+
+    // footer
+    FileUtils::AppendValueBinary(outputFile, indexOffset);
+    FileUtils::AppendValueBinary(outputFile, crc);
+    FileUtils::AppendValueBinary(outputFile, indexCrc);
+    FileUtils::AppendValueBinary(outputFile, FORMAT_VERSION);
+    FileUtils::AppendValueBinary(outputFile, CONTAINER_MAGIC);
+}
+
+FileCompressor::containerInfo FileCompressor::readContainerInfo(std::ifstream& inputFile)
+{
+    // read footer
+    inputFile.seekg(0, std::ios::end);
+    const uint64_t fileSize = static_cast<uint64_t>(inputFile.tellg());
+    if (fileSize < FOOTER_SIZE) {
+        throw std::runtime_error("FileCompressor: File is not compressed or corrupted!");
+    }
+    inputFile.seekg(static_cast<std::streamoff>(fileSize - sizeof(uint8_t) - sizeof(uint32_t)));
+    uint8_t version = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+    const bool hasMagic = FileUtils::ReadValueBinary<uint32_t>(inputFile) == CONTAINER_MAGIC;
+
+    // read index
+    containerInfo info;
+    if (!readIndex(inputFile, fileSize, info)) {
+        // Append() was interrupted: the last valid footer is before its bytes
+        const uint64_t minEnd = FOOTER_SIZE + sizeof(uint32_t);
+        Array<char> chunk(FOOTER_SCAN_CHUNK_SIZE + sizeof(uint32_t), 0);
+        bool found = false;
+        for (uint64_t last = fileSize - 1; !found && last >= minEnd; ) {
+            // ends of footers from first to last, their magic numbers are in bytes [first - 4, last)
+            const uint64_t first = (last - minEnd > FOOTER_SCAN_CHUNK_SIZE) ? last - FOOTER_SCAN_CHUNK_SIZE : minEnd;
+            const uint64_t chunkOffset = first - sizeof(uint32_t);
+            inputFile.clear();
+            inputFile.seekg(static_cast<std::streamoff>(chunkOffset));
+            inputFile.read(chunk.begin(), static_cast<std::streamsize>(last - chunkOffset));
+            if (!inputFile) {
+                break;
+            }
+            for (uint64_t end = last; !found && end >= first; --end) {
+                uint32_t magic;
+                std::memcpy(&magic, chunk.c_arr() + (end - sizeof(uint32_t) - chunkOffset), sizeof(uint32_t));
+                found = magic == CONTAINER_MAGIC && readIndex(inputFile, end, info);
+            }
+            last = first - 1;
+        }
+        if (!found && hasMagic && version != FORMAT_VERSION) {
+            throw std::runtime_error("FileCompressor: Unsupported format version " + std::to_string(version) +
+                                     " (supported version " + std::to_string(FORMAT_VERSION) + ")!");
+        }
+        if (!found && !hasMagic) {
+            // files of the first version ([useUTF8][stringType if useUTF8][data of the codec]) have no footer
+            throw std::runtime_error("FileCompressor: File is not compressed, corrupted or compressed by an old version without the block index!");
+        }
+        if (!found) {
+            throw std::runtime_error("FileCompressor: File is not compressed or corrupted!");
+        }
+    }
+
+    // read header
+    inputFile.clear();
+    inputFile.seekg(0);
+    info.useUTF8 = FileUtils::ReadValueBinary<bool>(inputFile);
+    info.stringType = info.useUTF8 ? FileUtils::ReadValueBinary<uint8_t>(inputFile) : 8;
+    uint8_t codecTypeLength = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+    info.codecType.resize(codecTypeLength);
+    inputFile.read(&info.codecType[0], codecTypeLength);
+    info.settings = readSettings(inputFile);
+    info.headerEnd = static_cast<uint64_t>(inputFile.tellg());
+    if (!inputFile) {
+        throw std::runtime_error("FileCompressor: File is not compressed or corrupted!");
+    }
+    for (const blockInfo& block : info.blocks) {
+        if (block.stringType != 8 && (!info.useUTF8 || (block.stringType != 16 && block.stringType != 32))) {
+            throw std::runtime_error("FileCompressor: File is not compressed or corrupted!");
+        }
+    }
+
+    return info;
+}
+
+bool FileCompressor::readIndex(std::ifstream& inputFile, const uint64_t footerEnd, containerInfo& info)
+{
+    if (footerEnd < FOOTER_SIZE + sizeof(uint32_t)) {
+        return false;
+    }
+    inputFile.clear();
+    inputFile.seekg(static_cast<std::streamoff>(footerEnd - FOOTER_SIZE));
+    uint64_t indexOffset = FileUtils::ReadValueBinary<uint64_t>(inputFile);
+    uint32_t crc = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    uint32_t indexCrc = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    uint8_t version = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+    uint32_t magic = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    if (!inputFile || magic != CONTAINER_MAGIC || version != FORMAT_VERSION || indexOffset > footerEnd - FOOTER_SIZE - sizeof(uint32_t)) {
+        return false;
+    }
+    const uint64_t indexSize = footerEnd - FOOTER_SIZE - indexOffset;
+    if ((indexSize - sizeof(uint32_t)) % INDEX_ENTRY_SIZE != 0) {
+        return false;
+    }
+
+    // the index is checked as a whole before its entries are used
+    Array<char> index(static_cast<size_t>(indexSize), 0);
+    inputFile.seekg(static_cast<std::streamoff>(indexOffset));
+    inputFile.read(index.begin(), static_cast<std::streamsize>(indexSize));
+    if (!inputFile || CRC32C::Compute(index.c_arr(), index.size()) != indexCrc) {
+        return false;
+    }
+
+    MemoryStreamBuffer indexBuffer(index.c_arr(), index.size());
+    StreamBufferSwap bufferSwap(inputFile, &indexBuffer);
+    uint32_t blocksCount = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+    if (sizeof(uint32_t) + blocksCount * INDEX_ENTRY_SIZE != indexSize) {
+        return false;
+    }
+    info.blocks = Array<blockInfo>(blocksCount);
+    for (uint32_t i = 0; i < blocksCount; ++i) {
+        blockInfo block;
+        block.rawOffset = FileUtils::ReadValueBinary<uint64_t>(inputFile);
+        block.rawSize = FileUtils::ReadValueBinary<uint64_t>(inputFile);
+        block.compressedOffset = FileUtils::ReadValueBinary<uint64_t>(inputFile);
+        block.compressedSize = FileUtils::ReadValueBinary<uint64_t>(inputFile);
+        block.charsCount = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+        block.crc = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+        block.compressedCrc = FileUtils::ReadValueBinary<uint32_t>(inputFile);
+        block.stringType = FileUtils::ReadValueBinary<uint8_t>(inputFile);
+        info.blocks.push_back(block);
+    }
+    info.crc = crc;
+    info.end = footerEnd;
+    return true;
+}
+
+void FileCompressor::readEncodedBlock(std::ifstream& inputFile, const blockInfo& block, const bool verifyChecksums, Array<char>& encoded)
+{
+    inputFile.clear();
+    inputFile.seekg(block.compressedOffset);
+    inputFile.read(encoded.begin(), encoded.size());
+    if (static_cast<size_t>(inputFile.gcount()) != encoded.size()) {
+        throw std::runtime_error("FileCompressor: File is truncated or corrupted!");
+    }
+    if (verifyChecksums && CRC32C::Compute(encoded.c_arr(), encoded.size()) != block.compressedCrc) {
+        throw std::runtime_error("FileCompressor: Checksum mismatch in encoded block at offset " + std::to_string(block.rawOffset) + "!");
+    }
+}
+
+uint8_t FileCompressor::getStringTypeBits(const std::string& stringType)
+{
+    return (stringType == "string8") ? 8 : ((stringType == "string16") ? 16 : 32);
 }
 
 const std::string FileCompressor::checkStringType(const char* filepath)
@@ -205,7 +1483,13 @@ template <typename charType>
 void FileCompressor::writeStringLToFile(const char* outputPath, const StringL<charType>& str, const bool useUTF8)
 {
     std::ofstream outputFile = FileUtils::OpenFileBinaryWrite(outputPath);
+    appendStringLToFile(outputFile, str, useUTF8);
+    FileUtils::CloseFile(outputFile);
+}
 
+template <typename charType>
+void FileCompressor::appendStringLToFile(std::ofstream& outputFile, const StringL<charType>& str, const bool useUTF8)
+{
     if (useUTF8) {
         for (const auto& c : str) {
             CodecUTF8::EncodeCharToBinaryFile(outputFile, c);
@@ -215,8 +1499,6 @@ void FileCompressor::writeStringLToFile(const char* outputPath, const StringL<ch
             FileUtils::AppendValueBinary(outputFile, c);
         }
     }
-
-    FileUtils::CloseFile(outputFile);
 }
 
 template <typename charType>
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+
+#include "BitStream.h"
+#include "Array.h"
+
+
+/**
+ * ACDecodeTable.
+ *
+ * Brief:
+ * - Class defines lookup table to decode characters of CodecAC from BitReader
+ *
+ * Memory usage:
+ * O(2^LOOKUP_BITS) + θ(alphabetSize)
+ *
+ * Details:
+ * - CodecAC encodes every character by halving [0, 1) until the half lies in the segment of the character,
+ *   so the bits of the character depend only on the segments (cumulative frequencies)
+ * - The table is indexed by the next LOOKUP_BITS bits (quantized position in [0, 1)). An entry keeps the index of the character
+ *   and the length of its bits, or (for rare characters with longer bits) the first segment which may contain the position.
+ *   Then one refinement step continues halving from that segment
+ * - Build() reuses memory of the previous table, so one object can decode many blocks with the same or different segments
+ */
+class ACDecodeTable
+{
+public:
+    static const uint32_t LOOKUP_BITS = 12;
+
+    ACDecodeTable() : alphabetSize_(0), maxLength_(0) {}
+    ACDecodeTable(const Array<double>& segments, const size_t alphabetSize) : alphabetSize_(0), maxLength_(0)
+    {
+        Build(segments, alphabetSize);
+    }
+
+    // segments - bounds of segments from 0 to 1 (CodecAC::calculateSegments()), character i has [segments[i], segments[i + 1]]
+    inline void Build(const Array<double>& segments, const size_t alphabetSize);
+
+    // returns index of the next character in the alphabet
+    inline uint32_t DecodeIndex(BitReader& reader) const;
+
+    // number of bits of the character with the given index
+    inline uint32_t GetCodeLength(const size_t index) const { return lengths_[index]; }
+private:
+    struct entry {
+        uint32_t index; // index of the character or of the first possible segment
+        uint8_t length; // 0 - bits of the character are longer than LOOKUP_BITS
+    };
+
+    Array<entry> table_;
+    Array<uint32_t> lengths_;
+    Array<double> segments_;
+    size_t alphabetSize_;
+    uint32_t maxLength_;
+
+    inline uint32_t refine(BitReader& reader, uint32_t index) const;
+};
+
+
+// START IMPLEMENTATION
+
+void ACDecodeTable::Build(const Array<double>& segments, const size_t alphabetSize)
+{
+    if (segments.size() < 2 || alphabetSize > segments.size() - 1) {
+        throw std::invalid_argument("ACDecodeTable: Invalid segments!");
+    }
+    alphabetSize_ = alphabetSize;
+    segments_.clear();
+    for (const double& bound : segments) {
+        segments_.push_back(bound);
+    }
+
+    table_.clear();
+    for (size_t v = 0; v < (static_cast<size_t>(1) << LOOKUP_BITS); ++v) {
+        table_.push_back(entry{ 0, 0 });
+    }
+
+    // get bits of every character the same way as CodecAC encoder does
+    lengths_.clear();
+    maxLength_ = 0;
+    for (size_t i = 0; i < alphabetSize; ++i) {
+        const double low = segments[i], high = segments[i + 1];
+        const double mid = (low + high) / 2.0;
+        double low_temp = 0.0, high_temp = 1.0, mid_temp = 0.5;
+        uint64_t code = 0;
+        uint32_t length = 0;
+        while (!((high_temp <= high) && (low_temp >= low))) {
+            if (mid_temp > mid) {
+                high_temp = mid_temp;
+                code <<= 1;
+            } else {
+                low_temp = mid_temp;
+                code = (code << 1) | 1;
+            }
+            mid_temp = (high_temp + low_temp) / 2.0;
+            if (++length > 1024) {
+                throw std::invalid_argument("ACDecodeTable: Invalid segments!");
+            }
+        }
+        lengths_.push_back(length);
+        maxLength_ = std::max(maxLength_, length);
+
+        // all positions which begin with the bits of the character
+        if (length <= LOOKUP_BITS) {
+            const uint32_t shift = LOOKUP_BITS - length;
+            const size_t first = static_cast<size_t>(code) << shift;
+            for (size_t j = 0; j < (static_cast<size_t>(1) << shift); ++j) {
+                table_[first + j] = entry{ static_cast<uint32_t>(i), static_cast<uint8_t>(length) };
+            }
+        }
+    }
+
+    // other positions: the last segment which begins not after the position
+    uint32_t index = 0;
+    const double step = 1.0 / static_cast<double>(static_cast<size_t>(1) << LOOKUP_BITS);
+    for (size_t v = 0; v < table_.size(); ++v) {
+        const double low = static_cast<double>(v) * step;
+        while (index + 2 < segments_.size() && segments_[index + 1] <= low) ++index;
+        if (table_[v].length == 0) {
+            table_[v].index = index;
+        }
+    }
+}
+
+uint32_t ACDecodeTable::DecodeIndex(BitReader& reader) const
+{
+    const entry& e = table_[reader.Peek(LOOKUP_BITS)];
+    if (e.length != 0) {
+        reader.Skip(e.length);
+        return e.index;
+    }
+    return refine(reader, e.index);
+}
+
+uint32_t ACDecodeTable::refine(BitReader& reader, uint32_t index) const
+{
+    // continue halving of the position after LOOKUP_BITS bits (dyadic bounds are exact in double)
+    const double step = 1.0 / static_cast<double>(static_cast<size_t>(1) << LOOKUP_BITS);
+    const uint32_t position = reader.Peek(LOOKUP_BITS);
+    double low = static_cast<double>(position) * step;
+    double high = low + step;
+    reader.Skip(LOOKUP_BITS);
+
+    for (uint32_t length = LOOKUP_BITS + 1; length <= maxLength_; ++length) {
+        const double mid = (low + high) / 2.0;
+        if (reader.Peek(1) == 0) {
+            high = mid;
+        } else {
+            low = mid;
+        }
+        reader.Skip(1);
+
+        while (index + 2 < segments_.size() && segments_[index + 1] <= low) ++index;
+        if (high <= segments_[index + 1] && low >= segments_[index]) {
+            if (index >= alphabetSize_ || lengths_[index] != length) break;
+            return index;
+        }
+    }
+    throw std::runtime_error("ACDecodeTable: Corrupted data!");
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
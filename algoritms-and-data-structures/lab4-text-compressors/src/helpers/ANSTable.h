@@ -0,0 +1,252 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <algorithm>
+
+#include "BitStream.h"
+#include "Array.h"
+
+
+/**
+ * ANSTable / ANSEncodeTable / ANSDecodeTable.
+ *
+ * Brief:
+ * - Classes define tables of tabled asymmetric numeral systems (tANS, the same scheme as FSE):
+ *   normalized frequencies, spread of symbols over states, encoding and decoding steps
+ *
+ * Parameters:
+ * - charType - The type of the characters in the alphabet (char, char16_t/wchar_t, char32_t).
+ *
+ * Memory usage:
+ * θ(2^tableLog + alphabetSize)
+ *
+ * Details:
+ * - Frequencies of symbols are normalized to norms (every norm >= 1) with sum 2^tableLog, a symbol with norm f costs about tableLog - log2(f) bits,
+ *   so the precision is close to arithmetic coding
+ * - Symbol s occupies norm[s] of 2^tableLog states, states are spread over the table with an odd step (so neighbouring states have different symbols)
+ * - Encoder state X lies in [2^tableLog, 2^(tableLog + 1)): the lowest bits of X are written until X >> bits lies in [norm[s], 2 * norm[s]),
+ *   then X becomes the state of the table which holds that occurrence of s. Decoder does the same steps backwards:
+ *   one lookup gives the symbol, the number of bits to read and the base of the next state
+ * - Symbols are given by ranks (indices in the alphabet), Build() reuses memory of the previous table
+ */
+class ANSTable
+{
+private:
+    ANSTable() = default;
+public:
+    static const uint32_t MIN_TABLE_LOG = 5;
+    static const uint32_t MAX_TABLE_LOG = 16;
+    static const uint32_t DEFAULT_TABLE_LOG = 12;
+
+    // log2 of the table size for a block of "size" symbols with alphabetSize different symbols
+    static inline uint32_t GetTableLog(const size_t size, const size_t alphabetSize);
+    // counts -> norms with sum 2^tableLog (every used symbol keeps norm >= 1)
+    static inline void Normalize(const Array<uint32_t>& counts, const uint32_t tableLog, Array<uint32_t>& norms);
+    // rank of the symbol of every state
+    static inline void Spread(const Array<uint32_t>& norms, const uint32_t tableLog, Array<uint32_t>& spread);
+
+    static inline uint32_t HighestBit(uint32_t value) {
+        uint32_t bit = 0;
+        while (value >>= 1) ++bit;
+        return bit;
+    }
+};
+
+class ANSEncodeTable
+{
+public:
+    ANSEncodeTable() : tableLog_(0) {}
+
+    inline void Build(const Array<uint32_t>& norms, const uint32_t tableLog);
+
+    uint32_t GetTableLog() const { return tableLog_; }
+    // initial state of the encoder (the decoder finishes with state 0)
+    uint32_t GetInitialState() const { return 1u << tableLog_; }
+
+    // returns the next state, "length" lowest bits of the state are written to bits
+    inline uint32_t EncodeSymbol(const uint32_t state, const uint32_t rank, uint32_t& bits, uint32_t& length) const
+    {
+        // number of bits is maxBits or maxBits - 1, (state + deltaBits) >> 16 selects it without a branch (tableLog <= 16)
+        const symbolTransform& transform = transforms_[rank];
+        length = (state + transform.deltaBits) >> 16;
+        bits = state & ((1u << length) - 1);
+        return states_[static_cast<size_t>(static_cast<int64_t>(state >> length) + transform.deltaState)];
+    }
+private:
+    struct symbolTransform {
+        uint32_t deltaBits; // (maxBits << 16) - (norm << maxBits)
+        int32_t deltaState; // first index of the states of the symbol - norm
+    };
+
+    Array<symbolTransform> transforms_;
+    Array<uint32_t> states_; // encoder states (2^tableLog + position) grouped by symbols
+    Array<uint32_t> spread_;
+    Array<uint32_t> cursor_;
+    uint32_t tableLog_;
+};
+
+template <typename charType>
+class ANSDecodeTable
+{
+public:
+    ANSDecodeTable() : tableLog_(0) {}
+
+    // symbols - alphabet in order of ranks
+    void Build(const Array<charType>& symbols, const Array<uint32_t>& norms, const uint32_t tableLog);
+
+    uint32_t GetTableLog() const { return tableLog_; }
+
+    // state is in [0, 2^tableLog)
+    inline charType DecodeSymbol(uint32_t& state, BitReader& reader) const
+    {
+        const entry& e = table_[state];
+        state = e.base + reader.Read(e.length);
+        return e.symbol;
+    }
+private:
+    struct entry {
+        uint32_t base; // the next state without the read bits
+        charType symbol;
+        uint8_t length; // number of bits to read
+    };
+
+    Array<entry> table_;
+    Array<uint32_t> spread_;
+    Array<uint32_t> next_;
+    uint32_t tableLog_;
+};
+
+
+// START IMPLEMENTATION
+
+uint32_t ANSTable::GetTableLog(const size_t size, const size_t alphabetSize)
+{
+    if (alphabetSize > (static_cast<size_t>(1) << MAX_TABLE_LOG)) {
+        throw std::invalid_argument("ANSTable: Alphabet is too large!");
+    }
+    // small blocks don't need many states, large alphabets need at least two states for the most symbols
+    uint32_t tableLog = DEFAULT_TABLE_LOG;
+    const uint32_t sizeLog = (size > 1) ? HighestBit(static_cast<uint32_t>(std::min<size_t>(size - 1, UINT32_MAX))) + 1 : 0;
+    if (sizeLog < tableLog) tableLog = sizeLog;
+    if (tableLog < MIN_TABLE_LOG) tableLog = MIN_TABLE_LOG;
+    const uint32_t alphabetLog = (alphabetSize > 1) ? HighestBit(static_cast<uint32_t>(alphabetSize - 1)) + 1 : 0;
+    if (alphabetLog + 1 > tableLog) tableLog = (alphabetLog + 1 < MAX_TABLE_LOG) ? alphabetLog + 1 : MAX_TABLE_LOG;
+    return tableLog;
+}
+
+void ANSTable::Normalize(const Array<uint32_t>& counts, const uint32_t tableLog, Array<uint32_t>& norms)
+{
+    const uint64_t tableSize = static_cast<uint64_t>(1) << tableLog;
+    uint64_t total = 0;
+    for (const uint32_t& count : counts) {
+        total += count;
+    }
+    if (counts.size() == 0 || counts.size() > tableSize || total == 0) {
+        throw std::invalid_argument("ANSTable: Invalid counts!");
+    }
+
+    // floor of the exact share, rare symbols get 1
+    norms.clear();
+    uint64_t sum = 0;
+    for (const uint32_t& count : counts) {
+        const uint64_t norm = std::max<uint64_t>((static_cast<uint64_t>(count) << tableLog) / total, 1);
+        norms.push_back(static_cast<uint32_t>(norm));
+        sum += norm;
+    }
+    if (sum == tableSize) return;
+
+    Array<uint32_t> order(counts.size());
+    for (uint32_t i = 0; i < counts.size(); ++i) {
+        order.push_back(i);
+    }
+    if (sum < tableSize) {
+        // the rest goes to symbols with the largest fractional parts (less than one per symbol)
+        std::sort(order.begin(), order.end(), [&counts, tableLog, total](const uint32_t a, const uint32_t b) {
+            const uint64_t ra = (static_cast<uint64_t>(counts[a]) << tableLog) % total;
+            const uint64_t rb = (static_cast<uint64_t>(counts[b]) << tableLog) % total;
+            return (ra != rb) ? ra > rb : a < b;
+        });
+        for (size_t i = 0; sum < tableSize; i = (i + 1) % order.size(), ++sum) {
+            ++norms[order[i]];
+        }
+    } else {
+        // rare symbols took more than their share, take it from the largest norms (their costs change the least)
+        std::sort(order.begin(), order.end(), [&norms](const uint32_t a, const uint32_t b) {
+            return (norms[a] != norms[b]) ? norms[a] > norms[b] : a < b;
+        });
+        for (size_t i = 0; sum > tableSize; ++i) {
+            const uint64_t taken = std::min<uint64_t>(sum - tableSize, norms[order[i]] - 1);
+            norms[order[i]] -= static_cast<uint32_t>(taken);
+            sum -= taken;
+        }
+    }
+}
+
+void ANSTable::Spread(const Array<uint32_t>& norms, const uint32_t tableLog, Array<uint32_t>& spread)
+{
+    // the step is odd, so it visits every state of the power-of-two table once
+    const uint32_t tableSize = 1u << tableLog;
+    const uint32_t mask = tableSize - 1;
+    const uint32_t step = (tableSize >> 1) + (tableSize >> 3) + 3;
+    spread.clear();
+    for (uint32_t i = 0; i < tableSize; ++i) {
+        spread.push_back(0);
+    }
+    uint32_t position = 0;
+    for (uint32_t rank = 0; rank < norms.size(); ++rank) {
+        for (uint32_t i = 0; i < norms[rank]; ++i) {
+            spread[position] = rank;
+            position = (position + step) & mask;
+        }
+    }
+}
+
+void ANSEncodeTable::Build(const Array<uint32_t>& norms, const uint32_t tableLog)
+{
+    tableLog_ = tableLog;
+    const uint32_t tableSize = 1u << tableLog;
+    ANSTable::Spread(norms, tableLog, spread_);
+
+    // states of every symbol in ascending order of positions (the same order as decoder assigns them)
+    transforms_.clear();
+    cursor_.clear();
+    uint32_t start = 0;
+    for (const uint32_t& norm : norms) {
+        const uint32_t maxBits = tableLog - ANSTable::HighestBit(norm);
+        transforms_.push_back(symbolTransform{ (maxBits << 16) - (norm << maxBits), static_cast<int32_t>(start) - static_cast<int32_t>(norm) });
+        cursor_.push_back(start);
+        start += norm;
+    }
+    states_.clear();
+    for (uint32_t i = 0; i < tableSize; ++i) {
+        states_.push_back(0);
+    }
+    for (uint32_t position = 0; position < tableSize; ++position) {
+        states_[cursor_[spread_[position]]++] = tableSize + position;
+    }
+}
+
+template <typename charType>
+void ANSDecodeTable<charType>::Build(const Array<charType>& symbols, const Array<uint32_t>& norms, const uint32_t tableLog)
+{
+    tableLog_ = tableLog;
+    const uint32_t tableSize = 1u << tableLog;
+    ANSTable::Spread(norms, tableLog, spread_);
+
+    // the k-th state of symbol s gets x = norm[s] + k, then the next state is (x << length) - tableSize + bits
+    next_.clear();
+    for (const uint32_t& norm : norms) {
+        next_.push_back(norm);
+    }
+    table_.clear();
+    for (uint32_t position = 0; position < tableSize; ++position) {
+        const uint32_t rank = spread_[position];
+        const uint32_t x = next_[rank]++;
+        const uint32_t length = tableLog - ANSTable::HighestBit(x);
+        table_.push_back(entry{ (x << length) - tableSize, symbols[rank], static_cast<uint8_t>(length) });
+    }
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
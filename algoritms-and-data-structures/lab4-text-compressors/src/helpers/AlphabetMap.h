@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#include "StringL.h"
+#include "Array.h"
+
+
+/**
+ * AlphabetMap.
+ *
+ * Brief:
+ * - Class maps characters used in a string to dense ranks 0..k-1 (in ascending order of characters) and back
+ *
+ * Parameters:
+ * - charType - The unsigned type of the characters in the string (unsigned char, char16_t/unsigned short , char32_t/unsigned int).
+ *
+ * Memory usage:
+ * O(usedPages * 2^PAGE_BITS + maxChar / 2^PAGE_BITS + alphabetSize)
+ *
+ * Details:
+ * - Ranks are kept in pages of 2^PAGE_BITS characters, pages are allocated only for used ranges of code points,
+ *   so Rank() is two array lookups for any width of characters (a Russian text uses 2-3 pages)
+ * - Characters beyond Unicode range (MAX_PAGES) are ranked by binary search in the sorted alphabet
+ * - Ranks fit into charType, so strings can be remapped in place (ToRanks() / FromRanks()),
+ *   then encoders use arrays of alphabetSize elements indexed by characters
+ * - Build() also counts characters and reuses memory of the previous map
+ */
+template <typename charType>
+class AlphabetMap
+{
+public:
+    static const uint32_t PAGE_BITS = 8;
+    static const size_t MAX_PAGES = (0x10FFFF >> PAGE_BITS) + 1;
+
+    AlphabetMap() : sparse_(false) {}
+    AlphabetMap(const charType* chars, const size_t size) : sparse_(false) { Build(chars, size); }
+    explicit AlphabetMap(const StringL<charType>& str) : sparse_(false) { Build(str.c_str(), str.size()); }
+
+    inline void Build(const charType* chars, const size_t size);
+
+    size_t Size() const { return symbols_.size(); }
+    inline bool Contains(const charType c) const;
+    // rank of the character (the character should be in the alphabet)
+    inline uint32_t Rank(const charType c) const;
+    charType Symbol(const uint32_t rank) const { return symbols_[rank]; }
+    // characters in ascending order
+    const Array<charType>& GetSymbols() const { return symbols_; }
+    // numbers of characters in order of ranks
+    const Array<uint32_t>& GetCounts() const { return counts_; }
+
+    // replace characters by their ranks / ranks by characters
+    inline void ToRanks(const charType* chars, const size_t size, charType* ranks) const;
+    inline void FromRanks(const charType* ranks, const size_t size, charType* chars) const;
+
+    void FreeMemory() { pageOf_.free_memory(); ranks_.free_memory(); symbols_.free_memory(); counts_.free_memory(); }
+private:
+    static const uint32_t NO_PAGE = UINT32_MAX;
+    static const size_t PAGE_MASK = (static_cast<size_t>(1) << PAGE_BITS) - 1;
+
+    Array<uint32_t> pageOf_; // index of the page of every range of code points (NO_PAGE - not used)
+    Array<uint32_t> ranks_; // pages of ranks
+    Array<charType> symbols_;
+    Array<uint32_t> counts_;
+    bool sparse_;
+};
+
+
+// START IMPLEMENTATION
+
+template <typename charType>
+void AlphabetMap<charType>::Build(const charType* chars, const size_t size)
+{
+    symbols_.clear();
+    counts_.clear();
+    pageOf_.clear();
+    ranks_.clear();
+
+    charType maxChar = 0;
+    for (size_t i = 0; i < size; ++i) {
+        maxChar = std::max(maxChar, chars[i]);
+    }
+    const size_t pagesCount = (static_cast<size_t>(maxChar) >> PAGE_BITS) + 1;
+    sparse_ = pagesCount > MAX_PAGES;
+
+    if (sparse_) {
+        // sorted unique characters, counts by binary search
+        for (size_t i = 0; i < size; ++i) {
+            symbols_.push_back(chars[i]);
+        }
+        std::sort(symbols_.begin(), symbols_.end());
+        const size_t uniqueCount = std::unique(symbols_.begin(), symbols_.end()) - symbols_.begin();
+        while (symbols_.size() > uniqueCount) symbols_.pop_back();
+        for (size_t i = 0; i < symbols_.size(); ++i) {
+            counts_.push_back(0);
+        }
+        for (size_t i = 0; i < size; ++i) {
+            ++counts_[Rank(chars[i])];
+        }
+        return;
+    }
+
+    // allocate pages of used ranges and count characters in them
+    for (size_t p = 0; p < pagesCount; ++p) {
+        pageOf_.push_back(NO_PAGE);
+    }
+    uint32_t usedPages = 0;
+    for (size_t i = 0; i < size; ++i) {
+        const size_t p = static_cast<size_t>(chars[i]) >> PAGE_BITS;
+        if (pageOf_[p] == NO_PAGE) {
+            pageOf_[p] = usedPages++;
+            for (size_t j = 0; j <= PAGE_MASK; ++j) {
+                ranks_.push_back(0);
+            }
+        }
+        ++ranks_[(static_cast<size_t>(pageOf_[p]) << PAGE_BITS) | (static_cast<size_t>(chars[i]) & PAGE_MASK)];
+    }
+
+    // replace counts by ranks in ascending order of characters
+    uint32_t rank = 0;
+    for (size_t p = 0; p < pagesCount; ++p) {
+        if (pageOf_[p] == NO_PAGE) continue;
+        uint32_t* page = &ranks_[static_cast<size_t>(pageOf_[p]) << PAGE_BITS];
+        for (size_t j = 0; j <= PAGE_MASK; ++j) {
+            if (page[j] == 0) continue;
+            symbols_.push_back(static_cast<charType>((p << PAGE_BITS) | j));
+            counts_.push_back(page[j]);
+            page[j] = rank++;
+        }
+    }
+}
+
+template <typename charType>
+uint32_t AlphabetMap<charType>::Rank(const charType c) const
+{
+    if (sparse_) {
+        return static_cast<uint32_t>(std::lower_bound(symbols_.begin(), symbols_.end(), c) - symbols_.begin());
+    }
+    const size_t p = static_cast<size_t>(c) >> PAGE_BITS;
+    return ranks_[(static_cast<size_t>(pageOf_[p]) << PAGE_BITS) | (static_cast<size_t>(c) & PAGE_MASK)];
+}
+
+template <typename charType>
+bool AlphabetMap<charType>::Contains(const charType c) const
+{
+    if (sparse_) {
+        return std::binary_search(symbols_.begin(), symbols_.end(), c);
+    }
+    // unused characters of used pages have rank 0
+    const size_t p = static_cast<size_t>(c) >> PAGE_BITS;
+    return p < pageOf_.size() && pageOf_[p] != NO_PAGE && symbols_[Rank(c)] == c;
+}
+
+template <typename charType>
+void AlphabetMap<charType>::ToRanks(const charType* chars, const size_t size, charType* ranks) const
+{
+    for (size_t i = 0; i < size; ++i) {
+        ranks[i] = static_cast<charType>(Rank(chars[i]));
+    }
+}
+
+template <typename charType>
+void AlphabetMap<charType>::FromRanks(const charType* ranks, const size_t size, charType* chars) const
+{
+    for (size_t i = 0; i < size; ++i) {
+        chars[i] = symbols_[ranks[i]];
+    }
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
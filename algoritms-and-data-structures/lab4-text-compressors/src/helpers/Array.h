@@ -1,6 +1,8 @@
 #ifndef ARRAY_H
 #define ARRAY_H
 
+#include "MemoryStats.h"
+
 /**
  * Array.
  * 
@@ -21,6 +23,7 @@
  * - ! For optimization purposes, this class does not perform bounds checking on the operator[] and assign() functions. Accessing an index outside the array's bounds or attempting to access an empty element may result in undefined behavior. Use with caution !
  * - To preallocate memory, use constructor or resize() method.
  * - If you worry about optimization so always use resize() or corresponding contructor to preallocate memory for the entire array
+ * - All memory is allocated and deleted by allocate() / deallocate() which report it to MemoryStats (if its accounting is enabled)
  * 
  */
 template <typename T>
@@ -30,53 +33,59 @@ private:
     T* data_;
     size_t size_;
     size_t capacity_;
+
+    static T* allocate(const size_t count) {
+        MemoryStats::OnAllocate(count * sizeof(T));
+        return new T[count];
+    }
+    static void deallocate(T* data, const size_t count) {
+        if (data == nullptr) return;
+        MemoryStats::OnFree(count * sizeof(T));
+        delete[] data;
+    }
 public:
     Array(): data_(nullptr), size_(0), capacity_(0) {}
-    Array(const size_t size): data_(new T[size]), size_(0), capacity_(size) {
-        if (size == 0) data_ = nullptr;
-    }
-    Array(const Array<T>& other): data_(new T[other.size()]), size_(other.size()), capacity_(other.size()) {
-        if (other.c_arr() == nullptr || other.size() == 0) {
-            if (data_ != nullptr) delete[] data_;
-            data_ = nullptr;
-            size_ = 0; capacity_ = 0;
-        } else {
+    Array(const size_t size): data_(size > 0 ? allocate(size) : nullptr), size_(0), capacity_(size) {}
+    Array(const Array<T>& other): data_(nullptr), size_(0), capacity_(0) {
+        if (other.c_arr() != nullptr && other.size() > 0) {
+            data_ = allocate(other.size());
+            size_ = other.size(); capacity_ = other.size();
+            MemoryStats::OnCopy(other.size() * sizeof(T));
             for (size_t i = 0; i < other.size(); ++i) {
                 data_[i] = other[i];
             }
         }
     }
-    Array(const T* data, const size_t size): data_(new T[size]), size_(size), capacity_(size) {
+    Array(const T* data, const size_t size): data_(allocate(size)), size_(size), capacity_(size) {
         for (size_t i = 0; i < size; ++i) {
             data_[i] = data[i];
         }
     }
-    Array(std::initializer_list<T> values) : data_(new T[values.size()]), size_(values.size()), capacity_(values.size()) {
+    Array(std::initializer_list<T> values) : data_(allocate(values.size())), size_(values.size()), capacity_(values.size()) {
         std::copy(values.begin(), values.end(), data_);
     }
 
-    Array(const size_t size, const T value): data_(new T[size]), size_(size), capacity_(size) {
+    Array(const size_t size, const T value): data_(size > 0 ? allocate(size) : nullptr), size_(size), capacity_(size) {
         for (size_t i = 0; i < size; ++i) {
             data_[i] = value;
         }
-        if (size == 0) data_ = nullptr;
     }
 
     void resize(const size_t size) {
         if (data_ != nullptr) {
             if (size == 0) {
-                delete[] data_;
+                deallocate(data_, capacity_);
                 data_ = nullptr;
             } else {
-                T* newdata_ = new T[size];
+                T* newdata_ = allocate(size);
                 for (size_t i = 0; i < std::min(size, size_); ++i)
                     newdata_[i] = data_[i];
                 
-                delete[] data_;
+                deallocate(data_, capacity_);
                 data_ = newdata_;
             }
         } else {
-            data_ = new T[size];
+            data_ = allocate(size);
         }
         size_ = std::min(size_, size);
         capacity_ = size;
@@ -87,6 +96,7 @@ public:
             data_[size_++] = value;
         } else {
             // if size_ == capacity_
+            const size_t oldCapacity = capacity_;
 
             // calculate next degree of 2 which is greater than capacity_
             int degree = 0;
@@ -101,12 +111,12 @@ public:
             while (degree-- > 0) capacity_ *= 2;
 
             // reallocate memory
-            T* newdata_ = new T[capacity_];
+            T* newdata_ = allocate(capacity_);
             for (size_t i = 0; i < size_; ++i) {
                 newdata_[i] = data_[i];
             }
             newdata_[size_++] = value;
-            delete[] data_;
+            deallocate(data_, oldCapacity);
             data_ = newdata_;
         }
     }
@@ -134,16 +144,17 @@ public:
     }
 
     Array<T> copy() const {
+        MemoryStats::OnCopy(size_ * sizeof(T));
         return Array<T>(data_, size_);
     }
 
     void fit_to_size() {
         if (size_ < capacity_) {
-            T* newdata_ = new T[size_];
+            T* newdata_ = allocate(size_);
             for (size_t i = 0; i < size_; ++i) {
                 newdata_[i] = data_[i];
             }
-            delete[] data_;
+            deallocate(data_, capacity_);
             data_ = newdata_;
             capacity_ = size_;
         }
@@ -185,8 +196,9 @@ public:
 
     Array<T>& operator=(const Array<T>& other) {
         if (this != &other) {
-            if (data_ != nullptr) delete[] data_;
-            data_ = new T[other.size()];
+            deallocate(data_, capacity_);
+            data_ = allocate(other.size());
+            MemoryStats::OnCopy(other.size() * sizeof(T));
             size_ = other.size();
             capacity_ = other.size();
             for (size_t i = 0; i < other.size(); ++i) {
@@ -229,18 +241,14 @@ public:
     }
 
     inline void free_memory() {
-        if (data_ != nullptr) {
-            delete[] data_;
-            data_ = nullptr;
-        }
+        deallocate(data_, capacity_);
+        data_ = nullptr;
         size_ = 0;
         capacity_ = 0;
     }
 
     ~Array() {
-        if (data_ != nullptr) {
-            delete[] data_;
-        }    
+        deallocate(data_, capacity_);
     }
 };
 
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "Array.h"
+
+
+/**
+ * BitWriter / BitReader.
+ *
+ * Brief:
+ * - Classes define fast MSB-first bit streams over byte arrays which are used by table-driven codecs
+ *
+ * Memory usage:
+ * O(1) (+ output array for BitWriter)
+ *
+ * Details:
+ * - Bits are kept in a 64-bit buffer, so codes up to 32 bits are written / read by one call
+ * - The last partial byte is padded by zeros from the right (the same as BitArray::to_file())
+ * - BitReader returns zero bits after the end of the data, so reading the padding is safe
+ */
+class BitWriter
+{
+private:
+    Array<uint8_t>& output_;
+    uint64_t buffer_;
+    uint32_t count_; // number of bits in the buffer (always < 8 between calls)
+public:
+    BitWriter(Array<uint8_t>& output) : output_(output), buffer_(0), count_(0) {}
+
+    // writes the lowest "length" bits of code (length <= 32)
+    inline void Write(const uint32_t code, const uint32_t length)
+    {
+        buffer_ = (buffer_ << length) | code;
+        count_ += length;
+        while (count_ >= 8) {
+            count_ -= 8;
+            output_.push_back(static_cast<uint8_t>(buffer_ >> count_));
+        }
+    }
+
+    // writes the last partial byte
+    inline void Flush()
+    {
+        if (count_ > 0) {
+            output_.push_back(static_cast<uint8_t>(buffer_ << (8 - count_)));
+            count_ = 0;
+        }
+        buffer_ = 0;
+    }
+};
+
+class BitReader
+{
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t position_; // next byte to load into the buffer
+    uint64_t buffer_; // the next bit of the stream is the highest bit of the buffer
+    uint32_t count_;  // number of valid bits in the buffer
+
+    // ensures that at least 57 bits are available in the buffer
+    inline void refill()
+    {
+        if (position_ + 8 <= size_) {
+            // fast path: load bytes without bounds checks
+            while (count_ <= 56) {
+                buffer_ |= static_cast<uint64_t>(data_[position_++]) << (56 - count_);
+                count_ += 8;
+            }
+        } else {
+            while (count_ <= 56) {
+                uint8_t byte = (position_ < size_) ? data_[position_] : 0;
+                ++position_;
+                buffer_ |= static_cast<uint64_t>(byte) << (56 - count_);
+                count_ += 8;
+            }
+        }
+    }
+public:
+    BitReader() : data_(nullptr), size_(0), position_(0), buffer_(0), count_(0) {}
+    BitReader(const uint8_t* data, const size_t size) : data_(data), size_(size), position_(0), buffer_(0), count_(0)
+    {
+        refill();
+    }
+
+    // returns next "length" bits without consuming them (1 <= length <= 32)
+    inline uint32_t Peek(const uint32_t length) const
+    {
+        return static_cast<uint32_t>(buffer_ >> (64 - length));
+    }
+
+    inline void Skip(const uint32_t length)
+    {
+        buffer_ <<= length;
+        count_ -= length;
+        if (count_ < 32) refill();
+    }
+
+    // returns and consumes next "length" bits (0 <= length <= 32)
+    inline uint32_t Read(const uint32_t length)
+    {
+        const uint32_t value = static_cast<uint32_t>((buffer_ >> 1) >> (63 - length));
+        Skip(length);
+        return value;
+    }
+};
\ No newline at end of file
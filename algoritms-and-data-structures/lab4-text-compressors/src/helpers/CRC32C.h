@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE4_2__) || defined(__AVX__)
+    #include <nmmintrin.h>
+    #define CRC32C_HARDWARE
+#endif
+
+
+/**
+ * CRC32C.
+ *
+ * Brief:
+ * - Class defines static method to calculate CRC-32C (Castagnoli) checksum of byte array
+ *
+ * Memory usage:
+ * O(1) (+ 8 KB of tables for software version)
+ *
+ * Details:
+ * - If SSE4.2 is available the crc32 instruction is used (8 bytes per instruction), otherwise slicing-by-8 tables are used
+ * - Compute() can continue previous checksum: Compute(b, Compute(a)) == Compute(a + b)
+ */
+class CRC32C
+{
+private:
+    CRC32C() = default;
+
+    static const uint32_t POLYNOMIAL = 0x82F63B78; // reversed 0x1EDC6F41
+
+    // tables[k][b] - CRC of byte b followed by k zero bytes
+    struct tables {
+        uint32_t values[8][256];
+        inline tables();
+    };
+    static inline const uint32_t* getTables();
+public:
+    static inline uint32_t Compute(const void* data, const size_t size, const uint32_t previousCrc = 0);
+};
+
+
+// START IMPLEMENTATION
+
+CRC32C::tables::tables()
+{
+    for (uint32_t b = 0; b < 256; ++b) {
+        uint32_t crc = b;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ POLYNOMIAL : (crc >> 1);
+        }
+        values[0][b] = crc;
+    }
+    for (uint32_t b = 0; b < 256; ++b) {
+        for (int k = 1; k < 8; ++k) {
+            values[k][b] = (values[k - 1][b] >> 8) ^ values[0][values[k - 1][b] & 0xFF];
+        }
+    }
+}
+
+const uint32_t* CRC32C::getTables()
+{
+    static const tables instance; // initialized once (thread-safe)
+    return &instance.values[0][0];
+}
+
+uint32_t CRC32C::Compute(const void* data, const size_t size, const uint32_t previousCrc)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    size_t i = 0;
+
+#if defined(CRC32C_HARDWARE)
+    #if defined(__x86_64__) || defined(_M_X64)
+    uint64_t crc64 = static_cast<uint32_t>(~previousCrc);
+    while (i + 8 <= size) {
+        uint64_t value;
+        std::memcpy(&value, bytes + i, 8);
+        crc64 = _mm_crc32_u64(crc64, value);
+        i += 8;
+    }
+    uint32_t crc = static_cast<uint32_t>(crc64);
+    #else
+    uint32_t crc = ~previousCrc;
+    #endif
+    while (i < size) {
+        crc = _mm_crc32_u8(crc, bytes[i++]);
+    }
+    return ~crc;
+#else
+    const uint32_t* tables = getTables();
+    uint32_t crc = ~previousCrc;
+
+    // slicing-by-8: 8 bytes are processed by 8 independent table lookups
+    while (i + 8 <= size) {
+        uint32_t low = crc ^ (static_cast<uint32_t>(bytes[i]) | (static_cast<uint32_t>(bytes[i + 1]) << 8) |
+                              (static_cast<uint32_t>(bytes[i + 2]) << 16) | (static_cast<uint32_t>(bytes[i + 3]) << 24));
+        crc = tables[7 * 256 + (low & 0xFF)] ^ tables[6 * 256 + ((low >> 8) & 0xFF)] ^
+              tables[5 * 256 + ((low >> 16) & 0xFF)] ^ tables[4 * 256 + (low >> 24)] ^
+              tables[3 * 256 + bytes[i + 4]] ^ tables[2 * 256 + bytes[i + 5]] ^
+              tables[1 * 256 + bytes[i + 6]] ^ tables[0 * 256 + bytes[i + 7]];
+        i += 8;
+    }
+    while (i < size) {
+        crc = (crc >> 8) ^ tables[(crc ^ bytes[i++]) & 0xFF];
+    }
+    return ~crc;
+#endif
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include "CRC32C.h"
+#include "Array.h"
+
+
+/**
+ * ChunkStore.
+ *
+ * Brief:
+ * - Class defines store of chunk fingerprints which finds a previously stored chunk equal to the given one
+ *
+ * Memory usage:
+ * θ(chunksCount)
+ *
+ * Details:
+ * - Chunks are kept by the caller one after another in a storage (only their offsets and sizes are stored here),
+ *   the storage is passed to every call because it may be reallocated between calls
+ * - Fingerprint of a chunk: CRC-32C of its bytes and its size. Chunks with equal fingerprints are compared byte by byte,
+ *   so a collision never merges different chunks
+ * - Fingerprints are kept in an open addressing table (linear probing, at most half full)
+ */
+class ChunkStore
+{
+public:
+    static const uint32_t NOT_FOUND = UINT32_MAX;
+
+    ChunkStore() = default;
+
+    // returns id of the stored chunk equal to data or adds data (which will be written to storage + storageSize) as a new chunk,
+    // isNew - the chunk is new (the caller should write it to the storage)
+    inline uint32_t FindOrAdd(const uint8_t* data, const size_t size, const uint8_t* storage, const uint64_t storageSize, bool& isNew);
+
+    size_t Size() const { return chunks_.size(); }
+    uint64_t GetOffset(const uint32_t id) const { return chunks_[id].offset; }
+    uint32_t GetSize(const uint32_t id) const { return chunks_[id].size; }
+
+    static inline uint64_t Fingerprint(const uint8_t* data, const size_t size);
+private:
+    static const size_t INITIAL_TABLE_SIZE = 1024;
+
+    struct chunk {
+        uint64_t fingerprint;
+        uint64_t offset; // in the storage
+        uint32_t size;
+    };
+
+    Array<chunk> chunks_;
+    Array<uint32_t> table_; // ids of chunks (NOT_FOUND - empty slot), the size is a power of two
+
+    static inline size_t slot(const uint64_t fingerprint, const size_t tableSize) {
+        return static_cast<size_t>((fingerprint * 0x9E3779B97F4A7C15ull) >> 32) & (tableSize - 1);
+    }
+    inline void rebuild(const size_t tableSize);
+};
+
+
+// START IMPLEMENTATION
+
+uint64_t ChunkStore::Fingerprint(const uint8_t* data, const size_t size)
+{
+    return (static_cast<uint64_t>(CRC32C::Compute(data, size)) << 32) | static_cast<uint32_t>(size);
+}
+
+uint32_t ChunkStore::FindOrAdd(const uint8_t* data, const size_t size, const uint8_t* storage, const uint64_t storageSize, bool& isNew)
+{
+    if (size > UINT32_MAX) {
+        throw std::invalid_argument("ChunkStore: Chunk is too large!");
+    }
+    if (table_.size() == 0) {
+        rebuild(INITIAL_TABLE_SIZE);
+    }
+
+    const uint64_t fingerprint = Fingerprint(data, size);
+    const size_t mask = table_.size() - 1;
+    size_t position = slot(fingerprint, table_.size());
+    for (; table_[position] != NOT_FOUND; position = (position + 1) & mask) {
+        const chunk& stored = chunks_[table_[position]];
+        if (stored.fingerprint == fingerprint && std::memcmp(storage + stored.offset, data, size) == 0) {
+            isNew = false;
+            return table_[position];
+        }
+    }
+
+    if (chunks_.size() >= NOT_FOUND) {
+        throw std::runtime_error("ChunkStore: Too many chunks!");
+    }
+    const uint32_t id = static_cast<uint32_t>(chunks_.size());
+    chunks_.push_back(chunk{ fingerprint, storageSize, static_cast<uint32_t>(size) });
+    table_[position] = id;
+    if (2 * chunks_.size() > table_.size()) {
+        rebuild(2 * table_.size());
+    }
+    isNew = true;
+    return id;
+}
+
+void ChunkStore::rebuild(const size_t tableSize)
+{
+    table_ = Array<uint32_t>(tableSize, NOT_FOUND);
+    const size_t mask = tableSize - 1;
+    for (uint32_t id = 0; id < chunks_.size(); ++id) {
+        size_t position = slot(chunks_[id].fingerprint, tableSize);
+        while (table_[position] != NOT_FOUND) {
+            position = (position + 1) & mask;
+        }
+        table_[position] = id;
+    }
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
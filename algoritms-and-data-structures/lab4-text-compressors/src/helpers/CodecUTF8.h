@@ -29,6 +29,10 @@ public:
     // decodes any unsigned <charType> value from file (using utf-8 encoding)
     template <typename charType>
     static inline const charType DecodeCharFromBinaryFile(std::ifstream& file);
+
+    // returns number of bytes in utf-8 representation of <charType> value
+    template <typename charType>
+    static inline const size_t GetEncodedCharLength(const charType& code_point);
 private:
     // encodes any unsigned <charType> value to std::string
     template <typename charType>
@@ -338,4 +342,15 @@ const charType CodecUTF8::DecodeCharFromBinaryFile(std::ifstream& file)
     return c;
 }
 
+// returns number of bytes in utf-8 representation of <charType> value
+template <typename charType>
+const size_t CodecUTF8::GetEncodedCharLength(const charType& code_point)
+{
+    if (code_point <= 0x007F) return 1;
+    if (code_point <= 0x07FF) return 2;
+    if (code_point <= 0xFFFF) return 3;
+    if (code_point <= 0x10FFFF) return 4;
+    return 0;
+}
+
 // END IMPLEMENTATION
\ No newline at end of file
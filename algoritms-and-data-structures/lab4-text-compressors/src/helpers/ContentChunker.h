@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+#include "Array.h"
+
+
+/**
+ * ContentChunker.
+ *
+ * Brief:
+ * - Class defines static method to split data into content-defined chunks (Gear rolling hash with normalized chunking, as in FastCDC)
+ *
+ * Memory usage:
+ * θ(chunksCount) (+ 2 KB of the gear table)
+ *
+ * Details:
+ * - A chunk ends where the rolling hash of the last bytes has zero in the masked bits, so borders depend only on the nearby content:
+ *   an insertion moves borders of the chunks around it only, the other chunks stay equal and can be deduplicated
+ * - Gear hash: hash = (hash << 1) + GEAR[byte], every byte leaves the hash after 64 steps, the mask takes the highest bits
+ * - Chunks are in [averageSize / 4, averageSize * 8] bytes (the last chunk may be shorter). Before averageSize the mask has 2 more bits,
+ *   after it 2 less bits (normalized chunking), so sizes concentrate around averageSize
+ * - The gear table is generated by splitmix64 with a fixed seed, so borders are the same in every run
+ */
+class ContentChunker
+{
+private:
+    ContentChunker() = default;
+
+    struct gearTable {
+        uint64_t values[256];
+        inline gearTable();
+    };
+    static inline const uint64_t* getGear();
+    static inline uint64_t getMask(const uint32_t bits);
+public:
+    static const size_t MIN_AVERAGE_SIZE = 256;
+    static const size_t MAX_AVERAGE_SIZE = 1 << 22;
+
+    // ends of chunks (the last one is size), averageSize should be a power of two (0 - the whole data is one chunk)
+    static inline void Split(const uint8_t* data, const size_t size, const size_t averageSize, Array<size_t>& chunkEnds);
+};
+
+
+// START IMPLEMENTATION
+
+ContentChunker::gearTable::gearTable()
+{
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (uint32_t i = 0; i < 256; ++i) {
+        state += 0x9E3779B97F4A7C15ull;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        values[i] = z ^ (z >> 31);
+    }
+}
+
+const uint64_t* ContentChunker::getGear()
+{
+    static const gearTable instance; // initialized once (thread-safe)
+    return instance.values;
+}
+
+uint64_t ContentChunker::getMask(const uint32_t bits)
+{
+    return (bits == 0) ? 0 : (~static_cast<uint64_t>(0) << (64 - bits));
+}
+
+void ContentChunker::Split(const uint8_t* data, const size_t size, const size_t averageSize, Array<size_t>& chunkEnds)
+{
+    chunkEnds.clear();
+    if (size == 0) return;
+    if (averageSize == 0) {
+        chunkEnds.push_back(size);
+        return;
+    }
+    if (averageSize < MIN_AVERAGE_SIZE || averageSize > MAX_AVERAGE_SIZE || (averageSize & (averageSize - 1)) != 0) {
+        throw std::invalid_argument("ContentChunker: Average chunk size should be a power of two in [256, 2^22]!");
+    }
+
+    uint32_t averageBits = 0;
+    while ((static_cast<size_t>(1) << averageBits) < averageSize) ++averageBits;
+    const uint64_t smallMask = getMask(averageBits + 2); // harder to cut before averageSize
+    const uint64_t largeMask = getMask(averageBits - 2); // easier to cut after it
+    const size_t minSize = averageSize / 4;
+    const size_t maxSize = averageSize * 8;
+    const uint64_t* gear = getGear();
+
+    size_t start = 0;
+    while (start < size) {
+        const size_t left = size - start;
+        if (left <= minSize) {
+            chunkEnds.push_back(size);
+            break;
+        }
+        const size_t normalEnd = start + ((left < averageSize) ? left : averageSize);
+        const size_t maxEnd = start + ((left < maxSize) ? left : maxSize);
+
+        // a chunk can't end before minSize, so hashing starts there
+        uint64_t hash = 0;
+        size_t i = start + minSize;
+        bool cut = false;
+        for (; i < normalEnd && !cut; ++i) {
+            hash = (hash << 1) + gear[data[i]];
+            cut = (hash & smallMask) == 0;
+        }
+        for (; i < maxEnd && !cut; ++i) {
+            hash = (hash << 1) + gear[data[i]];
+            cut = (hash & largeMask) == 0;
+        }
+        const size_t end = i; // the byte which made the cut belongs to the chunk
+        chunkEnds.push_back(end);
+        start = end;
+    }
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <algorithm>
+
+#include "AlphabetMap.h"
+#include "RankBitVector.h"
+#include "WaveletTree.h"
+#include "StringL.h"
+#include "Array.h"
+
+
+/**
+ * FMIndex.
+ *
+ * Brief:
+ * - Class defines an FM-index built from the Burrows-Wheeler transform of a text (CodecBWT output):
+ *   Count() and Locate() find occurrences of a pattern without inverse transform of the text
+ *
+ * Parameters:
+ * - charType - The unsigned type of the characters in the string (unsigned char, char16_t/unsigned short , char32_t/unsigned int).
+ *
+ * Memory usage:
+ * alphabetSize <= MAX_TABLE_ALPHABET_SIZE: θ(n + 4 * alphabetSize * n / OCC_SAMPLE_RATE) bytes
+ * otherwise: θ(n * log(alphabetSize) * 3 / 16) bytes
+ * + θ(3 * n / 16 + 4 * n / SA_SAMPLE_RATE) bytes of the sampled suffix array
+ *
+ * Details:
+ * - The BWT is of "text + '\0'", n = text length + 1. The end marker '\0' (at the row "index" of the BWT) is the unique smallest symbol,
+ *   the text can have its own '\0' characters: the marker has the rank 0 together with them in the alphabet, but the row "index" isn't counted
+ *   by Occ and C[c] counts the marker before every character of the text (the row 0 is the suffix of the marker alone)
+ * - Backward search: for every character c of the pattern from the end, the range of rows [begin, end) becomes
+ *   [C[c] + Occ(c, begin), C[c] + Occ(c, end)), where C[c] is the number of characters less than c and Occ(c, i) is the number of c in BWT[0, i)
+ * - Small alphabets: BWT is kept as ranks of characters, Occ of every character is sampled every OCC_SAMPLE_RATE rows,
+ *   Occ(c, i) adds the count of c between i and the nearest sample (not more than OCC_SAMPLE_RATE / 2 characters are scanned)
+ * - Large alphabets (wide char32 texts): Occ is answered by a wavelet tree over ranks of characters in θ(log(alphabetSize))
+ * - Suffix array is sampled every SA_SAMPLE_RATE positions of the text (rows of samples are marked in a RankBitVector), the samples are
+ *   found by one LF walk over the text while building. Locate() walks LF from every row of the range to a sampled row (less than SA_SAMPLE_RATE steps)
+ */
+template <typename charType>
+class FMIndex
+{
+public:
+    static const size_t OCC_SAMPLE_RATE = 128;
+    static const size_t SA_SAMPLE_RATE = 32;
+    static const size_t MAX_TABLE_ALPHABET_SIZE = 256; // ranks of characters fit into uint8_t
+
+    FMIndex() : index_(0), size_(0), useWaveletTree_(false) {}
+    FMIndex(const StringL<charType>& bwt, const uint32_t index) : index_(0), size_(0), useWaveletTree_(false) { Build(bwt, index); }
+
+    // bwt - BWT of "text + '\0'", index - the row of the text (the row with '\0' at the end)
+    void Build(const StringL<charType>& bwt, const uint32_t index);
+
+    // length of the text
+    size_t TextSize() const { return (size_ > 0) ? size_ - 1 : 0; }
+    // number of occurrences of the pattern in the text (0 for an empty pattern)
+    size_t Count(const StringL<charType>& pattern) const;
+    // positions of occurrences of the pattern in the text in ascending order
+    Array<uint32_t> Locate(const StringL<charType>& pattern) const;
+private:
+    // range of rows which start with the pattern, false - there are no such rows
+    bool findRange(const StringL<charType>& pattern, uint32_t& begin, uint32_t& end) const;
+    // number of characters with the rank in BWT[0, row) except the end marker
+    inline uint32_t occurrences(const uint32_t rank, const uint32_t row) const;
+    // row of the suffix which starts one position earlier
+    inline uint32_t lf(const uint32_t row) const;
+
+    AlphabetMap<charType> alphabet_;
+    Array<uint32_t> C_; // number of characters with smaller ranks
+    Array<uint8_t> bwtRanks_; // small alphabets: BWT as ranks
+    Array<uint32_t> occ_; // small alphabets: Occ of every rank at every OCC_SAMPLE_RATE row
+    WaveletTree wavelet_; // large alphabets: BWT as ranks
+    RankBitVector sampled_; // rows with sampled suffix array values
+    Array<uint32_t> samples_; // values of the suffix array in order of the rows
+    uint32_t index_;
+    size_t size_;
+    bool useWaveletTree_;
+};
+
+
+// START IMPLEMENTATION
+
+template <typename charType>
+void FMIndex<charType>::Build(const StringL<charType>& bwt, const uint32_t index)
+{
+    if (bwt.size() == 0 || index >= bwt.size() || bwt.size() > UINT32_MAX) {
+        throw std::invalid_argument("FMIndex: Invalid BWT!");
+    }
+    if (bwt[index] != '\0') {
+        throw std::invalid_argument("FMIndex: Invalid BWT (no end marker at the index)!");
+    }
+    size_ = bwt.size();
+    index_ = index;
+
+    alphabet_.Build(bwt.c_str(), size_);
+    const size_t alphabetSize = alphabet_.Size();
+    C_.clear();
+    // the end marker has the rank 0 (it's the smallest character) and is counted by counts of the rank 0, it's before every character
+    uint32_t total = 0;
+    for (const uint32_t& count : alphabet_.GetCounts()) {
+        C_.push_back(total);
+        total += count;
+    }
+    C_[0] = 1;
+
+    // occurrence tables or the wavelet tree
+    useWaveletTree_ = alphabetSize > MAX_TABLE_ALPHABET_SIZE;
+    bwtRanks_.clear();
+    occ_.clear();
+    if (useWaveletTree_) {
+        Array<uint32_t> ranks(size_);
+        for (size_t i = 0; i < size_; ++i) {
+            ranks.push_back(alphabet_.Rank(bwt[i]));
+        }
+        wavelet_.Build(ranks.c_arr(), size_, static_cast<uint32_t>(alphabetSize));
+    } else {
+        Array<uint32_t> counts(alphabetSize, 0);
+        for (size_t i = 0; i <= size_; ++i) {
+            if (i % OCC_SAMPLE_RATE == 0) {
+                for (const uint32_t& count : counts) {
+                    occ_.push_back(count);
+                }
+            }
+            if (i < size_) {
+                const uint32_t rank = alphabet_.Rank(bwt[i]);
+                bwtRanks_.push_back(static_cast<uint8_t>(rank));
+                ++counts[rank];
+            }
+        }
+    }
+
+    // sampled suffix array: the row "index" is the position 0, LF goes to positions n - 1, n - 2, ..., 1
+    const size_t textSize = size_ - 1;
+    Array<uint32_t> sampleRows(textSize / SA_SAMPLE_RATE + 1, 0);
+    sampled_.Reset(size_);
+    uint32_t row = index_;
+    sampled_.Set(row);
+    sampleRows[0] = row;
+    for (size_t position = textSize; position > 0; --position) {
+        row = lf(row);
+        if (position % SA_SAMPLE_RATE == 0) {
+            sampled_.Set(row);
+            sampleRows[position / SA_SAMPLE_RATE] = row;
+        }
+    }
+    sampled_.BuildRanks();
+    samples_.clear();
+    for (size_t i = 0; i < sampleRows.size(); ++i) {
+        samples_.push_back(0);
+    }
+    for (size_t i = 0; i < sampleRows.size(); ++i) {
+        samples_[sampled_.Rank(sampleRows[i])] = static_cast<uint32_t>(i * SA_SAMPLE_RATE);
+    }
+}
+
+template <typename charType>
+size_t FMIndex<charType>::Count(const StringL<charType>& pattern) const
+{
+    uint32_t begin, end;
+    return findRange(pattern, begin, end) ? end - begin : 0;
+}
+
+template <typename charType>
+Array<uint32_t> FMIndex<charType>::Locate(const StringL<charType>& pattern) const
+{
+    Array<uint32_t> positions;
+    uint32_t begin, end;
+    if (!findRange(pattern, begin, end)) {
+        return positions;
+    }
+
+    for (uint32_t row = begin; row < end; ++row) {
+        uint32_t current = row;
+        uint32_t steps = 0;
+        while (!sampled_.Get(current)) {
+            current = lf(current);
+            if (++steps >= SA_SAMPLE_RATE) {
+                throw std::runtime_error("FMIndex: Corrupted BWT!");
+            }
+        }
+        positions.push_back(samples_[sampled_.Rank(current)] + steps);
+    }
+    std::sort(positions.begin(), positions.end());
+    return positions;
+}
+
+// ==== PRIVATE ====
+
+template <typename charType>
+bool FMIndex<charType>::findRange(const StringL<charType>& pattern, uint32_t& begin, uint32_t& end) const
+{
+    if (pattern.size() == 0 || size_ == 0) {
+        return false;
+    }
+    begin = 0;
+    end = static_cast<uint32_t>(size_);
+    for (size_t i = pattern.size(); i-- > 0;) {
+        if (!alphabet_.Contains(pattern[i])) {
+            return false;
+        }
+        const uint32_t rank = alphabet_.Rank(pattern[i]);
+        begin = C_[rank] + occurrences(rank, begin);
+        end = C_[rank] + occurrences(rank, end);
+        if (begin >= end) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename charType>
+uint32_t FMIndex<charType>::occurrences(const uint32_t rank, const uint32_t row) const
+{
+    const uint32_t marker = (rank == 0 && row > index_) ? 1 : 0;
+    if (useWaveletTree_) {
+        return wavelet_.Rank(rank, row) - marker;
+    }
+
+    // count from the nearest sample
+    const size_t alphabetSize = alphabet_.Size();
+    const size_t block = row / OCC_SAMPLE_RATE;
+    const size_t blockStart = block * OCC_SAMPLE_RATE;
+    const uint8_t symbol = static_cast<uint8_t>(rank);
+    if (row - blockStart > OCC_SAMPLE_RATE / 2 && blockStart + OCC_SAMPLE_RATE <= size_) {
+        uint32_t count = occ_[(block + 1) * alphabetSize + rank];
+        for (size_t i = row; i < blockStart + OCC_SAMPLE_RATE; ++i) {
+            count -= (bwtRanks_[i] == symbol);
+        }
+        return count - marker;
+    }
+    uint32_t count = occ_[block * alphabetSize + rank];
+    for (size_t i = blockStart; i < row; ++i) {
+        count += (bwtRanks_[i] == symbol);
+    }
+    return count - marker;
+}
+
+template <typename charType>
+uint32_t FMIndex<charType>::lf(const uint32_t row) const
+{
+    // the marker ends the text, the previous suffix is the marker alone
+    if (row == index_) {
+        return 0;
+    }
+    if (useWaveletTree_) {
+        uint32_t rank;
+        const uint32_t symbol = wavelet_.AccessRank(row, rank);
+        return C_[symbol] + rank - ((symbol == 0 && row > index_) ? 1 : 0);
+    }
+    const uint32_t symbol = bwtRanks_[row];
+    return C_[symbol] + occurrences(symbol, row);
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
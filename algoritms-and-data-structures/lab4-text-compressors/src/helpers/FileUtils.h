@@ -4,6 +4,7 @@
 #include <sstream>
 #include <codecvt>
 #include <locale>
+#include <filesystem>
 
 
 /**
@@ -25,6 +26,9 @@ public:
     static std::ifstream OpenFileBinaryRead(const wchar_t* filepath);
     static std::ofstream OpenFileBinaryWrite(const char* filepath);
     static std::ofstream OpenFileBinaryWrite(const wchar_t* filepath);
+    // opens an existing file for writing at its end (content isn't truncated)
+    static std::ofstream OpenFileBinaryAppend(const char* filepath);
+    static std::ofstream OpenFileBinaryAppend(const wchar_t* filepath);
     
     // =======================================================
 
@@ -47,6 +51,10 @@ public:
     static inline const bool IsTextFile(const char* filepath);
     static inline const bool IsTextFile(const wchar_t* filepath);
 
+    // cuts the file to the given size in bytes
+    static inline void TruncateFile(const char* filepath, const size_t size);
+    static inline void TruncateFile(const wchar_t* filepath, const size_t size);
+
     // determines if the end of the file after reading last character (basic .eof() determine it after reading one more character)
     static inline const bool EndOfBinaryFile(std::ifstream& file);
 };
@@ -127,6 +135,27 @@ std::ofstream FileUtils::OpenFileBinaryWrite(const wchar_t* filepath)
     return file;
 }
 
+std::ofstream FileUtils::OpenFileBinaryAppend(const char* filepath)
+{
+    // "in" mode keeps the content, position is moved to the end (tellp() is the size of the file)
+    std::ofstream file(filepath, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file.is_open()) {
+        throw std::runtime_error("Error: Failed to open file " + std::string(filepath));
+    }
+    file.seekp(0, std::ios::end);
+    return file;
+}
+
+std::ofstream FileUtils::OpenFileBinaryAppend(const wchar_t* filepath)
+{
+    std::ofstream file(filepath, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file.is_open()) {
+        throw std::runtime_error("Error: Failed to open file!");
+    }
+    file.seekp(0, std::ios::end);
+    return file;
+}
+
 // ==========================================================================================================
 
 template <typename fileType>
@@ -217,6 +246,18 @@ const bool FileUtils::IsTextFile(const wchar_t* filepath)
 
 // ==========================================================================================================
 
+void FileUtils::TruncateFile(const char* filepath, const size_t size)
+{
+    std::filesystem::resize_file(filepath, size);
+}
+
+void FileUtils::TruncateFile(const wchar_t* filepath, const size_t size)
+{
+    std::filesystem::resize_file(filepath, size);
+}
+
+// ==========================================================================================================
+
 // returns true if file is empty
 const bool FileUtils::EndOfBinaryFile(std::ifstream& file)
 {
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+
+#include "BitStream.h"
+#include "Array.h"
+
+
+/**
+ * HuffmanDecodeTable.
+ *
+ * Brief:
+ * - Class defines lookup table to decode canonical huffman codes from BitReader
+ *
+ * Parameters:
+ * - charType - The type of the characters in the alphabet (char, char16_t/wchar_t, char32_t).
+ *
+ * Memory usage:
+ * O(2^LOOKUP_BITS * MAX_SYMBOLS_PER_LOOKUP * sizeof(charType)) + θ(alphabetSize)
+ *
+ * Details:
+ * - Symbols should be given in canonical order (lengths of codes are not decreasing), codes are not longer than MAX_CODE_LENGTH bits
+ * - Codes not longer than LOOKUP_BITS are decoded by one table lookup, longer codes are decoded by canonical search (first code of every length)
+ * - DecodeSymbols() decodes up to MAX_SYMBOLS_PER_LOOKUP symbols by one lookup of the next LOOKUP_BITS bits:
+ *   an entry keeps all consecutive codes which fit into its bits (after MTF the most frequent codes are 1-3 bits long).
+ *   The multi-symbol table costs more to build than a block of a few thousand symbols saves, so it is built only on request
+ * - Static method GetCanonicalCodes() calculates canonical codes from lengths, so encoder and decoder use the same codes
+ * - Build() reuses memory of the previous table, so one object can decode many blocks without new allocations
+ */
+template <typename charType>
+class HuffmanDecodeTable
+{
+public:
+    static const uint32_t LOOKUP_BITS = 11;
+    static const uint32_t MAX_CODE_LENGTH = 32;
+    static const uint32_t MAX_SYMBOLS_PER_LOOKUP = 4;
+
+    HuffmanDecodeTable() : tableBits_(0), maxLength_(0), hasMultiTable_(false) {}
+    HuffmanDecodeTable(const Array<charType>& symbols, const Array<uint32_t>& lengths, const bool multiSymbol = false);
+
+    // multiSymbol - build the table for DecodeSymbols() too
+    void Build(const Array<charType>& symbols, const Array<uint32_t>& lengths, const bool multiSymbol = false);
+    bool HasMultiSymbolTable() const { return hasMultiTable_; }
+
+    // returns canonical codes for the lengths given in canonical order
+    static Array<uint32_t> GetCanonicalCodes(const Array<uint32_t>& lengths);
+    // the same, codes are written to the given array
+    static void GetCanonicalCodes(const Array<uint32_t>& lengths, Array<uint32_t>& codes);
+
+    inline charType DecodeSymbol(BitReader& reader) const;
+    // writes 1..MAX_SYMBOLS_PER_LOOKUP next symbols to output (it should have place for MAX_SYMBOLS_PER_LOOKUP symbols),
+    // returns their number (only if the table is built with multiSymbol)
+    inline uint32_t DecodeSymbols(BitReader& reader, charType* output) const;
+private:
+    struct entry {
+        charType symbol;
+        uint8_t length; // 0 - code is longer than tableBits_
+    };
+    struct multiEntry {
+        charType symbols[MAX_SYMBOLS_PER_LOOKUP];
+        uint8_t count; // 0 - the first code is longer than tableBits_
+        uint8_t length; // total length of codes
+    };
+
+    Array<entry> table_;
+    Array<multiEntry> multiTable_;
+    Array<charType> symbols_;
+    uint32_t tableBits_;
+    uint32_t maxLength_;
+    bool hasMultiTable_;
+    // for every length: the first canonical code, the index of its symbol and number of codes
+    Array<uint32_t> firstCode_;
+    Array<uint32_t> firstIndex_;
+    Array<uint32_t> count_;
+    Array<uint32_t> codes_;
+
+    charType decodeLongSymbol(BitReader& reader) const;
+    template <typename T>
+    static void fill(Array<T>& arr, const size_t size, const T& value);
+};
+
+
+// START IMPLEMENTATION
+
+template <typename charType>
+Array<uint32_t> HuffmanDecodeTable<charType>::GetCanonicalCodes(const Array<uint32_t>& lengths)
+{
+    Array<uint32_t> codes(lengths.size());
+    GetCanonicalCodes(lengths, codes);
+    return codes;
+}
+
+template <typename charType>
+void HuffmanDecodeTable<charType>::GetCanonicalCodes(const Array<uint32_t>& lengths, Array<uint32_t>& codes)
+{
+    codes.clear();
+
+    uint64_t code = 0;
+    uint32_t previousLength = 0;
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        if (lengths[i] < previousLength || lengths[i] == 0 || lengths[i] > MAX_CODE_LENGTH) {
+            throw std::runtime_error("HuffmanDecodeTable: Invalid lengths of huffman codes!");
+        }
+        if (i > 0) ++code;
+        code <<= (lengths[i] - previousLength);
+        if (code >> lengths[i]) {
+            throw std::runtime_error("HuffmanDecodeTable: Invalid lengths of huffman codes!");
+        }
+        codes.push_back(static_cast<uint32_t>(code));
+        previousLength = lengths[i];
+    }
+}
+
+template <typename charType>
+HuffmanDecodeTable<charType>::HuffmanDecodeTable(const Array<charType>& symbols, const Array<uint32_t>& lengths, const bool multiSymbol) :
+    tableBits_(0), maxLength_(0), hasMultiTable_(false)
+{
+    Build(symbols, lengths, multiSymbol);
+}
+
+template <typename charType>
+void HuffmanDecodeTable<charType>::Build(const Array<charType>& symbols, const Array<uint32_t>& lengths, const bool multiSymbol)
+{
+    GetCanonicalCodes(lengths, codes_);
+    symbols_.clear();
+    for (const charType& symbol : symbols) {
+        symbols_.push_back(symbol);
+    }
+    maxLength_ = 0;
+    for (const uint32_t& length : lengths) {
+        maxLength_ = std::max(maxLength_, length);
+    }
+    tableBits_ = std::max(maxLength_, 1u);
+    if (tableBits_ > LOOKUP_BITS) tableBits_ = LOOKUP_BITS;
+
+    // fill lookup table (entries without a code stay with length 0)
+    fill(table_, static_cast<size_t>(1) << tableBits_, entry{ 0, 0 });
+    for (size_t i = 0; i < codes_.size() && lengths[i] <= tableBits_; ++i) {
+        const uint32_t shift = tableBits_ - lengths[i];
+        const uint32_t first = codes_[i] << shift;
+        for (uint32_t j = 0; j < (1u << shift); ++j) {
+            table_.assign(first + j, entry{ symbols[i], static_cast<uint8_t>(lengths[i]) });
+        }
+    }
+
+    // multi-symbol table: consecutive codes which fit into tableBits_ bits
+    // (the rest of the bits is filled by zeros, so a code which doesn't fit isn't taken)
+    hasMultiTable_ = multiSymbol;
+    if (multiSymbol) {
+        const size_t mask = table_.size() - 1;
+        fill(multiTable_, table_.size(), multiEntry{});
+        for (size_t bits = 0; bits <= mask; ++bits) {
+            multiEntry& e = multiTable_[bits];
+            while (e.count < MAX_SYMBOLS_PER_LOOKUP) {
+                const entry& next = table_[(bits << e.length) & mask];
+                if (next.length == 0 || next.length > tableBits_ - e.length) break;
+                e.symbols[e.count++] = next.symbol;
+                e.length = static_cast<uint8_t>(e.length + next.length);
+            }
+        }
+    }
+
+    // canonical search data for long codes
+    fill(firstCode_, maxLength_ + 1, 0u);
+    fill(firstIndex_, maxLength_ + 1, 0u);
+    fill(count_, maxLength_ + 1, 0u);
+    for (size_t i = codes_.size(); i-- > 0;) {
+        firstCode_.assign(lengths[i], codes_[i]);
+        firstIndex_.assign(lengths[i], static_cast<uint32_t>(i));
+        count_.assign(lengths[i], count_[lengths[i]] + 1);
+    }
+}
+
+template <typename charType>
+charType HuffmanDecodeTable<charType>::DecodeSymbol(BitReader& reader) const
+{
+    const entry& e = table_[reader.Peek(tableBits_)];
+    if (e.length != 0) {
+        reader.Skip(e.length);
+        return e.symbol;
+    }
+    return decodeLongSymbol(reader);
+}
+
+template <typename charType>
+uint32_t HuffmanDecodeTable<charType>::DecodeSymbols(BitReader& reader, charType* output) const
+{
+    const multiEntry& e = multiTable_[reader.Peek(tableBits_)];
+    if (e.count == 0) {
+        output[0] = decodeLongSymbol(reader);
+        return 1;
+    }
+    for (uint32_t i = 0; i < MAX_SYMBOLS_PER_LOOKUP; ++i) {
+        output[i] = e.symbols[i];
+    }
+    reader.Skip(e.length);
+    return e.count;
+}
+
+template <typename charType>
+charType HuffmanDecodeTable<charType>::decodeLongSymbol(BitReader& reader) const
+{
+    for (uint32_t length = tableBits_ + 1; length <= maxLength_; ++length) {
+        const uint32_t code = reader.Peek(length);
+        if (count_[length] > 0 && code >= firstCode_[length] && code - firstCode_[length] < count_[length]) {
+            reader.Skip(length);
+            return symbols_[firstIndex_[length] + (code - firstCode_[length])];
+        }
+    }
+    throw std::runtime_error("HuffmanDecodeTable: Corrupted data!");
+}
+
+template <typename charType>
+template <typename T>
+void HuffmanDecodeTable<charType>::fill(Array<T>& arr, const size_t size, const T& value)
+{
+    // memory of the array is kept, so it is allocated only when the array grows
+    arr.clear();
+    for (size_t i = 0; i < size; ++i) {
+        arr.push_back(value);
+    }
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
@@ -147,39 +147,14 @@ Array<typename HuffmanTree<charType>::CanonicalCode> HuffmanTree<charType>::GetC
         return a.codeLength < b.codeLength;
     });
 
-    std::set<std::pair<uint32_t, uint32_t>> usingCodes; // <code, length>
-    std::pair<uint32_t, uint32_t> binRepresentation;
-    std::pair<uint32_t, uint32_t> temp;
-    bool isCodeUsed;
+    // assign canonical codes: every code is the next code of the previous one shifted to its length
+    // (the smallest code of the given length which doesn't begin with any of the previous codes)
+    uint32_t code = 0;
     for (size_t i = 0; i < canonicalCodes.size(); ++i) {
-        uint32_t lengthOfCode = (canonicalCodes[i].codeLength);
-        // find the code of length = lengthOfCode
-        // which has the smallest number (considering the code as the binary representation)
-        // which was not used before and which satisfy the huffman rule
-        for (uint32_t j = 0; j < 1000000000; ++j) {
-            // find the code of length = lengthOfCode
-            // which was not used before
-            binRepresentation = { j, lengthOfCode };
-            if (usingCodes.find(binRepresentation) == usingCodes.end()) {
-                // check if the code satisfies the huffman rule
-                // (if there are no any codes from which the current code begins)
-                isCodeUsed = false;
-                temp = { j , lengthOfCode };
-                for (uint32_t _ = 0; _ < lengthOfCode; ++_) {
-                    temp.first >>= 1;
-                    --temp.second;
-                    if (usingCodes.find(temp) != usingCodes.end()) {
-                        isCodeUsed = true;
-                        break;
-                    }
-                }
-                if (!isCodeUsed) {
-                    canonicalCodes[i].code = j;
-                    usingCodes.insert(binRepresentation);
-                    break;
-                }
-            }
+        if (i > 0) {
+            code = (code + 1) << (canonicalCodes[i].codeLength - canonicalCodes[i - 1].codeLength);
         }
+        canonicalCodes[i].code = code;
     }
 
     return canonicalCodes;
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/**
+ * MemoryStats.
+ *
+ * Brief:
+ * - Class defines opt-in accounting of memory allocated by Array (and so by StringL and BitArray which keep their data in Array):
+ *   numbers of allocations, frees and deep copies, allocated / copied bytes, live and peak live bytes,
+ *   and allocations and peaks of stages marked by tags (MemoryStats::Scope)
+ *
+ * Memory usage:
+ * O(number of tags)
+ *
+ * Details:
+ * - Accounting is off by default: Array calls OnAllocate() / OnFree() / OnCopy() which only read an atomic flag until Enable(true)
+ * - Counters are process-wide atomics, so allocations of worker threads (parallel suffix array, inverse BWT) are counted too
+ * - Scope marks a stage of the current thread: it counts allocations made on the thread while it is alive and its peak -
+ *   the largest growth of live bytes over live bytes at the beginning of the stage (memory the stage needs on top of what was allocated before).
+ *   Scopes nest (an allocation is counted by every enclosing scope), stages with equal tags are summed (the peak is the largest of them).
+ *   Worker threads don't inherit scopes of the thread which started them, but their allocations change live bytes seen by the scopes
+ * - Frees aren't attributed to stages (a block can be freed by another stage than the one which allocated it), live bytes are process-wide
+ * - Copies are deep copies of arrays (copy constructor, operator=, copy()): for example data structs of codecs returned or assigned by value
+ * - Enable or Reset() before the measured calls: blocks allocated earlier aren't counted, but their frees are (live bytes in reports don't go below 0)
+ */
+class MemoryStats
+{
+public:
+    struct stageStats {
+        std::string tag;
+        uint64_t entries; // number of scopes with the tag
+        uint64_t allocations;
+        uint64_t allocatedBytes;
+        uint64_t peakBytes; // the largest growth of live bytes within one scope
+        stageStats(const std::string& tag) : tag(tag), entries(0), allocations(0), allocatedBytes(0), peakBytes(0) {}
+    };
+
+    struct report {
+        uint64_t allocations;
+        uint64_t frees;
+        uint64_t copies;
+        uint64_t allocatedBytes;
+        uint64_t copiedBytes;
+        uint64_t liveBytes;
+        uint64_t peakLiveBytes;
+        std::vector<stageStats> stages; // in order of the first end of a scope with the tag
+        report() : allocations(0), frees(0), copies(0), allocatedBytes(0), copiedBytes(0), liveBytes(0), peakLiveBytes(0) {}
+
+        // one line per counter and per stage
+        inline std::string toString() const;
+    };
+
+    // marks a stage of the current thread until the end of the object's lifetime (does nothing if accounting is disabled when it's created)
+    class Scope {
+    public:
+        inline explicit Scope(const char* tag);
+        explicit Scope(const std::string& tag) : Scope(tag.c_str()) {}
+        inline ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        friend class MemoryStats;
+        bool active_;
+        std::string tag_;
+        Scope* parent_;
+        int64_t entryLiveBytes_;
+        uint64_t allocations_;
+        uint64_t allocatedBytes_;
+        uint64_t peakBytes_;
+    };
+
+    static inline void Enable(const bool enable) { enabled_.store(enable, std::memory_order_relaxed); }
+    static inline bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+    // sets all counters to 0 and forgets stages (live bytes start from 0)
+    static inline void Reset();
+    static inline report GetReport();
+
+    // hooks of Array
+    static inline void OnAllocate(const size_t bytes);
+    static inline void OnFree(const size_t bytes);
+    static inline void OnCopy(const size_t bytes);
+private:
+    MemoryStats() = default;
+
+    static inline std::atomic<bool> enabled_{false};
+    static inline std::atomic<uint64_t> allocations_{0};
+    static inline std::atomic<uint64_t> frees_{0};
+    static inline std::atomic<uint64_t> copies_{0};
+    static inline std::atomic<uint64_t> allocatedBytes_{0};
+    static inline std::atomic<uint64_t> copiedBytes_{0};
+    static inline std::atomic<int64_t> liveBytes_{0};
+    static inline std::atomic<int64_t> peakLiveBytes_{0};
+
+    static inline std::mutex stagesMutex_;
+    static inline std::vector<stageStats> stages_;
+
+    static inline thread_local Scope* currentScope_ = nullptr;
+};
+
+
+// START IMPLEMENTATION
+
+// ==== SCOPE ====
+
+MemoryStats::Scope::Scope(const char* tag) :
+    active_(MemoryStats::IsEnabled()), parent_(nullptr), entryLiveBytes_(0), allocations_(0), allocatedBytes_(0), peakBytes_(0)
+{
+    if (!active_) return;
+    tag_ = tag;
+    parent_ = currentScope_;
+    entryLiveBytes_ = liveBytes_.load(std::memory_order_relaxed);
+    currentScope_ = this;
+}
+
+MemoryStats::Scope::~Scope()
+{
+    if (!active_) return;
+    currentScope_ = parent_;
+
+    std::lock_guard<std::mutex> lock(stagesMutex_);
+    size_t index = 0;
+    while (index < stages_.size() && stages_[index].tag != tag_) ++index;
+    if (index == stages_.size()) {
+        stages_.push_back(stageStats(tag_));
+    }
+    stageStats& stage = stages_[index];
+    ++stage.entries;
+    stage.allocations += allocations_;
+    stage.allocatedBytes += allocatedBytes_;
+    if (peakBytes_ > stage.peakBytes) stage.peakBytes = peakBytes_;
+}
+
+// ==== MEMORY STATS ====
+
+void MemoryStats::Reset()
+{
+    allocations_.store(0);
+    frees_.store(0);
+    copies_.store(0);
+    allocatedBytes_.store(0);
+    copiedBytes_.store(0);
+    liveBytes_.store(0);
+    peakLiveBytes_.store(0);
+    std::lock_guard<std::mutex> lock(stagesMutex_);
+    stages_.clear();
+}
+
+MemoryStats::report MemoryStats::GetReport()
+{
+    report result;
+    result.allocations = allocations_.load();
+    result.frees = frees_.load();
+    result.copies = copies_.load();
+    result.allocatedBytes = allocatedBytes_.load();
+    result.copiedBytes = copiedBytes_.load();
+    const int64_t live = liveBytes_.load();
+    result.liveBytes = (live > 0) ? static_cast<uint64_t>(live) : 0;
+    result.peakLiveBytes = static_cast<uint64_t>(peakLiveBytes_.load());
+    std::lock_guard<std::mutex> lock(stagesMutex_);
+    result.stages = stages_;
+    return result;
+}
+
+std::string MemoryStats::report::toString() const
+{
+    std::string result;
+    result += "allocations: " + std::to_string(allocations) + " (" + std::to_string(allocatedBytes) + " bytes)\n";
+    result += "frees: " + std::to_string(frees) + "\n";
+    result += "copies: " + std::to_string(copies) + " (" + std::to_string(copiedBytes) + " bytes)\n";
+    result += "live bytes: " + std::to_string(liveBytes) + ", peak live bytes: " + std::to_string(peakLiveBytes) + "\n";
+    for (const stageStats& stage : stages) {
+        result += "[" + stage.tag + "] x" + std::to_string(stage.entries) + ": allocations: " + std::to_string(stage.allocations) +
+                  " (" + std::to_string(stage.allocatedBytes) + " bytes), peak: " + std::to_string(stage.peakBytes) + " bytes\n";
+    }
+    return result;
+}
+
+void MemoryStats::OnAllocate(const size_t bytes)
+{
+    if (!IsEnabled()) return;
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes_.fetch_add(bytes, std::memory_order_relaxed);
+    const int64_t live = liveBytes_.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed) + static_cast<int64_t>(bytes);
+    int64_t peak = peakLiveBytes_.load(std::memory_order_relaxed);
+    while (live > peak && !peakLiveBytes_.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+
+    for (Scope* scope = currentScope_; scope != nullptr; scope = scope->parent_) {
+        ++scope->allocations_;
+        scope->allocatedBytes_ += bytes;
+        if (live > scope->entryLiveBytes_ && static_cast<uint64_t>(live - scope->entryLiveBytes_) > scope->peakBytes_) {
+            scope->peakBytes_ = static_cast<uint64_t>(live - scope->entryLiveBytes_);
+        }
+    }
+}
+
+void MemoryStats::OnFree(const size_t bytes)
+{
+    if (!IsEnabled()) return;
+    frees_.fetch_add(1, std::memory_order_relaxed);
+    liveBytes_.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+}
+
+void MemoryStats::OnCopy(const size_t bytes)
+{
+    if (!IsEnabled()) return;
+    copies_.fetch_add(1, std::memory_order_relaxed);
+    copiedBytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include "SimdUtils.h"
+#include "Array.h"
+
+
+/**
+ * MoveToFront.
+ *
+ * Brief:
+ * - Class defines static methods to turn ranks of characters (0..alphabetSize-1) into MTF codes and back:
+ *   the code is the position of the rank in the list which begins with 0, 1, ..., alphabetSize - 1, then the rank moves to the front
+ *
+ * Memory usage:
+ * O(alphabetSize) (θ(4 * (alphabetSize + size)) for alphabets larger than MAX_LIST_ALPHABET)
+ *
+ * Details:
+ * - Alphabets of at most MAX_BYTE_ALPHABET ranks keep the list in bytes: the position is found by SimdUtils::FindByte()
+ *   (16 / 32 ranks per comparison), the list is shifted by memmove. Codes 0 and 1 (the most of codes after BWT) are checked before the search
+ * - Alphabets of at most MAX_LIST_ALPHABET ranks keep the list of uint32_t ranks and search it linearly
+ * - Larger alphabets keep the time of the last use of every rank: the code is the number of ranks used later, it is counted by a Fenwick tree
+ *   over times (O(log(alphabetSize + size)) per character for any code), decoder finds the rank by descending the tree
+ * - Codes and ranks can be of any unsigned type (uint8_t, uint16_t, charType), so callers store them in the narrowest type
+ *   which holds alphabetSize - 1. Encode() / Decode() may write to the input array (every element is read before it is written)
+ */
+class MoveToFront
+{
+private:
+    MoveToFront() = default;
+
+    // counts of used times (1-based Fenwick tree)
+    class timeTree {
+    public:
+        explicit timeTree(const size_t size) : tree_(size + 1, 0), highestBit_(1) {
+            while (highestBit_ * 2 <= size) highestBit_ *= 2;
+        }
+        void Add(size_t time, const int32_t delta) {
+            for (++time; time < tree_.size(); time += time & (~time + 1)) tree_[time] += delta;
+        }
+        // number of used times <= time
+        uint32_t CountUpTo(size_t time) const {
+            uint32_t count = 0;
+            for (++time; time > 0; time -= time & (~time + 1)) count += tree_[time];
+            return count;
+        }
+        // the smallest time with CountUpTo(time) == count (count >= 1), the tree descends to the last prefix with a smaller count
+        size_t Find(uint32_t count) const {
+            size_t position = 0;
+            for (size_t bit = highestBit_; bit > 0; bit >>= 1) {
+                if (position + bit < tree_.size() && tree_[position + bit] < count) {
+                    position += bit;
+                    count -= tree_[position];
+                }
+            }
+            return position;
+        }
+    private:
+        Array<uint32_t> tree_;
+        size_t highestBit_;
+    };
+public:
+    static const size_t MAX_BYTE_ALPHABET = 256;
+    static const size_t MAX_LIST_ALPHABET = 1024;
+
+    template <typename rankType, typename codeType>
+    static inline void Encode(const rankType* ranks, const size_t size, const size_t alphabetSize, codeType* codes);
+    // throws std::runtime_error if a code is not less than alphabetSize
+    template <typename codeType, typename rankType>
+    static inline void Decode(const codeType* codes, const size_t size, const size_t alphabetSize, rankType* ranks);
+};
+
+
+// START IMPLEMENTATION
+
+template <typename rankType, typename codeType>
+void MoveToFront::Encode(const rankType* ranks, const size_t size, const size_t alphabetSize, codeType* codes)
+{
+    if (size == 0) return;
+
+    if (alphabetSize <= MAX_BYTE_ALPHABET) {
+        uint8_t list[MAX_BYTE_ALPHABET];
+        for (size_t r = 0; r < MAX_BYTE_ALPHABET; ++r) list[r] = static_cast<uint8_t>(r);
+        for (size_t i = 0; i < size; ++i) {
+            const uint8_t rank = static_cast<uint8_t>(ranks[i]);
+            if (list[0] == rank) {
+                codes[i] = 0;
+            } else if (list[1] == rank) {
+                list[1] = list[0];
+                list[0] = rank;
+                codes[i] = 1;
+            } else {
+                const size_t index = SimdUtils::FindByte(list, alphabetSize, rank);
+                if (index == alphabetSize) {
+                    throw std::invalid_argument("MoveToFront: Rank is out of the alphabet!");
+                }
+                std::memmove(list + 1, list, index);
+                list[0] = rank;
+                codes[i] = static_cast<codeType>(index);
+            }
+        }
+        return;
+    }
+
+    if (alphabetSize <= MAX_LIST_ALPHABET) {
+        Array<uint32_t> list(alphabetSize, 0);
+        for (size_t r = 0; r < alphabetSize; ++r) list[r] = static_cast<uint32_t>(r);
+        uint32_t* front = list.begin();
+        for (size_t i = 0; i < size; ++i) {
+            const uint32_t rank = static_cast<uint32_t>(ranks[i]);
+            size_t index = 0;
+            while (index < alphabetSize && front[index] != rank) ++index;
+            if (index == alphabetSize) {
+                throw std::invalid_argument("MoveToFront: Rank is out of the alphabet!");
+            }
+            std::memmove(front + 1, front, index * sizeof(uint32_t));
+            front[0] = rank;
+            codes[i] = static_cast<codeType>(index);
+        }
+        return;
+    }
+
+    // rank r was used at time alphabetSize - 1 - r before the first character (rank 0 is at the front)
+    timeTree tree(alphabetSize + size);
+    Array<size_t> lastTime(alphabetSize, 0);
+    for (size_t r = 0; r < alphabetSize; ++r) {
+        lastTime[r] = alphabetSize - 1 - r;
+        tree.Add(lastTime[r], 1);
+    }
+    size_t now = alphabetSize;
+    for (size_t i = 0; i < size; ++i) {
+        const size_t rank = static_cast<size_t>(ranks[i]);
+        if (rank >= alphabetSize) {
+            throw std::invalid_argument("MoveToFront: Rank is out of the alphabet!");
+        }
+        // ranks used after the rank are before it in the list
+        codes[i] = static_cast<codeType>(alphabetSize - tree.CountUpTo(lastTime[rank]));
+        tree.Add(lastTime[rank], -1);
+        tree.Add(now, 1);
+        lastTime[rank] = now++;
+    }
+}
+
+template <typename codeType, typename rankType>
+void MoveToFront::Decode(const codeType* codes, const size_t size, const size_t alphabetSize, rankType* ranks)
+{
+    if (size == 0) return;
+
+    if (alphabetSize <= MAX_BYTE_ALPHABET) {
+        uint8_t list[MAX_BYTE_ALPHABET];
+        for (size_t r = 0; r < MAX_BYTE_ALPHABET; ++r) list[r] = static_cast<uint8_t>(r);
+        for (size_t i = 0; i < size; ++i) {
+            const size_t code = static_cast<size_t>(codes[i]);
+            if (code >= alphabetSize) {
+                throw std::runtime_error("MoveToFront: Corrupted data!");
+            }
+            const uint8_t rank = list[code];
+            std::memmove(list + 1, list, code);
+            list[0] = rank;
+            ranks[i] = static_cast<rankType>(rank);
+        }
+        return;
+    }
+
+    if (alphabetSize <= MAX_LIST_ALPHABET) {
+        Array<uint32_t> list(alphabetSize, 0);
+        for (size_t r = 0; r < alphabetSize; ++r) list[r] = static_cast<uint32_t>(r);
+        uint32_t* front = list.begin();
+        for (size_t i = 0; i < size; ++i) {
+            const size_t code = static_cast<size_t>(codes[i]);
+            if (code >= alphabetSize) {
+                throw std::runtime_error("MoveToFront: Corrupted data!");
+            }
+            const uint32_t rank = front[code];
+            std::memmove(front + 1, front, code * sizeof(uint32_t));
+            front[0] = rank;
+            ranks[i] = static_cast<rankType>(rank);
+        }
+        return;
+    }
+
+    // the code-th rank from the front is the one with the (alphabetSize - code)-th smallest time
+    timeTree tree(alphabetSize + size);
+    Array<uint32_t> rankAt(alphabetSize + size, 0);
+    for (size_t r = 0; r < alphabetSize; ++r) {
+        rankAt[alphabetSize - 1 - r] = static_cast<uint32_t>(r);
+        tree.Add(alphabetSize - 1 - r, 1);
+    }
+    size_t now = alphabetSize;
+    for (size_t i = 0; i < size; ++i) {
+        const size_t code = static_cast<size_t>(codes[i]);
+        if (code >= alphabetSize) {
+            throw std::runtime_error("MoveToFront: Corrupted data!");
+        }
+        const size_t time = tree.Find(static_cast<uint32_t>(alphabetSize - code));
+        const uint32_t rank = rankAt[time];
+        tree.Add(time, -1);
+        tree.Add(now, 1);
+        rankAt[now++] = rank;
+        ranks[i] = static_cast<rankType>(rank);
+    }
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "SimdUtils.h"
+#include "StringL.h"
+#include "Array.h"
+
+
+/**
+ * PredictiveFilter.
+ *
+ * Brief:
+ * - Class defines static methods to replace pixels of an image by differences from their predictions (PNG filters) and back
+ *
+ * Memory usage:
+ * θ(sizeof(inputStr)) + θ(rowsCount)
+ *
+ * Details:
+ * - The string is split into rows of rowSize characters (the last row may be shorter), a pixel is pixelSize characters
+ * - Every row uses its own filter: NONE, LEFT (a), UP (b), AVERAGE ((a + b) / 2) or PAETH (the closest of a, b, c to a + b - c),
+ *   where a - the same channel of the left pixel, b - of the upper pixel, c - of the upper left pixel (0 outside the image)
+ * - The encoder chooses the filter with the smallest sum of absolute differences (the same heuristic as PNG encoders)
+ * - Differences are calculated modulo 2^(8 * sizeof(charType)), so the size of the string isn't changed
+ * - Decoding of 8-bit rows with UP and LEFT filters uses SimdUtils (vector addition and prefix sums),
+ *   AVERAGE and PAETH depend on the just decoded left pixel and are decoded pixel by pixel
+ */
+class PredictiveFilter
+{
+private:
+    PredictiveFilter() = default;
+
+    template <typename charType>
+    static inline charType predict(const uint8_t filter, const charType a, const charType b, const charType c);
+    template <typename charType>
+    static inline charType paeth(const charType a, const charType b, const charType c);
+public:
+    enum RowFilter : uint8_t { NONE = 0, LEFT = 1, UP = 2, AVERAGE = 3, PAETH = 4, FILTERS_COUNT = 5 };
+
+    static const size_t MAX_PIXEL_SIZE = 8;
+
+    // returns differences, rowFilters gets the filter of every row
+    template <typename charType>
+    static StringL<charType> Encode(const StringL<charType>& inputStr, const size_t rowSize, const size_t pixelSize, Array<uint8_t>& rowFilters);
+    template <typename charType>
+    static StringL<charType> Decode(const StringL<charType>& differences, const size_t rowSize, const size_t pixelSize, const Array<uint8_t>& rowFilters);
+
+    static size_t GetRowsCount(const size_t size, const size_t rowSize) { return (size + rowSize - 1) / rowSize; }
+};
+
+
+// START IMPLEMENTATION
+
+template <typename charType>
+charType PredictiveFilter::paeth(const charType a, const charType b, const charType c)
+{
+    const int64_t p = static_cast<int64_t>(a) + static_cast<int64_t>(b) - static_cast<int64_t>(c);
+    const int64_t pa = (p > a) ? p - a : a - p;
+    const int64_t pb = (p > b) ? p - b : b - p;
+    const int64_t pc = (p > c) ? p - c : c - p;
+    if (pa <= pb && pa <= pc) return a;
+    if (pb <= pc) return b;
+    return c;
+}
+
+template <typename charType>
+charType PredictiveFilter::predict(const uint8_t filter, const charType a, const charType b, const charType c)
+{
+    switch (filter) {
+    case LEFT: return a;
+    case UP: return b;
+    case AVERAGE: return static_cast<charType>((static_cast<uint64_t>(a) + static_cast<uint64_t>(b)) / 2);
+    case PAETH: return paeth(a, b, c);
+    default: return 0;
+    }
+}
+
+template <typename charType>
+StringL<charType> PredictiveFilter::Encode(const StringL<charType>& inputStr, const size_t rowSize, const size_t pixelSize, Array<uint8_t>& rowFilters)
+{
+    if (rowSize < 1 || pixelSize < 1 || pixelSize > MAX_PIXEL_SIZE) {
+        throw std::invalid_argument("PredictiveFilter: Invalid row or pixel size!");
+    }
+    typedef typename std::make_signed<charType>::type signedType;
+
+    StringL<charType> result(inputStr.size(), 0);
+    rowFilters.clear();
+
+    for (size_t rowStart = 0; rowStart < inputStr.size(); rowStart += rowSize) {
+        const size_t length = std::min(rowSize, inputStr.size() - rowStart);
+        const charType* row = inputStr.c_str() + rowStart;
+        const charType* upper = (rowStart > 0) ? row - rowSize : nullptr;
+
+        // sum of absolute differences of every filter
+        uint64_t sums[FILTERS_COUNT] = { 0 };
+        for (size_t i = 0; i < length; ++i) {
+            const charType a = (i >= pixelSize) ? row[i - pixelSize] : 0;
+            const charType b = upper ? upper[i] : 0;
+            const charType c = (upper && i >= pixelSize) ? upper[i - pixelSize] : 0;
+            for (uint8_t filter = NONE; filter < FILTERS_COUNT; ++filter) {
+                const signedType difference = static_cast<signedType>(static_cast<charType>(row[i] - predict(filter, a, b, c)));
+                sums[filter] += static_cast<uint64_t>(difference < 0 ? -static_cast<int64_t>(difference) : difference);
+            }
+        }
+        uint8_t best = NONE;
+        for (uint8_t filter = LEFT; filter < FILTERS_COUNT; ++filter) {
+            if (sums[filter] < sums[best]) best = filter;
+        }
+        rowFilters.push_back(best);
+
+        charType* output = result.begin() + rowStart;
+        for (size_t i = 0; i < length; ++i) {
+            const charType a = (i >= pixelSize) ? row[i - pixelSize] : 0;
+            const charType b = upper ? upper[i] : 0;
+            const charType c = (upper && i >= pixelSize) ? upper[i - pixelSize] : 0;
+            output[i] = static_cast<charType>(row[i] - predict(best, a, b, c));
+        }
+    }
+    return result;
+}
+
+template <typename charType>
+StringL<charType> PredictiveFilter::Decode(const StringL<charType>& differences, const size_t rowSize, const size_t pixelSize, const Array<uint8_t>& rowFilters)
+{
+    if (rowSize < 1 || pixelSize < 1 || pixelSize > MAX_PIXEL_SIZE) {
+        throw std::invalid_argument("PredictiveFilter: Invalid row or pixel size!");
+    }
+    if (rowFilters.size() != GetRowsCount(differences.size(), rowSize)) {
+        throw std::runtime_error("PredictiveFilter: Number of row filters doesn't match the size of data!");
+    }
+
+    StringL<charType> result(differences.size(), 0);
+    for (size_t r = 0; r < rowFilters.size(); ++r) {
+        const size_t rowStart = r * rowSize;
+        const size_t length = std::min(rowSize, differences.size() - rowStart);
+        const charType* input = differences.c_str() + rowStart;
+        charType* row = result.begin() + rowStart;
+        const charType* upper = (r > 0) ? row - rowSize : nullptr;
+        const uint8_t filter = rowFilters[r];
+        if (filter >= FILTERS_COUNT) {
+            throw std::runtime_error("PredictiveFilter: Unknown row filter!");
+        }
+
+        if (sizeof(charType) == 1 && (filter == UP || filter == LEFT || filter == NONE)) {
+            uint8_t* bytes = reinterpret_cast<uint8_t*>(row);
+            const uint8_t* inputBytes = reinterpret_cast<const uint8_t*>(input);
+            if (filter == UP && upper) {
+                SimdUtils::AddBytes(inputBytes, reinterpret_cast<const uint8_t*>(upper), length, bytes);
+            } else {
+                std::memcpy(bytes, inputBytes, length);
+                if (filter == LEFT) SimdUtils::PrefixSumBytes(bytes, length, pixelSize);
+            }
+            continue;
+        }
+
+        for (size_t i = 0; i < length; ++i) {
+            const charType a = (i >= pixelSize) ? row[i - pixelSize] : 0;
+            const charType b = upper ? upper[i] : 0;
+            const charType c = (upper && i >= pixelSize) ? upper[i - pixelSize] : 0;
+            row[i] = static_cast<charType>(input[i] + predict(filter, a, b, c));
+        }
+    }
+    return result;
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
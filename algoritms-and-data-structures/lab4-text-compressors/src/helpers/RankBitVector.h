@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "SimdUtils.h"
+#include "Array.h"
+
+
+/**
+ * RankBitVector.
+ *
+ * Brief:
+ * - Class defines a vector of bits which counts set bits before any position in constant time
+ *
+ * Memory usage:
+ * θ(size / 8 + size / 16) bytes
+ *
+ * Details:
+ * - Bits are set by Set() after Reset(), then BuildRanks() calculates numbers of set bits before every 64-bit word,
+ *   Rank() adds the popcount of the masked word to it
+ * - Reset() reuses memory of the previous vector
+ */
+class RankBitVector
+{
+public:
+    RankBitVector() : size_(0) {}
+
+    // size bits, all bits are 0
+    inline void Reset(const size_t size);
+    void Set(const size_t position) { words_[position >> 6] |= static_cast<uint64_t>(1) << (position & 63); }
+    inline void BuildRanks();
+
+    size_t Size() const { return size_; }
+    bool Get(const size_t position) const { return (words_[position >> 6] >> (position & 63)) & 1; }
+    // number of set bits in [0, position), position <= Size()
+    uint32_t Rank(const size_t position) const {
+        return ranks_[position >> 6] + SimdUtils::PopCount64(words_[position >> 6] & ((static_cast<uint64_t>(1) << (position & 63)) - 1));
+    }
+
+    void FreeMemory() { words_.free_memory(); ranks_.free_memory(); size_ = 0; }
+private:
+    Array<uint64_t> words_; // one more word than needed, so Rank(Size()) doesn't read outside
+    Array<uint32_t> ranks_;
+    size_t size_;
+};
+
+
+// START IMPLEMENTATION
+
+void RankBitVector::Reset(const size_t size)
+{
+    size_ = size;
+    words_.clear();
+    for (size_t i = 0; i <= (size >> 6); ++i) {
+        words_.push_back(0);
+    }
+}
+
+void RankBitVector::BuildRanks()
+{
+    ranks_.clear();
+    uint32_t rank = 0;
+    for (const uint64_t& word : words_) {
+        ranks_.push_back(rank);
+        rank += SimdUtils::PopCount64(word);
+    }
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
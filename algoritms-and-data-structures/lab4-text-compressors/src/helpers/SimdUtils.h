@@ -0,0 +1,385 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SIMD_UTILS_SSE2
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX__)
+    #include <tmmintrin.h>
+    #define SIMD_UTILS_SSSE3
+#endif
+
+
+/**
+ * SimdUtils.
+ *
+ * Brief:
+ * - Class defines static methods which compare / scan / transpose byte arrays using SIMD instructions (AVX2, SSSE3, SSE2) if they are available
+ *
+ * Details:
+ * - If the compiler doesn't support SIMD instructions then scalar versions of the methods are used
+ * - Methods compare 16 or 32 bytes at once and use bit scans of the comparison mask to find the first mismatch (or match for FindByte())
+ * - Prefetch() is a cache hint for pointer chasing (no-op if the compiler has no prefetch intrinsic)
+ * - AddBytes() / PrefixSumBytes() reverse delta filters (modulo 256), PrefixSumBytes() sums 16 bytes by log2(16 / lag) shifted additions
+ * - TransposeBytes() splits 16 rows of stride bytes at once: every plane is gathered from stride registers by byte shuffles
+ *   (masks are built for the given stride, so any stride up to MAX_TRANSPOSE_STRIDE uses the same kernel)
+ */
+class SimdUtils
+{
+private:
+    SimdUtils() = default;
+public:
+    // returns index of the lowest set bit (value must not be 0)
+    static inline uint32_t CountTrailingZeros(const uint32_t value);
+    // returns number of set bits
+    static inline uint32_t PopCount64(const uint64_t value);
+
+    // hints the processor to load the cache line of the address (for pointer chasing, the load isn't required to happen)
+    static inline void Prefetch(const void* address);
+
+    // returns number of leading bytes where a[i] == b[i] (not more than maxLength), arrays may overlap
+    static inline size_t MatchLength(const uint8_t* a, const uint8_t* b, const size_t maxLength);
+
+    // returns the first index i such that data[i] == data[i + 1] or size if there is no such index
+    static inline size_t FindNeighbourRepeat(const uint8_t* data, const size_t size);
+
+    // returns the first index i such that data[i] == value or size if there is no such index
+    static inline size_t FindByte(const uint8_t* data, const size_t size, const uint8_t value);
+
+    // dst[i] = a[i] + b[i] (modulo 256), dst may be the same as a or b
+    static inline void AddBytes(const uint8_t* a, const uint8_t* b, const size_t size, uint8_t* dst);
+
+    // data[i] += data[i - lag] for i >= lag (modulo 256) in order of i, so every byte becomes the sum of bytes i, i - lag, i - 2 * lag, ...
+    static inline void PrefixSumBytes(uint8_t* data, const size_t size, const size_t lag);
+
+    static const size_t MAX_TRANSPOSE_STRIDE = 16;
+
+    // writes bytes with index i % stride == p as plane p (planes one after another), the last incomplete row goes to the first planes
+    static inline void TransposeBytes(const uint8_t* src, const size_t size, const size_t stride, uint8_t* dst);
+    // reverse of TransposeBytes()
+    static inline void UntransposeBytes(const uint8_t* src, const size_t size, const size_t stride, uint8_t* dst);
+};
+
+
+// START IMPLEMENTATION
+
+uint32_t SimdUtils::CountTrailingZeros(const uint32_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctz(value));
+#endif
+}
+
+uint32_t SimdUtils::PopCount64(const uint64_t value)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<uint32_t>(__popcnt64(value));
+#elif defined(__GNUC__) || defined(__clang__)
+    return static_cast<uint32_t>(__builtin_popcountll(value));
+#else
+    uint64_t x = value - ((value >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<uint32_t>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+void SimdUtils::Prefetch(const void* address)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#elif defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
+
+size_t SimdUtils::MatchLength(const uint8_t* a, const uint8_t* b, const size_t maxLength)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    while (i + 32 <= maxLength) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+        if (mask != 0xFFFFFFFFu) {
+            return i + CountTrailingZeros(~mask);
+        }
+        i += 32;
+    }
+#endif
+
+#if defined(SIMD_UTILS_SSE2)
+    while (i + 16 <= maxLength) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)));
+        if (mask != 0xFFFFu) {
+            return i + CountTrailingZeros(~mask);
+        }
+        i += 16;
+    }
+#endif
+
+    while (i < maxLength && a[i] == b[i]) ++i;
+    return i;
+}
+
+size_t SimdUtils::FindNeighbourRepeat(const uint8_t* data, const size_t size)
+{
+    if (size < 2) return size;
+
+    const size_t last = size - 1; // number of neighbour pairs
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    while (i + 32 <= last) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 1));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+        if (mask != 0) {
+            return i + CountTrailingZeros(mask);
+        }
+        i += 32;
+    }
+#endif
+
+#if defined(SIMD_UTILS_SSE2)
+    while (i + 16 <= last) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 1));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)));
+        if (mask != 0) {
+            return i + CountTrailingZeros(mask);
+        }
+        i += 16;
+    }
+#endif
+
+    while (i < last) {
+        if (data[i] == data[i + 1]) return i;
+        ++i;
+    }
+    return size;
+}
+
+size_t SimdUtils::FindByte(const uint8_t* data, const size_t size, const uint8_t value)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i pattern256 = _mm256_set1_epi8(static_cast<char>(value));
+    while (i + 32 <= size) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, pattern256)));
+        if (mask != 0) {
+            return i + CountTrailingZeros(mask);
+        }
+        i += 32;
+    }
+#endif
+
+#if defined(SIMD_UTILS_SSE2)
+    const __m128i pattern128 = _mm_set1_epi8(static_cast<char>(value));
+    while (i + 16 <= size) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, pattern128)));
+        if (mask != 0) {
+            return i + CountTrailingZeros(mask);
+        }
+        i += 16;
+    }
+#endif
+
+    while (i < size) {
+        if (data[i] == value) return i;
+        ++i;
+    }
+    return size;
+}
+
+void SimdUtils::AddBytes(const uint8_t* a, const uint8_t* b, const size_t size, uint8_t* dst)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    while (i + 32 <= size) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_add_epi8(va, vb));
+        i += 32;
+    }
+#endif
+
+#if defined(SIMD_UTILS_SSE2)
+    while (i + 16 <= size) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi8(va, vb));
+        i += 16;
+    }
+#endif
+
+    for (; i < size; ++i) {
+        dst[i] = static_cast<uint8_t>(a[i] + b[i]);
+    }
+}
+
+void SimdUtils::PrefixSumBytes(uint8_t* data, const size_t size, const size_t lag)
+{
+    if (lag == 0) return;
+    size_t i = 0;
+
+#if defined(SIMD_UTILS_SSE2)
+    if (lag == 1 || lag == 2 || lag == 4 || lag == 8) {
+        for (; i + 16 <= size; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            // sums inside the register
+            if (lag <= 1) v = _mm_add_epi8(v, _mm_slli_si128(v, 1));
+            if (lag <= 2) v = _mm_add_epi8(v, _mm_slli_si128(v, 2));
+            if (lag <= 4) v = _mm_add_epi8(v, _mm_slli_si128(v, 4));
+            v = _mm_add_epi8(v, _mm_slli_si128(v, 8));
+            // add the last lag bytes of the previous register to every group of lag bytes
+            if (i > 0) {
+                __m128i carry;
+                if (lag == 1) {
+                    carry = _mm_set1_epi8(static_cast<char>(data[i - 1]));
+                } else if (lag == 2) {
+                    uint16_t last; std::memcpy(&last, data + i - 2, 2);
+                    carry = _mm_set1_epi16(static_cast<short>(last));
+                } else if (lag == 4) {
+                    uint32_t last; std::memcpy(&last, data + i - 4, 4);
+                    carry = _mm_set1_epi32(static_cast<int>(last));
+                } else {
+                    carry = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data + i - 8));
+                    carry = _mm_unpacklo_epi64(carry, carry);
+                }
+                v = _mm_add_epi8(v, carry);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), v);
+        }
+    }
+#endif
+
+    for (i = std::max(i, lag); i < size; ++i) {
+        data[i] = static_cast<uint8_t>(data[i] + data[i - lag]);
+    }
+}
+
+void SimdUtils::TransposeBytes(const uint8_t* src, const size_t size, const size_t stride, uint8_t* dst)
+{
+    if (stride <= 1) {
+        if (size > 0) std::memcpy(dst, src, size);
+        return;
+    }
+    const size_t rows = size / stride, rest = size % stride;
+    size_t row = 0;
+
+#if defined(SIMD_UTILS_SSSE3)
+    if (stride <= MAX_TRANSPOSE_STRIDE) {
+        // masks[p][r] takes bytes of plane p from register r (0x80 - zero byte)
+        uint8_t masks[MAX_TRANSPOSE_STRIDE][MAX_TRANSPOSE_STRIDE][16];
+        for (size_t p = 0; p < stride; ++p) {
+            for (size_t r = 0; r < stride; ++r) {
+                for (size_t j = 0; j < 16; ++j) {
+                    const size_t e = j * stride + p;
+                    masks[p][r][j] = (e / 16 == r) ? static_cast<uint8_t>(e % 16) : 0x80;
+                }
+            }
+        }
+        __m128i registers[MAX_TRANSPOSE_STRIDE];
+        for (; row + 16 <= rows; row += 16) {
+            for (size_t r = 0; r < stride; ++r) {
+                registers[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + row * stride + r * 16));
+            }
+            for (size_t p = 0; p < stride; ++p) {
+                __m128i plane = _mm_setzero_si128();
+                for (size_t r = 0; r < stride; ++r) {
+                    plane = _mm_or_si128(plane, _mm_shuffle_epi8(registers[r], _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks[p][r]))));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + p * rows + std::min(p, rest) + row), plane);
+            }
+        }
+    }
+#endif
+
+    for (size_t p = 0; p < stride; ++p) {
+        uint8_t* plane = dst + p * rows + std::min(p, rest);
+        for (size_t i = row; i < rows; ++i) {
+            plane[i] = src[i * stride + p];
+        }
+        if (p < rest) {
+            plane[rows] = src[rows * stride + p];
+        }
+    }
+}
+
+void SimdUtils::UntransposeBytes(const uint8_t* src, const size_t size, const size_t stride, uint8_t* dst)
+{
+    if (stride <= 1) {
+        if (size > 0) std::memcpy(dst, src, size);
+        return;
+    }
+    const size_t rows = size / stride, rest = size % stride;
+    size_t row = 0;
+
+#if defined(SIMD_UTILS_SSSE3)
+    if (stride <= MAX_TRANSPOSE_STRIDE) {
+        // masks[o][p] takes bytes of output register o from plane p (0x80 - zero byte)
+        uint8_t masks[MAX_TRANSPOSE_STRIDE][MAX_TRANSPOSE_STRIDE][16];
+        for (size_t o = 0; o < stride; ++o) {
+            for (size_t p = 0; p < stride; ++p) {
+                for (size_t j = 0; j < 16; ++j) {
+                    const size_t e = o * 16 + j;
+                    masks[o][p][j] = (e % stride == p) ? static_cast<uint8_t>(e / stride) : 0x80;
+                }
+            }
+        }
+        __m128i planes[MAX_TRANSPOSE_STRIDE];
+        for (; row + 16 <= rows; row += 16) {
+            for (size_t p = 0; p < stride; ++p) {
+                planes[p] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + p * rows + std::min(p, rest) + row));
+            }
+            for (size_t o = 0; o < stride; ++o) {
+                __m128i output = _mm_setzero_si128();
+                for (size_t p = 0; p < stride; ++p) {
+                    output = _mm_or_si128(output, _mm_shuffle_epi8(planes[p], _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks[o][p]))));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + row * stride + o * 16), output);
+            }
+        }
+    }
+#endif
+
+    for (size_t p = 0; p < stride; ++p) {
+        const uint8_t* plane = src + p * rows + std::min(p, rest);
+        for (size_t i = row; i < rows; ++i) {
+            dst[i * stride + p] = plane[i];
+        }
+        if (p < rest) {
+            dst[rows * stride + p] = plane[rows];
+        }
+    }
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
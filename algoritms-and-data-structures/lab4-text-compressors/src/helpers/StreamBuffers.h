@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <ios>
+#include <streambuf>
+
+#include "CRC32C.h"
+
+
+/**
+ * StreamBuffers.
+ *
+ * Brief:
+ * - CRC32CStreamBuffer passes written bytes to another stream buffer and computes CRC-32C of them on the way
+ * - MemoryStreamBuffer gives bytes of an array to a reading stream
+ * - StreamBufferSwap makes a stream use another buffer until the end of its lifetime
+ *
+ * Memory usage:
+ * CRC32CStreamBuffer: θ(BUFFER_SIZE), MemoryStreamBuffer: O(1) (the array is owned by the caller)
+ *
+ * Details:
+ * - Codecs read and write std::ifstream / std::ofstream, StreamBufferSwap replaces the buffer of such a stream,
+ *   so the codecs don't know that their bytes go through a CRC or come from memory
+ * - CRC32CStreamBuffer collects up to BUFFER_SIZE bytes, computes their CRC and writes them to the target at once,
+ *   so small writes of codecs cost a copy, not a virtual call of the target. tellp() of the stream is the position of the target
+ * - MemoryStreamBuffer reads past the end of the array as the end of file (eof() of the stream becomes true)
+ */
+class CRC32CStreamBuffer : public std::streambuf
+{
+public:
+    explicit CRC32CStreamBuffer(std::streambuf* target) : target_(target), crc_(0), failed_(false) {
+        setp(buffer_, buffer_ + BUFFER_SIZE);
+    }
+    ~CRC32CStreamBuffer() override { flushBuffer(); }
+    CRC32CStreamBuffer(const CRC32CStreamBuffer&) = delete;
+    CRC32CStreamBuffer& operator=(const CRC32CStreamBuffer&) = delete;
+
+    // CRC-32C of all bytes written so far
+    uint32_t GetCrc() { flushBuffer(); return crc_; }
+    // false - the target didn't accept some bytes
+    bool Good() { return flushBuffer(); }
+protected:
+    int_type overflow(int_type c) override {
+        if (!flushBuffer()) return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+    int sync() override { return (flushBuffer() && target_->pubsync() == 0) ? 0 : -1; }
+    pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode) override {
+        // only the current position is known (tellp())
+        if (offset != 0 || direction != std::ios_base::cur || !flushBuffer()) return pos_type(off_type(-1));
+        return target_->pubseekoff(0, std::ios_base::cur, mode);
+    }
+private:
+    static const size_t BUFFER_SIZE = 1 << 16;
+
+    std::streambuf* target_;
+    uint32_t crc_;
+    bool failed_;
+    char buffer_[BUFFER_SIZE];
+
+    bool flushBuffer() {
+        const std::streamsize size = pptr() - pbase();
+        if (size > 0) {
+            crc_ = CRC32C::Compute(pbase(), static_cast<size_t>(size), crc_);
+            if (target_->sputn(pbase(), size) != size) failed_ = true;
+            setp(buffer_, buffer_ + BUFFER_SIZE);
+        }
+        return !failed_;
+    }
+};
+
+class MemoryStreamBuffer : public std::streambuf
+{
+public:
+    MemoryStreamBuffer(const char* data, const size_t size) {
+        char* begin = const_cast<char*>(data); // the get area is only read
+        setg(begin, begin, begin + size);
+    }
+protected:
+    pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode) override {
+        if (!(mode & std::ios_base::in)) return pos_type(off_type(-1));
+        const off_type base = (direction == std::ios_base::beg) ? 0 : ((direction == std::ios_base::cur) ? gptr() - eback() : egptr() - eback());
+        return seekpos(pos_type(base + offset), mode);
+    }
+    pos_type seekpos(pos_type position, std::ios_base::openmode mode) override {
+        const off_type offset = off_type(position);
+        if (!(mode & std::ios_base::in) || offset < 0 || offset > egptr() - eback()) return pos_type(off_type(-1));
+        setg(eback(), eback() + offset, egptr());
+        return position;
+    }
+};
+
+class StreamBufferSwap
+{
+public:
+    StreamBufferSwap(std::ios& stream, std::streambuf* buffer) : stream_(stream), previous_(stream.rdbuf(buffer)) {}
+    ~StreamBufferSwap() { stream_.rdbuf(previous_); }
+    StreamBufferSwap(const StreamBufferSwap&) = delete;
+    StreamBufferSwap& operator=(const StreamBufferSwap&) = delete;
+private:
+    std::ios& stream_;
+    std::streambuf* previous_;
+};
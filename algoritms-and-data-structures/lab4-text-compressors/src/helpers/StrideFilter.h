@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+#include "SimdUtils.h"
+#include "StringL.h"
+
+
+/**
+ * StrideFilter.
+ *
+ * Brief:
+ * - Class defines static methods to transpose a string with the given stride (de-interleave channels) and back
+ *
+ * Memory usage:
+ * θ(sizeof(inputStr))
+ *
+ * Details:
+ * - Characters with index i % stride == p go to plane p, planes are written one after another
+ *   (for RGB image with stride 3: all red bytes, then all green bytes, then all blue bytes)
+ * - The last incomplete row goes to the first planes, so the size of the string isn't changed and no padding is needed
+ * - For 8-bit strings SimdUtils::TransposeBytes() is used (byte shuffles)
+ */
+class StrideFilter
+{
+private:
+    StrideFilter() = default;
+public:
+    static const size_t MAX_STRIDE = SimdUtils::MAX_TRANSPOSE_STRIDE;
+
+    template <typename charType>
+    static StringL<charType> Transpose(const StringL<charType>& inputStr, const size_t stride);
+    template <typename charType>
+    static StringL<charType> Untranspose(const StringL<charType>& inputStr, const size_t stride);
+};
+
+
+// START IMPLEMENTATION
+
+template <typename charType>
+StringL<charType> StrideFilter::Transpose(const StringL<charType>& inputStr, const size_t stride)
+{
+    if (stride < 1 || stride > MAX_STRIDE) {
+        throw std::invalid_argument("StrideFilter: Stride should be in [1, 16]!");
+    }
+    StringL<charType> result(inputStr.size(), 0);
+    if (sizeof(charType) == 1) {
+        SimdUtils::TransposeBytes(reinterpret_cast<const uint8_t*>(inputStr.c_str()), inputStr.size(), stride, reinterpret_cast<uint8_t*>(result.begin()));
+        return result;
+    }
+
+    const size_t rows = inputStr.size() / stride, rest = inputStr.size() % stride;
+    charType* plane = result.begin();
+    for (size_t p = 0; p < stride; ++p) {
+        const size_t planeSize = rows + (p < rest ? 1 : 0);
+        for (size_t i = 0; i < planeSize; ++i) {
+            plane[i] = inputStr[i * stride + p];
+        }
+        plane += planeSize;
+    }
+    return result;
+}
+
+template <typename charType>
+StringL<charType> StrideFilter::Untranspose(const StringL<charType>& inputStr, const size_t stride)
+{
+    if (stride < 1 || stride > MAX_STRIDE) {
+        throw std::invalid_argument("StrideFilter: Stride should be in [1, 16]!");
+    }
+    StringL<charType> result(inputStr.size(), 0);
+    if (sizeof(charType) == 1) {
+        SimdUtils::UntransposeBytes(reinterpret_cast<const uint8_t*>(inputStr.c_str()), inputStr.size(), stride, reinterpret_cast<uint8_t*>(result.begin()));
+        return result;
+    }
+
+    const size_t rows = inputStr.size() / stride, rest = inputStr.size() % stride;
+    const charType* plane = inputStr.c_str();
+    charType* output = result.begin();
+    for (size_t p = 0; p < stride; ++p) {
+        const size_t planeSize = rows + (p < rest ? 1 : 0);
+        for (size_t i = 0; i < planeSize; ++i) {
+            output[i * stride + p] = plane[i];
+        }
+        plane += planeSize;
+    }
+    return result;
+}
+
+// END IMPLEMENTATION
\ No newline at end of file
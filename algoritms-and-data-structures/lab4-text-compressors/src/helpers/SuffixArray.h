@@ -2,7 +2,12 @@
 
 #include <iostream>
 #include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <stdexcept>
 
+#include "AlphabetMap.h"
 #include "StringL.h"
 #include "Array.h"
 
@@ -84,4 +89,387 @@ Array<int> buildSuffixArray(const StringL<charType>& txt, const charType endChar
 }
 
 
+// runs function(begin, end, threadIndex) on threadsCount nearly equal parts of [0, size) in parallel
+template <typename functionType>
+static void _parallel_for(const size_t size, const size_t threadsCount, functionType function)
+{
+	if (threadsCount <= 1) {
+		function(0, size, 0);
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadsCount - 1);
+	for (size_t t = 1; t < threadsCount; ++t) {
+		threads.emplace_back(function, size * t / threadsCount, size * (t + 1) / threadsCount, t);
+	}
+	function(0, size / threadsCount, 0);
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+// stable LSD radix sort of items[0..size) by rank[item] (8 bits per pass, only passes up to the highest byte of maxRank)
+static void _radix_sort_by_rank(uint32_t*& items, uint32_t*& buffer, const size_t size, const uint32_t* rank, const uint32_t maxRank, const size_t threadsCount)
+{
+	Array<size_t> histograms(threadsCount * 256, 0);
+
+	for (uint32_t shift = 0; shift < 32 && (maxRank >> shift) > 0; shift += 8) {
+		// count digits in every part
+		for (size_t i = 0; i < histograms.size(); ++i) histograms[i] = 0;
+		_parallel_for(size, threadsCount, [&](const size_t begin, const size_t end, const size_t t) {
+			size_t* histogram = histograms.begin() + t * 256;
+			for (size_t j = begin; j < end; ++j) {
+				++histogram[(rank[items[j]] >> shift) & 255];
+			}
+		});
+
+		// get positions of every (digit, part) in the output
+		size_t position = 0;
+		for (size_t digit = 0; digit < 256; ++digit) {
+			for (size_t t = 0; t < threadsCount; ++t) {
+				size_t count = histograms[t * 256 + digit];
+				histograms[t * 256 + digit] = position;
+				position += count;
+			}
+		}
+
+		// scatter items (every part writes to its own positions)
+		_parallel_for(size, threadsCount, [&](const size_t begin, const size_t end, const size_t t) {
+			size_t* positions = histograms.begin() + t * 256;
+			for (size_t j = begin; j < end; ++j) {
+				buffer[positions[(rank[items[j]] >> shift) & 255]++] = items[j];
+			}
+		});
+		std::swap(items, buffer);
+	}
+}
+
+// build suffix array of string after pushing endChar to the back using several threads
+// (prefix doubling: every round suffixes are ordered by the second half with previous order and sorted by the first half with parallel radix sort)
+// result is the same as buildSuffixArray() gives
+template <typename charType>
+Array<int> buildSuffixArrayParallel(const StringL<charType>& txt, const charType endChar, size_t threadsCount)
+{
+	const size_t NEW_SIZE = txt.size() + 1; // length of new text (with endChar at the end)
+	if (threadsCount < 1) threadsCount = 1;
+
+	Array<uint32_t> saArray(NEW_SIZE, 0), bufferArray(NEW_SIZE, 0), rankArray(NEW_SIZE, 0), newRankArray(NEW_SIZE, 0);
+	uint32_t* sa = saArray.begin();
+	uint32_t* buffer = bufferArray.begin();
+	uint32_t* rank = rankArray.begin();
+	uint32_t* newRank = newRankArray.begin();
+
+	// initial ranks are characters (0 is reserved for the positions after the end of text)
+	uint32_t maxRank = 0;
+	for (size_t i = 0; i < NEW_SIZE; ++i) {
+		rank[i] = static_cast<uint32_t>((i < txt.size()) ? txt[i] : endChar) + 1;
+		maxRank = std::max(maxRank, rank[i]);
+		sa[i] = static_cast<uint32_t>(i);
+	}
+	_radix_sort_by_rank(sa, buffer, NEW_SIZE, rank, maxRank, threadsCount);
+
+	Array<size_t> partCounts(threadsCount, 0);
+	for (size_t k = 0; ; k = (k == 0) ? 1 : k * 2)
+	{
+		if (k > 0) {
+			// order by the second half: suffixes without it go first, others follow the current order of (i + k)
+			size_t count = 0;
+			for (size_t i = NEW_SIZE - k; i < NEW_SIZE; ++i) {
+				buffer[count++] = static_cast<uint32_t>(i);
+			}
+			for (size_t j = 0; j < NEW_SIZE; ++j) {
+				if (sa[j] >= k) buffer[count++] = sa[j] - static_cast<uint32_t>(k);
+			}
+			std::swap(sa, buffer);
+			// stable sort by the first half
+			_radix_sort_by_rank(sa, buffer, NEW_SIZE, rank, maxRank, threadsCount);
+		}
+
+		// calculate new ranks: rank of the group of equal (rank[i], rank[i + k]) pairs
+		auto differs = [&](const size_t j) {
+			if (j == 0) return true;
+			const uint32_t a = sa[j], b = sa[j - 1];
+			if (rank[a] != rank[b]) return true;
+			if (k == 0) return false;
+			const uint32_t secondA = (a + k < NEW_SIZE) ? rank[a + k] : 0;
+			const uint32_t secondB = (b + k < NEW_SIZE) ? rank[b + k] : 0;
+			return secondA != secondB;
+		};
+		_parallel_for(NEW_SIZE, threadsCount, [&](const size_t begin, const size_t end, const size_t t) {
+			size_t count = 0;
+			for (size_t j = begin; j < end; ++j) count += differs(j);
+			partCounts[t] = count;
+		});
+		size_t base = 0;
+		for (size_t t = 0; t < threadsCount; ++t) {
+			size_t count = partCounts[t];
+			partCounts[t] = base;
+			base += count;
+		}
+		_parallel_for(NEW_SIZE, threadsCount, [&](const size_t begin, const size_t end, const size_t t) {
+			uint32_t currentRank = static_cast<uint32_t>(partCounts[t]);
+			for (size_t j = begin; j < end; ++j) {
+				currentRank += differs(j);
+				newRank[sa[j]] = currentRank;
+			}
+		});
+		std::swap(rank, newRank);
+		maxRank = static_cast<uint32_t>(base);
+
+		if (maxRank == NEW_SIZE || k >= NEW_SIZE) break; // all suffixes are different
+	}
+
+	// Concatenate suffixes to an array
+	Array<int> suffixArr(NEW_SIZE);
+	for (size_t i = 0; i < NEW_SIZE; ++i)
+		suffixArr.push_back(static_cast<int>(sa[i]));
+
+	return suffixArr;
+}
+
+// text of SA-IS recursion levels (names of LMS substrings)
+struct _sais_int_text
+{
+	const int* s;
+	int operator[](const size_t i) const { return s[i]; }
+};
+
+// text of the top SA-IS level: dense ranks of characters of txt and endChar (shifted by 1), then the unique smallest sentinel 0,
+// so order of suffixes is the same as buildSuffixArray() gives (positions after the end of text are the smallest)
+template <typename charType>
+struct _sais_top_text
+{
+	const StringL<charType>& txt;
+	const AlphabetMap<charType>& alphabetMap;
+	const charType endChar;
+	const int endRank; // rank of endChar + 1
+	const bool shiftRanks; // endChar isn't in txt, characters greater than it get rank + 1
+
+	int operator[](const size_t i) const {
+		if (i < txt.size()) {
+			return static_cast<int>(alphabetMap.Rank(txt[i])) + ((shiftRanks && txt[i] > endChar) ? 2 : 1);
+		}
+		return (i == txt.size()) ? endRank : 0;
+	}
+};
+
+// starts (end == false) or ends (end == true) of buckets of characters [0, K]
+template <typename textType>
+static void _sais_buckets(const textType& s, int* bkt, const int n, const int K, const bool end)
+{
+	for (int i = 0; i <= K; ++i) bkt[i] = 0;
+	for (int i = 0; i < n; ++i) ++bkt[s[i]];
+	int sum = 0;
+	for (int i = 0; i <= K; ++i) {
+		sum += bkt[i];
+		bkt[i] = end ? sum : sum - bkt[i];
+	}
+}
+
+// induce L-type suffixes from the left to the right, then S-type suffixes from the right to the left
+template <typename textType>
+static void _sais_induce(const textType& s, const uint8_t* types, int* SA, int* bkt, const int n, const int K)
+{
+	auto isS = [types](const int i) { return (types[i >> 3] >> (i & 7)) & 1; };
+	_sais_buckets(s, bkt, n, K, false);
+	for (int i = 0; i < n; ++i) {
+		const int j = SA[i] - 1;
+		if (j >= 0 && !isS(j)) SA[bkt[s[j]]++] = j;
+	}
+	_sais_buckets(s, bkt, n, K, true);
+	for (int i = n - 1; i >= 0; --i) {
+		const int j = SA[i] - 1;
+		if (j >= 0 && isS(j)) SA[--bkt[s[j]]] = j;
+	}
+}
+
+// SA-IS (Nong, Zhang, Chan): s[n - 1] is the unique smallest character 0, other characters are in [1, K].
+// Memory besides SA: n / 8 bytes of types and K + 1 buckets, the reduced string of the next level is kept in the second half of SA
+template <typename textType>
+static void _sais(const textType& s, int* SA, const int n, const int K)
+{
+	if (n == 1) {
+		SA[0] = 0;
+		return;
+	}
+
+	// types of suffixes: S (1) or L (0), the sentinel is S
+	Array<uint8_t> typesArray(static_cast<size_t>(n) / 8 + 1, 0);
+	uint8_t* types = typesArray.begin();
+	auto setS = [types](const int i) { types[i >> 3] |= static_cast<uint8_t>(1 << (i & 7)); };
+	auto isS = [types](const int i) { return (types[i >> 3] >> (i & 7)) & 1; };
+	auto isLMS = [&isS](const int i) { return i > 0 && isS(i) && !isS(i - 1); };
+	setS(n - 1);
+	for (int i = n - 2; i >= 0; --i) {
+		if (s[i] < s[i + 1] || (s[i] == s[i + 1] && isS(i + 1))) setS(i);
+	}
+
+	// sort LMS substrings: put LMS positions to the ends of buckets and induce
+	Array<int> bktArray(static_cast<size_t>(K) + 1, 0);
+	int* bkt = bktArray.begin();
+	_sais_buckets(s, bkt, n, K, true);
+	for (int i = 0; i < n; ++i) SA[i] = -1;
+	for (int i = 1; i < n; ++i) {
+		if (isLMS(i)) SA[--bkt[s[i]]] = i;
+	}
+	_sais_induce(s, types, SA, bkt, n, K);
+
+	// compact sorted LMS substrings to the first n1 positions and name them
+	int n1 = 0;
+	for (int i = 0; i < n; ++i) {
+		if (isLMS(SA[i])) SA[n1++] = SA[i];
+	}
+	for (int i = n1; i < n; ++i) SA[i] = -1;
+	int name = 0, prev = -1;
+	for (int i = 0; i < n1; ++i) {
+		const int position = SA[i];
+		bool differs = false;
+		for (int d = 0; d < n; ++d) {
+			if (prev == -1 || s[position + d] != s[prev + d] || isS(position + d) != isS(prev + d)) {
+				differs = true;
+				break;
+			}
+			if (d > 0 && (isLMS(position + d) || isLMS(prev + d))) break;
+		}
+		if (differs) {
+			++name;
+			prev = position;
+		}
+		SA[n1 + position / 2] = name - 1; // LMS positions differ by at least 2
+	}
+	for (int i = n - 1, j = n - 1; i >= n1; --i) {
+		if (SA[i] >= 0) SA[j--] = SA[i];
+	}
+
+	// sort LMS suffixes by the reduced string (recursively if names aren't unique)
+	int* SA1 = SA;
+	int* s1 = SA + n - n1;
+	if (name < n1) {
+		_sais(_sais_int_text{ s1 }, SA1, n1, name - 1);
+	} else {
+		for (int i = 0; i < n1; ++i) SA1[s1[i]] = i;
+	}
+
+	// put sorted LMS suffixes to the ends of buckets and induce the whole suffix array
+	for (int i = 1, j = 0; i < n; ++i) {
+		if (isLMS(i)) s1[j++] = i;
+	}
+	for (int i = 0; i < n1; ++i) SA1[i] = s1[SA1[i]];
+	for (int i = n1; i < n; ++i) SA[i] = -1;
+	_sais_buckets(s, bkt, n, K, true);
+	for (int i = n1 - 1; i >= 0; --i) {
+		const int j = SA[i];
+		SA[i] = -1;
+		SA[--bkt[s[j]]] = j;
+	}
+	_sais_induce(s, types, SA, bkt, n, K);
+}
+
+// build suffix array of string after pushing endChar to the back in linear time with little memory (SA-IS):
+// besides the result it uses n / 8 bytes and O(alphabetSize) for the top level (the result is the same as buildSuffixArray() gives)
+template <typename charType>
+Array<int> buildSuffixArrayLowMemory(const StringL<charType>& txt, const charType endChar)
+{
+	const size_t NEW_SIZE = txt.size() + 1; // length of new text (with endChar at the end)
+	if (NEW_SIZE + 1 > static_cast<size_t>(INT32_MAX)) {
+		throw std::invalid_argument("buildSuffixArrayLowMemory(): Text is too long!");
+	}
+
+	// dense ranks of characters and endChar
+	AlphabetMap<charType> alphabetMap(txt);
+	const bool shiftRanks = !alphabetMap.Contains(endChar);
+	int endRank = 1;
+	for (const charType& c : alphabetMap.GetSymbols()) {
+		if (c < endChar) ++endRank;
+	}
+	const int K = static_cast<int>(alphabetMap.Size()) + (shiftRanks ? 1 : 0);
+	const _sais_top_text<charType> text{ txt, alphabetMap, endChar, endRank, shiftRanks };
+
+	// suffix array of text + sentinel, the sentinel is the first suffix
+	Array<int> suffixArr(NEW_SIZE + 1, 0);
+	_sais(text, suffixArr.begin(), static_cast<int>(NEW_SIZE + 1), K);
+	for (size_t i = 0; i < NEW_SIZE; ++i) {
+		suffixArr[i] = suffixArr[i + 1];
+	}
+	suffixArr.pop_back();
+
+	return suffixArr;
+}
+
+// build LCP array of suffix array of string after pushing endChar to the back (Kasai):
+// lcp[i] - length of the longest common prefix of suffixes suffixArr[i - 1] and suffixArr[i], lcp[0] = 0 (endChar isn't a part of common prefixes)
+// the next suffix of the text loses at most one character of its common prefix, so all comparisons take linear time
+template <typename charType>
+Array<uint32_t> buildLCPArray(const StringL<charType>& txt, const Array<int>& suffixArr)
+{
+	const size_t NEW_SIZE = suffixArr.size(); // length of text with endChar
+
+	Array<uint32_t> rank(NEW_SIZE, 0);
+	for (size_t i = 0; i < NEW_SIZE; ++i)
+		rank[suffixArr[i]] = static_cast<uint32_t>(i);
+
+	Array<uint32_t> lcp(NEW_SIZE, 0);
+	size_t h = 0;
+	for (size_t i = 0; i < NEW_SIZE; ++i) {
+		if (rank[i] == 0) {
+			h = 0;
+			continue;
+		}
+		const size_t j = static_cast<size_t>(suffixArr[rank[i] - 1]);
+		while (i + h < txt.size() && j + h < txt.size() && txt[i + h] == txt[j + h]) ++h;
+		lcp[rank[i]] = static_cast<uint32_t>(h);
+		if (h > 0) --h;
+	}
+	return lcp;
+}
+
+// longest previous factor of every position i of the text of suffixArr (LZ77 factorization without window):
+// lengths[i] - length of the longest prefix of suffix i which also starts at some position j < i (it may overlap i), sources[i] - the nearest such j
+// (i if there is no match). The best j is the nearest suffix with a smaller position before or after i in suffix array order (PSV / NSV),
+// both are found by one pass with a stack in each direction, the common prefix is the minimum of LCP values between them, so time is linear
+static void buildLongestPreviousFactors(const Array<int>& suffixArr, const Array<uint32_t>& lcp, Array<uint32_t>& lengths, Array<uint32_t>& sources)
+{
+	const size_t NEW_SIZE = suffixArr.size(); // length of text with endChar
+
+	lengths = Array<uint32_t>(NEW_SIZE, 0);
+	sources = Array<uint32_t>(NEW_SIZE, 0);
+	for (size_t i = 0; i < NEW_SIZE; ++i)
+		sources[i] = static_cast<uint32_t>(i);
+
+	// stack keeps suffixes with increasing positions and common prefix of every suffix with the next one in the stack (or with the last processed)
+	Array<uint32_t> stackIndices(NEW_SIZE);
+	Array<uint32_t> stackLcps(NEW_SIZE);
+	for (int direction = 0; direction < 2; ++direction)
+	{
+		stackIndices.clear();
+		stackLcps.clear();
+		for (size_t step = 0; step < NEW_SIZE; ++step)
+		{
+			const size_t i = (direction == 0) ? step : NEW_SIZE - 1 - step;
+			const uint32_t position = static_cast<uint32_t>(suffixArr[i]);
+			if (stackIndices.size() > 0) {
+				// the last processed suffix is the top, its neighbour in suffix array order
+				uint32_t common = std::min(stackLcps[stackLcps.size() - 1], (direction == 0) ? lcp[i] : lcp[i + 1]);
+				while (stackIndices.size() > 0 && static_cast<uint32_t>(suffixArr[stackIndices[stackIndices.size() - 1]]) > position) {
+					stackIndices.pop_back();
+					stackLcps.pop_back();
+					if (stackLcps.size() > 0) common = std::min(common, stackLcps[stackLcps.size() - 1]);
+				}
+				if (stackIndices.size() > 0) {
+					const uint32_t source = static_cast<uint32_t>(suffixArr[stackIndices[stackIndices.size() - 1]]);
+					if (common > lengths[position] || (common == lengths[position] && common > 0 && source > sources[position])) {
+						lengths[position] = common;
+						sources[position] = source;
+					}
+					stackLcps[stackLcps.size() - 1] = common;
+				}
+			}
+			stackIndices.push_back(static_cast<uint32_t>(i));
+			stackLcps.push_back(UINT32_MAX);
+		}
+	}
+}
+
+
 // END
\ No newline at end of file
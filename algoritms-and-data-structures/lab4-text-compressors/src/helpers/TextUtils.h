@@ -9,6 +9,7 @@
 
 #include "FileUtils.h"
 #include "CodecUTF8.h"
+#include "AlphabetMap.h"
 #include "StringL.h"
 #include "Array.h"
 
@@ -84,24 +85,19 @@ double TextUtils::GetTextEntropy(const char* filepath)
 template <typename charType>
 Array<charType> TextUtils::GetAlphabet(const StringL<charType>& str)
 {
-    std::set<charType> charsSet(str.begin(), str.end());
-    Array<charType> alphabet(charsSet.size());
-
-    for (charType c : charsSet) { 
-        alphabet.push_back(c);
-    }
-
-    std::sort(alphabet.begin(), alphabet.end());
-    return alphabet;
+    // AlphabetMap collects characters in ascending order by array lookups (no tree of characters)
+    AlphabetMap<charType> alphabetMap(str);
+    return alphabetMap.GetSymbols();
 }
 
 template <typename charType>
 Array<double> TextUtils::GetFrequencies(const StringL<charType>& str, const Array<charType>& alphabet)
 {
-    std::map<charType, size_t> charCounts = GetCharCountsMap<charType>(str);
+    AlphabetMap<charType> alphabetMap(str);
     Array<double> frequencies(alphabet.size());
     for (size_t i = 0; i < alphabet.size(); ++i) {
-        frequencies.push_back(static_cast<double>(charCounts[alphabet[i]]) / static_cast<double>(str.size()));
+        const size_t count = alphabetMap.Contains(alphabet[i]) ? alphabetMap.GetCounts()[alphabetMap.Rank(alphabet[i])] : 0;
+        frequencies.push_back(static_cast<double>(count) / static_cast<double>(str.size()));
     }
     return frequencies;
 }
@@ -109,10 +105,10 @@ Array<double> TextUtils::GetFrequencies(const StringL<charType>& str, const Arra
 template <typename charType>
 Array<uint32_t> TextUtils::GetFrequenciesInt(const StringL<charType>& str, const Array<charType>& alphabet)
 {
-    std::map<charType, size_t> charCounts = GetCharCountsMap<charType>(str);
+    AlphabetMap<charType> alphabetMap(str);
     Array<uint32_t> frequencies(alphabet.size());
     for (size_t i = 0; i < alphabet.size(); ++i) {
-        frequencies.push_back(charCounts[alphabet[i]]);
+        frequencies.push_back(alphabetMap.Contains(alphabet[i]) ? alphabetMap.GetCounts()[alphabetMap.Rank(alphabet[i])] : 0);
     }
     return frequencies;
 }
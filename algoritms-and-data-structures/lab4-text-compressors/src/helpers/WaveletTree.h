@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+#include "RankBitVector.h"
+#include "Array.h"
+
+
+/**
+ * WaveletTree.
+ *
+ * Brief:
+ * - Class defines a wavelet tree over a sequence of values in [0, alphabetSize): the value at any position
+ *   and the number of occurrences of a value before any position in θ(log(alphabetSize)) time
+ *
+ * Memory usage:
+ * θ(size * log(alphabetSize) * 3 / 16) bytes
+ *
+ * Details:
+ * - Levels of the tree are kept as one bit vector per level (levelwise layout, a.k.a. wavelet matrix): level l holds bit l
+ *   (from the highest) of every value, values are stably partitioned by this bit before the next level,
+ *   so nodes of the tree are ranges of the levels and no pointers are needed
+ * - A value goes to position zeros[l] + rank1 (bit 1) or rank0 (bit 0) on the next level,
+ *   the range of value v on the last level starts where position 0 goes by the bits of v
+ * - AccessRank() returns the value and its rank in one pass over levels (LF-mapping of an FM-index needs both)
+ */
+class WaveletTree
+{
+public:
+    static const uint32_t MAX_LEVELS = 32;
+
+    WaveletTree() : size_(0), levels_(0) {}
+
+    void Build(const uint32_t* values, const size_t size, const uint32_t alphabetSize);
+
+    size_t Size() const { return size_; }
+    // number of occurrences of value in [0, position)
+    inline uint32_t Rank(const uint32_t value, const size_t position) const;
+    // value at position, rank gets the number of its occurrences in [0, position)
+    inline uint32_t AccessRank(const size_t position, uint32_t& rank) const;
+
+    void FreeMemory() { for (uint32_t l = 0; l < levels_; ++l) bits_[l].FreeMemory(); size_ = 0; levels_ = 0; }
+private:
+    RankBitVector bits_[MAX_LEVELS];
+    uint32_t zeros_[MAX_LEVELS]; // number of values with 0 bit on the level
+    size_t size_;
+    uint32_t levels_;
+};
+
+
+// START IMPLEMENTATION
+
+void WaveletTree::Build(const uint32_t* values, const size_t size, const uint32_t alphabetSize)
+{
+    size_ = size;
+    levels_ = 1;
+    while (levels_ < MAX_LEVELS && (static_cast<uint64_t>(1) << levels_) < alphabetSize) ++levels_;
+
+    Array<uint32_t> firstBuffer(values, size);
+    Array<uint32_t> secondBuffer(size, 0);
+    uint32_t* current = firstBuffer.begin();
+    uint32_t* next = secondBuffer.begin();
+    for (uint32_t l = 0; l < levels_; ++l) {
+        const uint32_t shift = levels_ - 1 - l;
+        bits_[l].Reset(size);
+        size_t zeros = 0;
+        for (size_t i = 0; i < size; ++i) {
+            if ((current[i] >> shift) & 1) {
+                bits_[l].Set(i);
+            } else {
+                ++zeros;
+            }
+        }
+        bits_[l].BuildRanks();
+        zeros_[l] = static_cast<uint32_t>(zeros);
+
+        // stable partition: values with 0 bit, then values with 1 bit
+        size_t zeroPosition = 0, onePosition = zeros;
+        for (size_t i = 0; i < size; ++i) {
+            if ((current[i] >> shift) & 1) {
+                next[onePosition++] = current[i];
+            } else {
+                next[zeroPosition++] = current[i];
+            }
+        }
+        std::swap(current, next);
+    }
+}
+
+uint32_t WaveletTree::Rank(const uint32_t value, const size_t position) const
+{
+    size_t begin = 0, end = position;
+    for (uint32_t l = 0; l < levels_; ++l) {
+        const uint32_t beginOnes = bits_[l].Rank(begin);
+        const uint32_t endOnes = bits_[l].Rank(end);
+        if ((value >> (levels_ - 1 - l)) & 1) {
+            begin = zeros_[l] + beginOnes;
+            end = zeros_[l] + endOnes;
+        } else {
+            begin -= beginOnes;
+            end -= endOnes;
+        }
+    }
+    return static_cast<uint32_t>(end - begin);
+}
+
+uint32_t WaveletTree::AccessRank(const size_t position, uint32_t& rank) const
+{
+    uint32_t value = 0;
+    size_t begin = 0, current = position;
+    for (uint32_t l = 0; l < levels_; ++l) {
+        const uint32_t beginOnes = bits_[l].Rank(begin);
+        const uint32_t currentOnes = bits_[l].Rank(current);
+        if (bits_[l].Get(current)) {
+            value = (value << 1) | 1;
+            begin = zeros_[l] + beginOnes;
+            current = zeros_[l] + currentOnes;
+        } else {
+            value <<= 1;
+            begin -= beginOnes;
+            current -= currentOnes;
+        }
+    }
+    rank = static_cast<uint32_t>(current - begin);
+    return value;
+}
+
+// END IMPLEMENTATION
\ No newline at end of file